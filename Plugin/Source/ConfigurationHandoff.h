@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+
+//==============================================================================
+/**
+ * Lock-free hand-off of a configuration object from one writer thread to the audio thread
+ *
+ * The writer (message thread) fills a slot no one else can see, then publishes it
+ * with a single atomic exchange. The audio thread picks up the newest published
+ * slot with another exchange and reads it for as long as it likes. Neither side
+ * ever waits, locks or allocates.
+ *
+ * Double buffering plus one spare slot: writer, reader and the slot in between
+ * each own one of three, so the writer can prepare the next configuration while
+ * the reader still uses the previous one. Configurations published faster than
+ * the reader collects them are skipped; only the newest one is picked up.
+ *
+ * - One writer at a time and one reader thread. Writers on different threads must be
+ *   serialized by the caller (a lock around getWriteSlot() ... publish() is fine: the
+ *   reader never takes it)
+ * - T is default-constructed three times up front; prepare its members (tables,
+ *   coefficients, handles) on the writer side so the reader only copies or reads
+ */
+template <typename T>
+class ConfigurationHandoff
+{
+public:
+    // Writer: the slot to fill before publish()
+    T& getWriteSlot() { return slots[writeIndex]; }
+
+    // Writer: make the filled slot the newest configuration
+    void publish()
+    {
+        writeIndex = shared.exchange (writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader: switch to the newest configuration; true if one was published since the last call
+    bool update()
+    {
+        if ((shared.load (std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+
+        readIndex = shared.exchange (readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Reader: the configuration picked up by the last update()
+    const T& getCurrent() const { return slots[readIndex]; }
+
+private:
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int FRESH = 4;
+
+    T slots[3];
+    int writeIndex = 0;                // Writer only
+    int readIndex = 1;                 // Reader only
+    std::atomic<int> shared { 2 };     // Slot in between, FRESH = not yet picked up
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//==============================================================================
+/**
+ * Lock-free meter feed from the audio thread to the editor
+ *
+ * The audio thread pushes short measurement frames (peak and sum of squares per
+ * side, gathered while Drive is applied), the editor drains them on its timer
+ * and does the dB conversion and ballistics itself. The audio thread never
+ * waits on the editor and runs no log10.
+ *
+ * Single producer, single consumer ring buffer: push and pop each own one
+ * position counter. A full ring means no editor is reading (closed, or the
+ * message thread is stalled), so push drops the frame; the editor clears the
+ * ring when it opens.
+ *
+ * - One writer thread (processBlock) and one reader thread (editor timer)
+ * - Frames are plain values, copied in and out; nothing allocates
+ */
+class MeterFeed
+{
+public:
+    // Left = even tracks, right = odd tracks (a mono bus feeds both)
+    static constexpr int NUM_SIDES = 2;
+
+    struct Frame
+    {
+        float peak[NUM_SIDES] = {};          // Highest |sample|
+        float sumSquares[NUM_SIDES] = {};    // Averaged over the tracks on each side
+        int numSamples = 0;                  // Samples per track covered by the frame
+    };
+
+    // Audio thread: queue a frame; false (frame dropped) if the ring is full
+    bool push (const Frame& frame)
+    {
+        const uint32_t write = writePosition.load (std::memory_order_relaxed);
+        if (write - readPosition.load (std::memory_order_acquire) >= CAPACITY)
+            return false;
+
+        frames[write & MASK] = frame;
+        writePosition.store (write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Editor: take the oldest queued frame; false if there is none
+    bool pop (Frame& frame)
+    {
+        const uint32_t read = readPosition.load (std::memory_order_relaxed);
+        if (read == writePosition.load (std::memory_order_acquire))
+            return false;
+
+        frame = frames[read & MASK];
+        readPosition.store (read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Editor: drop everything queued (frames left over from before the editor opened)
+    void clear()
+    {
+        readPosition.store (writePosition.load (std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    // ~5ms frames: 64 hold ~0.3s, several editor refreshes
+    static constexpr uint32_t CAPACITY = 64;
+    static constexpr uint32_t MASK = CAPACITY - 1;
+    static_assert ((CAPACITY & MASK) == 0, "CAPACITY must be a power of two");
+
+    Frame frames[CAPACITY];
+
+    // Separate cache lines: the audio thread writes one, the editor the other
+    alignas (64) std::atomic<uint32_t> writePosition { 0 };
+    alignas (64) std::atomic<uint32_t> readPosition { 0 };
+};
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    Plugin benchmark - ns/sample of the complete processBlock
+
+    Runs the real PluginProcessor (input trim, oversampling, tape engines, the
+    fused post-tape chain and, on multitrack buses, adjacent-track crosstalk)
+    for every machine / formula configuration across sample rates, block sizes
+    and bus widths. Oversampling is left on Auto, as shipped.
+
+    Output and options match Source/DSP/benchmark.cpp, so both reports can be
+    kept side by side and compared between releases:
+
+        TapeMachineBenchmark --json plugin.json
+        TapeMachineBenchmark --channels 2,24 --json new.json --compare plugin.json
+
+    Built with -DTAPE_MACHINE_BUILD_BENCHMARK=ON (see CMakeLists.txt).
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "DSP/BenchmarkHarness.h"
+
+using namespace TapeMachine::Benchmark;
+
+namespace
+{
+    using Processor = TapeMachinePluginSimulatorAudioProcessor;
+
+    void setParameter (Processor& processor, const char* parameterID, float plainValue)
+    {
+        if (auto* parameter = processor.getValueTreeState().getParameter (parameterID))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (plainValue));
+    }
+
+    void benchmarkPlugin (Report& report, const Options& options, const Configuration& config,
+                          double sampleRate, int blockSize, int numChannels, bool multicore)
+    {
+        const std::string stage = multicore ? "PluginProcessor::processBlock/multicore"
+                                            : "PluginProcessor::processBlock";
+        if (! wantsStage (options, stage))
+            return;
+
+        Processor processor;
+
+        const auto channelSet = numChannels == 1 ? juce::AudioChannelSet::mono()
+                              : numChannels == 2 ? juce::AudioChannelSet::stereo()
+                                                 : juce::AudioChannelSet::discreteChannels (numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.outputBuses.add (channelSet);
+        if (! processor.setBusesLayout (layout))
+        {
+            std::cerr << "Skipping " << numChannels << " channels: layout not supported\n";
+            return;
+        }
+
+        // Configure before prepareToPlay so no mode crossfade is measured
+        setParameter (processor, Processor::PARAM_MACHINE_MODE, config.isAmpex() ? 0.0f : 1.0f);
+        setParameter (processor, Processor::PARAM_TAPE_FORMULA, static_cast<float> (config.tapeFormula));
+        setParameter (processor, Processor::PARAM_MULTICORE, multicore ? 1.0f : 0.0f);
+
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        const std::vector<float> signal = makeTestSignal (sampleRate, 8192, 0.7);  // Plugin input, before the -6 dB trim
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        juce::MidiBuffer midi;
+        size_t position = 0;
+
+        // Host behaviour: fresh input every block, processed in place
+        auto processOneBlock = [&]
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = buffer.getWritePointer (ch);
+                for (int i = 0; i < blockSize; ++i)
+                    data[i] = signal[(position + static_cast<size_t> (i + 7 * ch)) % signal.size()];
+            }
+            position = (position + static_cast<size_t> (blockSize)) % signal.size();
+
+            processor.processBlock (buffer, midi);
+            consume (buffer.getSample (0, 0));
+        };
+
+        // Half a second of audio first: 150 ms engine fade-in, smoothed gains settle
+        for (int n = 0; n < static_cast<int> (sampleRate / 2); n += blockSize)
+            processOneBlock();
+
+        const auto timing = measure (processOneBlock, blockSize * numChannels, options);
+        processor.releaseResources();
+
+        Result result;
+        result.stage = stage;
+        result.config = config.name;
+        result.sampleRate = sampleRate;
+        result.blockSize = blockSize;
+        result.channels = numChannels;
+        result.nsPerSample = timing.first;
+        result.nsPerSampleMin = timing.second;
+        report.add (result);
+    }
+}
+
+int main (int argc, char** argv)
+{
+    Options options;
+    if (! parseOptions (argc, argv, options))
+    {
+        std::cout << "Usage: TapeMachineBenchmark [options]\n\n";
+        printOptionsUsage();
+        return 2;
+    }
+
+    // APVTS and the editor-facing timers expect JUCE to be initialised
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Report report ("tape_machine_plugin");
+    Report::printHeader();
+
+    for (double sampleRate : options.sampleRates)
+        for (int blockSize : options.blockSizes)
+            for (int numChannels : options.channelCounts)
+                for (const Configuration& config : configurations())
+                {
+                    benchmarkPlugin (report, options, config, sampleRate, blockSize, numChannels, false);
+
+                    if (numChannels > 2)
+                        benchmarkPlugin (report, options, config, sampleRate, blockSize, numChannels, true);
+                }
+
+    auto build = buildInfo();
+   #if TAPE_MACHINE_FLOAT_ENGINE
+    build.push_back ({ "engine", "float" });
+   #else
+    build.push_back ({ "engine", "double" });
+   #endif
+
+    if (! options.jsonPath.empty())
+    {
+        if (! report.writeJSON (options.jsonPath, options, build))
+        {
+            std::cerr << "Cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        std::cout << "\nWrote " << report.getResults().size() << " results to " << options.jsonPath << "\n";
+    }
+
+    if (! options.baselinePath.empty())
+    {
+        const int regressions = report.compareWithBaseline (options.baselinePath, options.tolerancePercent);
+        if (regressions < 0)
+        {
+            std::cerr << "Cannot read " << options.baselinePath << "\n";
+            return 1;
+        }
+        return regressions > 0 ? 1 : 0;
+    }
+
+    return 0;
+}
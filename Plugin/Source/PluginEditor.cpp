@@ -105,10 +105,29 @@ TapeMachinePluginSimulatorAudioProcessorEditor::TapeMachinePluginSimulatorAudioP
         outputTrimSlider
     );
 
+    // Diagnostics toggle - grows the window by the panel height
+    if constexpr (ProcessorDiagnostics::enabled)
+    {
+        diagnosticsButton.setClickingTogglesState (true);
+        diagnosticsButton.setColour (juce::TextButton::buttonColourId, backgroundColour.brighter (0.1f));
+        diagnosticsButton.setColour (juce::TextButton::buttonOnColourId, accentColour.withAlpha (0.6f));
+        diagnosticsButton.setColour (juce::TextButton::textColourOffId, textColour.withAlpha (0.6f));
+        diagnosticsButton.setColour (juce::TextButton::textColourOnId, textColour);
+        diagnosticsButton.onClick = [this]
+        {
+            setSize (getWidth(), BASE_HEIGHT + (diagnosticsButton.getToggleState() ? DIAGNOSTICS_HEIGHT : 0));
+        };
+        addAndMakeVisible (diagnosticsButton);
+    }
+
+    // The cached background covers every pixel: nothing behind the editor needs repainting
+    setOpaque (true);
+
     // Set window size
-    setSize (BASE_WIDTH, 400);
+    setSize (BASE_WIDTH, BASE_HEIGHT);
 
-    // Start timer for meter updates (30 fps)
+    // Start timer for meter updates (30 fps), from a fresh feed (nobody drained it while closed)
+    audioProcessor.getMeterFeed().clear();
     startTimerHz (30);
 }
 
@@ -148,8 +167,18 @@ juce::Colour TapeMachinePluginSimulatorAudioProcessorEditor::getMeterColour (flo
     return juce::Colour (0xffff0000);  // Red
 }
 
-void TapeMachinePluginSimulatorAudioProcessorEditor::paint (juce::Graphics& g)
+void TapeMachinePluginSimulatorAudioProcessorEditor::renderBackground (float scale)
 {
+    // Rendered at the display's pixel scale so it stays sharp on HiDPI screens
+    backgroundScale = scale;
+    backgroundImage = juce::Image (juce::Image::RGB,
+                                   juce::jmax (1, juce::roundToInt (static_cast<float> (getWidth()) * scale)),
+                                   juce::jmax (1, juce::roundToInt (static_cast<float> (getHeight()) * scale)),
+                                   false);
+
+    juce::Graphics g (backgroundImage);
+    g.addTransform (juce::AffineTransform::scale (scale));
+
     // Background gradient
     juce::ColourGradient gradient (
         backgroundColour.brighter (0.1f), 0.0f, 0.0f,
@@ -167,7 +196,7 @@ void TapeMachinePluginSimulatorAudioProcessorEditor::paint (juce::Graphics& g)
     g.setColour (accentColour.withAlpha (0.2f));
     g.drawLine (20.0f, 70.0f, static_cast<float> (getWidth() - 20), 70.0f, 1.0f);
 
-    // Draw PPM meter if bounds are set
+    // PPM meter frame
     if (!meterBounds.isEmpty())
     {
         // Meter background
@@ -177,30 +206,74 @@ void TapeMachinePluginSimulatorAudioProcessorEditor::paint (juce::Graphics& g)
         // Meter border
         g.setColour (accentColour.withAlpha (0.4f));
         g.drawRoundedRectangle (meterBounds, 4.0f, 2.0f);
+    }
+
+    // Diagnostics panel frame
+    if (! diagnosticsBounds.isEmpty())
+    {
+        g.setColour (backgroundColour.darker (0.3f));
+        g.fillRoundedRectangle (diagnosticsBounds.toFloat(), 4.0f);
+        g.setColour (accentColour.withAlpha (0.4f));
+        g.drawRoundedRectangle (diagnosticsBounds.toFloat(), 4.0f, 1.0f);
+    }
+}
 
-        // Meter fill (based on level) - scale from -48dB to -6dB range
-        // This covers well below 0 VU (-18dBFS) up to hot digital levels
-        const float minDB = -48.0f;
-        const float maxDB = -6.0f;
-        float normalizedLevel = juce::jmap (meterLevel, minDB, maxDB, 0.0f, 1.0f);
-        normalizedLevel = juce::jlimit (0.0f, 1.0f, normalizedLevel);
+void TapeMachinePluginSimulatorAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (! backgroundImage.isValid() || scale != backgroundScale)
+        renderBackground (scale);
+
+    g.drawImageTransformed (backgroundImage, juce::AffineTransform::scale (1.0f / backgroundScale));
+
+    // Draw PPM meter if bounds are set
+    if (!meterBounds.isEmpty())
+        paintMeter (g);
+
+    // Diagnostics panel
+    if (! diagnosticsBounds.isEmpty())
+    {
+        g.setColour (textColour.withAlpha (0.85f));
+        g.setFont (juce::FontOptions (juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+        auto textArea = diagnosticsBounds.reduced (8, 6);
+        for (const auto& line : diagnosticsLines)
+            g.drawText (line, textArea.removeFromTop (16), juce::Justification::centredLeft);
+    }
+}
+
+void TapeMachinePluginSimulatorAudioProcessorEditor::paintMeter (juce::Graphics& g)
+{
+    // One row per side: peak bar coloured by level, RMS as a thin marker
+    // Scale from -48dB to -6dB: covers well below 0 VU (-18dBFS) up to hot digital levels
+    const auto rows = meterBounds.reduced (4.0f);
+    const float rowGap = 2.0f;
+    const float rowHeight = (rows.getHeight() - rowGap) * 0.5f;
 
-        if (normalizedLevel > 0.001f)
+    for (int side = 0; side < MeterFeed::NUM_SIDES; ++side)
+    {
+        const auto row = rows.withHeight (rowHeight).translated (0.0f, static_cast<float> (side) * (rowHeight + rowGap));
+
+        const float peakFraction = juce::jlimit (0.0f, 1.0f, juce::jmap (meterPeak[side], METER_MIN_DB, METER_MAX_DB, 0.0f, 1.0f));
+        if (peakFraction > 0.001f)
         {
-            g.setColour (getMeterColour (meterLevel));
-            auto fillBounds = meterBounds.reduced (4.0f);
-            float fillWidth = fillBounds.getWidth() * normalizedLevel;
-            fillBounds.setWidth (fillWidth);
-            g.fillRoundedRectangle (fillBounds, 2.0f);
+            g.setColour (getMeterColour (meterPeak[side]));
+            g.fillRoundedRectangle (row.withWidth (row.getWidth() * peakFraction), 2.0f);
         }
 
-        // Draw level marker text
-        g.setColour (textColour.withAlpha (0.8f));
-        g.setFont (juce::FontOptions (10.0f));
-        g.drawText (juce::String (meterLevel, 1) + " dB",
-                    meterBounds.toNearestInt(),
-                    juce::Justification::centred);
+        const float rmsFraction = juce::jlimit (0.0f, 1.0f, juce::jmap (meterRMS[side], METER_MIN_DB, METER_MAX_DB, 0.0f, 1.0f));
+        if (rmsFraction > 0.001f)
+        {
+            g.setColour (textColour.withAlpha (0.7f));
+            g.fillRect (row.getX() + row.getWidth() * rmsFraction - 1.0f, row.getY(), 2.0f, row.getHeight());
+        }
     }
+
+    // Draw level marker text (louder side)
+    g.setColour (textColour.withAlpha (0.8f));
+    g.setFont (juce::FontOptions (10.0f));
+    g.drawText (juce::String (juce::jmax (meterPeak[0], meterPeak[1]), 1) + " dB",
+                meterBounds.toNearestInt(),
+                juce::Justification::centred);
 }
 
 void TapeMachinePluginSimulatorAudioProcessorEditor::resized()
@@ -246,21 +319,109 @@ void TapeMachinePluginSimulatorAudioProcessorEditor::resized()
     // PPM Meter (horizontal bar)
     auto meterArea = controlArea.removeFromTop (40);
     meterBounds = meterArea.reduced (10, 5).toFloat();
+
+    // Diagnostics toggle (top right corner) and panel (below the meter)
+    diagnosticsButton.setBounds (getWidth() - margin - 44, 22, 44, 20);
+    diagnosticsBounds = {};
+    if (diagnosticsButton.getToggleState())
+    {
+        controlArea.removeFromTop (10);
+        diagnosticsBounds = controlArea.removeFromTop (DIAGNOSTICS_HEIGHT - 10).reduced (10, 0);
+    }
+
+    // Frames moved: render the background again on the next paint
+    backgroundImage = {};
 }
 
-void TapeMachinePluginSimulatorAudioProcessorEditor::timerCallback()
+void TapeMachinePluginSimulatorAudioProcessorEditor::updateMeter()
 {
-    // Get actual level from processor
-    float currentLevel = audioProcessor.getCurrentLevelDB();
+    // Drain the frames since the last tick: highest peak, RMS over all of them
+    // No frames (transport stopped, host not processing) reads as silence
+    float peak[MeterFeed::NUM_SIDES] = {};
+    double sumSquares[MeterFeed::NUM_SIDES] = {};
+    int numSamples = 0;
+
+    MeterFeed::Frame frame;
+    while (audioProcessor.getMeterFeed().pop (frame))
+    {
+        for (int side = 0; side < MeterFeed::NUM_SIDES; ++side)
+        {
+            peak[side] = juce::jmax (peak[side], frame.peak[side]);
+            sumSquares[side] += frame.sumSquares[side];
+        }
+        numSamples += frame.numSamples;
+    }
 
     // PPM-style ballistics: 10ms integration time (attack), 2s return time (release)
     // At 30 fps (33.3ms per frame):
     // Attack: reach 99% in ~10ms → coefficient ≈ 1.0 (instant attack)
     // Release: reach 50% in ~2s → 60 frames → coefficient ≈ 0.988
-    if (currentLevel > meterLevel)
-        meterLevel = currentLevel;  // Instant attack (10ms integration)
-    else
-        meterLevel = meterLevel * 0.988f + currentLevel * (1.0f - 0.988f);  // 2s return time
+    auto applyBallistics = [] (float& meterLevel, float currentLevel)
+    {
+        if (currentLevel > meterLevel)
+            meterLevel = currentLevel;  // Instant attack (10ms integration)
+        else
+            meterLevel = meterLevel * 0.988f + currentLevel * (1.0f - 0.988f);  // 2s return time
+    };
+
+    for (int side = 0; side < MeterFeed::NUM_SIDES; ++side)
+    {
+        const float rms = numSamples > 0 ? static_cast<float> (std::sqrt (sumSquares[side] / numSamples)) : 0.0f;
+        applyBallistics (meterPeak[side], juce::Decibels::gainToDecibels (peak[side], -96.0f));
+        applyBallistics (meterRMS[side], juce::Decibels::gainToDecibels (rms, -96.0f));
+    }
+}
 
-    repaint();
+void TapeMachinePluginSimulatorAudioProcessorEditor::timerCallback()
+{
+    updateMeter();
+
+    // Repaint only the meter, and only once its reading has moved (the text shows 0.1 dB)
+    bool meterChanged = false;
+    for (int side = 0; side < MeterFeed::NUM_SIDES; ++side)
+    {
+        meterChanged |= std::abs (meterPeak[side] - paintedPeak[side]) >= 0.05f
+                     || std::abs (meterRMS[side] - paintedRMS[side]) >= 0.05f;
+    }
+
+    if (meterChanged)
+    {
+        std::copy (std::begin (meterPeak), std::end (meterPeak), std::begin (paintedPeak));
+        std::copy (std::begin (meterRMS), std::end (meterRMS), std::begin (paintedRMS));
+        repaint (meterBounds.toNearestInt());
+    }
+
+    if constexpr (ProcessorDiagnostics::enabled)
+    {
+        if (diagnosticsButton.getToggleState())
+        {
+            updateDiagnostics();
+            repaint (diagnosticsBounds);
+        }
+    }
+}
+
+void TapeMachinePluginSimulatorAudioProcessorEditor::updateDiagnostics()
+{
+    auto& diagnostics = audioProcessor.getDiagnostics();
+
+    // Peak load held with a ~1s decay so short spikes stay readable
+    diagnosticsPeakLoad = juce::jmax (diagnostics.takePeakLoad(), diagnosticsPeakLoad * 0.97f);
+
+    juce::String stages;
+    for (int s = 0; s < ProcessorDiagnostics::numStages; ++s)
+        stages << ProcessorDiagnostics::getStageName (s) << " " << juce::String (diagnostics.getStageMicroseconds (s), 1) << "  ";
+
+    const float iterations = diagnostics.getIterationsPerSolve();
+
+    diagnosticsLines.clear();
+    diagnosticsLines.add ("Block " + juce::String (diagnostics.getBlockMicroseconds(), 1) + " us   load "
+                          + juce::String (diagnostics.getBlockLoad() * 100.0f, 1) + " %   peak "
+                          + juce::String (diagnosticsPeakLoad * 100.0f, 1) + " %");
+    diagnosticsLines.add (stages.trimEnd() + "  (us)");
+    diagnosticsLines.add ("J-A " + (iterations > 0.0f ? juce::String (iterations, 2) + " it/solve" : juce::String ("linear"))
+                          + "   NaN resets " + juce::String (static_cast<juce::int64> (diagnostics.getJANaNResets()))
+                          + "   M limit " + juce::String (static_cast<juce::int64> (diagnostics.getJASoftLimits()))
+                          + "   out limit " + juce::String (static_cast<juce::int64> (diagnostics.getJAOutLimits()))
+                          + "   out NaN " + juce::String (static_cast<juce::int64> (diagnostics.getJAOutNaNs())));
 }
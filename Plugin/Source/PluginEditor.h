@@ -11,7 +11,10 @@
  * Simple but functional interface with:
  * - Machine mode selector (Ampex/Studer)
  * - Input trim slider
- * - PPM-style level meter with color gradient
+ * - PPM-style level meter with color gradient (peak bar and RMS marker per side)
+ *
+ * Everything static is drawn once into a cached background image; the timer only
+ * repaints the meter (and the diagnostics panel) when its reading has changed.
  */
 class TapeMachinePluginSimulatorAudioProcessorEditor : public juce::AudioProcessorEditor,
                                                  public juce::Timer
@@ -52,10 +55,32 @@ private:
     juce::Slider outputTrimSlider;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> outputTrimAttachment;
 
-    // PPM Meter
+    // PPM Meter, fed by the processor's MeterFeed
+    // Left / right rows: even / odd tracks of a multitrack bus
     juce::Rectangle<float> meterBounds;
-    float meterLevel = -96.0f;  // Start silent, not at 0dB (which would show red)
+    float meterPeak[MeterFeed::NUM_SIDES] = { -96.0f, -96.0f };  // Start silent, not at 0dB (which would show red)
+    float meterRMS[MeterFeed::NUM_SIDES] = { -96.0f, -96.0f };
+    float paintedPeak[MeterFeed::NUM_SIDES] = { 0.0f, 0.0f };   // Readings on screen (repaint on change)
+    float paintedRMS[MeterFeed::NUM_SIDES] = { 0.0f, 0.0f };
+    static constexpr float METER_MIN_DB = -48.0f;
+    static constexpr float METER_MAX_DB = -6.0f;
     juce::Colour getMeterColour (float levelDB) const;
+    void updateMeter();
+    void paintMeter (juce::Graphics& g);
+
+    // Background, border, dividers and panel frames, rendered at the display scale
+    // and redrawn only after a resize or a scale change
+    juce::Image backgroundImage;
+    float backgroundScale = 0.0f;
+    void renderBackground (float scale);
+
+    // Diagnostics panel (TAPE_MACHINE_DIAGNOSTICS builds only): block time / CPU load,
+    // time per stage, J-A iterations and NaN / soft-limit events, refreshed by the timer
+    juce::TextButton diagnosticsButton { "DIAG" };
+    juce::Rectangle<int> diagnosticsBounds;
+    juce::StringArray diagnosticsLines;
+    float diagnosticsPeakLoad = 0.0f;  // Held peak, decays in timerCallback
+    void updateDiagnostics();
 
     // Styling
     juce::Colour backgroundColour;
@@ -64,6 +89,8 @@ private:
 
     // Base width
     static constexpr int BASE_WIDTH = 500;
+    static constexpr int BASE_HEIGHT = 400;
+    static constexpr int DIAGNOSTICS_HEIGHT = 90;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapeMachinePluginSimulatorAudioProcessorEditor)
 };
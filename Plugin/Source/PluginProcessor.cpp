@@ -24,17 +24,30 @@ TapeMachinePluginSimulatorAudioProcessor::TapeMachinePluginSimulatorAudioProcess
     tapeFormulaParam = parameters.getRawParameterValue (PARAM_TAPE_FORMULA);
     inputTrimParam = parameters.getRawParameterValue (PARAM_INPUT_TRIM);
     outputTrimParam = parameters.getRawParameterValue (PARAM_OUTPUT_TRIM);
+    oversamplingParam = parameters.getRawParameterValue (PARAM_OVERSAMPLING);
+    oversamplingFilterParam = parameters.getRawParameterValue (PARAM_OVERSAMPLING_FILTER);
+    renderQualityParam = parameters.getRawParameterValue (PARAM_RENDER_QUALITY);
+    multicoreParam = parameters.getRawParameterValue (PARAM_MULTICORE);
+    trackingModeParam = parameters.getRawParameterValue (PARAM_TRACKING_MODE);
 
     // Register parameter listener for auto-gain linking
     parameters.addParameterListener (PARAM_INPUT_TRIM, this);
     parameters.addParameterListener (PARAM_OUTPUT_TRIM, this);
     lastInputTrimValue = 1.0f;  // Match default (0dB)
+
+    // Quality parameters: the engine setup is rebuilt on the message thread (publishEngineSetup)
+    for (auto* id : { PARAM_OVERSAMPLING, PARAM_OVERSAMPLING_FILTER, PARAM_RENDER_QUALITY, PARAM_TRACKING_MODE })
+        parameters.addParameterListener (id, this);
 }
 
 TapeMachinePluginSimulatorAudioProcessor::~TapeMachinePluginSimulatorAudioProcessor()
 {
     parameters.removeParameterListener (PARAM_INPUT_TRIM, this);
     parameters.removeParameterListener (PARAM_OUTPUT_TRIM, this);
+    for (auto* id : { PARAM_OVERSAMPLING, PARAM_OVERSAMPLING_FILTER, PARAM_RENDER_QUALITY, PARAM_TRACKING_MODE })
+        parameters.removeParameterListener (id, this);
+
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -90,6 +103,47 @@ TapeMachinePluginSimulatorAudioProcessor::createParameterLayout()
         }
     ));
 
+    // Oversampling factor for playback
+    // Auto = 2x below 88.2kHz, off above (headroom for saturation harmonics is already there)
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        PARAM_OVERSAMPLING,
+        "Oversampling",
+        juce::StringArray { "Auto", "Off", "2x", "4x", "8x" },
+        0  // Default: Auto
+    ));
+
+    // Oversampling filter: minimum phase IIR (low latency) or linear phase FIR (no phase shift)
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        PARAM_OVERSAMPLING_FILTER,
+        "Oversampling Filter",
+        juce::StringArray { "Minimum Phase", "Linear Phase" },
+        0  // Default: Minimum Phase IIR
+    ));
+
+    // Offline render quality - applied when the host renders non-realtime (bounce/export)
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        PARAM_RENDER_QUALITY,
+        "Render Quality",
+        juce::StringArray { "Same as Playback", "4x Linear Phase", "8x Linear Phase" },
+        0  // Default: Same as Playback
+    ));
+
+    // Multicore: process the track pairs of a multitrack bus on worker threads
+    // No effect on mono/stereo buses (a single track group)
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        PARAM_MULTICORE,
+        "Multicore",
+        false  // Default: Off (everything on the audio thread)
+    ));
+
+    // Tracking mode: zero-latency, low-CPU chain for live monitoring (realtime only)
+    // Offline renders switch back to the full chain automatically
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        PARAM_TRACKING_MODE,
+        "Tracking Mode",
+        false  // Default: Off (full calibrated chain)
+    ));
+
     return layout;
 }
 
@@ -128,7 +182,7 @@ bool TapeMachinePluginSimulatorAudioProcessor::isMidiEffect() const
 
 double TapeMachinePluginSimulatorAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.05;  // 50ms tail for DC blocker and filter decay
+    return IDLE_HOLD_SECONDS;  // Print-through echo (65ms), DC blocker and filter decay
 }
 
 int TapeMachinePluginSimulatorAudioProcessor::getNumPrograms()
@@ -149,79 +203,173 @@ void TapeMachinePluginSimulatorAudioProcessor::changeProgramName (int index, con
 //==============================================================================
 void TapeMachinePluginSimulatorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Disable oversampling at high sample rates (88.2kHz+)
-    // At 96kHz+ native, Nyquist is already 48kHz+ providing adequate headroom
-    // for saturation harmonics without the phase artifacts from decimation filter
-    useOversampling = (sampleRate < 88200.0);
+    // Split the bus into track groups: stereo pairs, odd last track (or a mono bus) on its own
+    // Groups are only rebuilt when the channel count changes, so per-instance tolerances stay put
+    const int numChannels = juce::jlimit (1, MAX_CHANNELS, getTotalNumInputChannels());
+    const int numGroups = (numChannels + 1) / 2;
 
-    if (useOversampling)
+    if (numChannels != numTracks)
     {
-        // Initialize 2x minimum phase oversampling
-        // filterHalfBandPolyphaseIIR = minimum phase IIR filters (no linear phase latency)
-        constexpr int oversamplingOrder = 1;  // 2^1 = 2x oversampling
-        oversampler = std::make_unique<Oversampler> (
-            2,  // numChannels (stereo)
-            oversamplingOrder,
-            Oversampler::filterHalfBandPolyphaseIIR,  // Minimum phase IIR
-            false  // Not using maximum quality (faster)
-        );
-        oversampler->initProcessing (static_cast<size_t> (samplesPerBlock));
-
-        // Report latency to DAW (oversampler adds some latency)
-        setLatencySamples (static_cast<int> (oversampler->getLatencyInSamples()));
-
-        // Initialize tape processors at OVERSAMPLED sample rate (2x)
-        const double oversampledRate = sampleRate * 2.0;
-        tapeProcessorLeft.setSampleRate (oversampledRate);
-        tapeProcessorRight.setSampleRate (oversampledRate);
+        trackGroups.clear();
+        for (int g = 0; g < numGroups; ++g)
+        {
+            auto group = std::make_unique<TrackGroup>();
+            group->firstChannel = 2 * g;
+            group->numChannels = juce::jmin (2, numChannels - 2 * g);
+            trackGroups.push_back (std::move (group));
+        }
+        numTracks = numChannels;
     }
-    else
+
+    // Configure the active engine for the current machine mode and tape formula
+    const int machineMode = static_cast<int> (*machineModeParam);
+    const int tapeFormula = static_cast<int> (*tapeFormulaParam);
+    const bool isAmpex = (machineMode == 0);
+    activeEngine = 0;
+
+    // Standby engine buffers for mode-switch crossfades (sized for the highest oversampling factor)
+    const auto standbySize = static_cast<size_t> (juce::jmax (1, samplesPerBlock << MAX_OVERSAMPLING_ORDER));
+
+    for (auto& group : trackGroups)
     {
-        // High sample rate mode - no oversampling needed
-        oversampler.reset();  // Release oversampler memory
-        setLatencySamples (0);  // Zero latency at high sample rates
+        // Allocate every oversampler up front (2x/4x/8x, IIR and FIR)
+        // filterHalfBandPolyphaseIIR = minimum phase IIR filters (no linear phase latency)
+        // filterHalfBandFIREquiripple = linear phase, integer latency for exact delay compensation
+        for (int linearPhase = 0; linearPhase < 2; ++linearPhase)
+        {
+            for (int order = 1; order <= MAX_OVERSAMPLING_ORDER; ++order)
+            {
+                auto& os = group->oversamplers[linearPhase][order - 1];
+                os = std::make_unique<Oversampler> (
+                    static_cast<size_t> (group->numChannels),
+                    static_cast<size_t> (order),
+                    linearPhase ? Oversampler::filterHalfBandFIREquiripple
+                                : Oversampler::filterHalfBandPolyphaseIIR,
+                    linearPhase == 1,   // Maximum quality for FIR, faster IIR
+                    linearPhase == 1);  // Integer latency for FIR
+                os->initProcessing (static_cast<size_t> (samplesPerBlock));
+            }
+        }
+
+        for (auto& engine : group->tapeEngines)
+        {
+            // Saturation curve and J-A gate evaluated every 16 samples (ramped in between)
+            // Verified against per-sample evaluation by THDSweepTest::runControlRateCheck
+            engine.left.setControlRateInterval (16);
+            engine.right.setControlRateInterval (16);
+            engine.setAzimuth (numChannels <= 2);
+
+            engine.reset();
+        }
+
+        group->tapeEngines[activeEngine].configure (machineMode, tapeFormula);
+
+        group->standbyBufferL.assign (standbySize, 0.0f);
+        group->standbyBufferR.assign (standbySize, 0.0f);
 
-        // Initialize tape processors at native sample rate
-        tapeProcessorLeft.setSampleRate (sampleRate);
-        tapeProcessorRight.setSampleRate (sampleRate);
+        // Initialize crosstalk filter at base sample rate (applied after downsampling)
+        group->crosstalkFilter.prepare (static_cast<float> (sampleRate));
+
+        // Wow and print-through delay lines for this rate (both are reset by their prepare)
+        group->allocateDelayLines (static_cast<float> (sampleRate));
+
+        // Initialize wow modulator (disabled for Ampex)
+        // One transport moves every track: all groups follow the first group's LFOs
+        if (group != trackGroups.front())
+            group->wowModulator.syncPhasesTo (trackGroups.front()->wowModulator);
+        group->wowModulator.prepare (static_cast<float> (sampleRate), isAmpex);
+
+        // Initialize tolerance EQ (randomized per instance and track group)
+        // Stereo mode = different tolerances per channel, Mono = same for both
+        const bool isStereo = (group->numChannels >= 2);
+        group->toleranceEQ.prepare (static_cast<float> (sampleRate), isStereo, isAmpex);
+
+        // Initialize print-through (Studer mode only, but prepare always)
+        group->printThrough.prepare (static_cast<float> (sampleRate));
     }
 
-    tapeProcessorLeft.reset();
-    tapeProcessorRight.reset();
+    // Multitrack buses: per-track crosstalk filters and neighbour scratch buffers
+    adjacentTrackCrosstalk = (numChannels > 2);
+    trackCrosstalk.assign (adjacentTrackCrosstalk ? static_cast<size_t> (numChannels) : 0, CrosstalkFilter());
+    for (auto& filter : trackCrosstalk)
+        filter.prepare (static_cast<float> (sampleRate));
+    crosstalkScratchA.assign (adjacentTrackCrosstalk ? static_cast<size_t> (juce::jmax (1, samplesPerBlock)) : 0, 0.0f);
+    crosstalkScratchB.assign (crosstalkScratchA.size(), 0.0f);
+
+    // Worker threads for multicore processing: one fewer than the groups (the audio thread works too)
+    const int numWorkers = juce::jmin (numGroups - 1, juce::SystemStats::getNumCpus() - 1);
+    workerPool.start (juce::jmax (0, numWorkers));
 
-    // Set default Ampex ATR-102 parameters (Master mode, GP9 tape)
-    const double defaultBias = 0.65;
-    const int defaultFormula = 0;  // GP9
-    tapeProcessorLeft.setParameters (defaultBias, 1.0, defaultFormula);
-    tapeProcessorRight.setParameters (defaultBias, 1.0, defaultFormula);
+    idleHoldSamples = juce::jmax (1, static_cast<int> (IDLE_HOLD_SECONDS * sampleRate));
 
-    // Initialize crosstalk filter at base sample rate (applied after downsampling)
-    crosstalkFilter.prepare (static_cast<float> (sampleRate));
+    meterFrameSamples = juce::jmax (1, juce::roundToInt (METER_FRAME_SECONDS * sampleRate));
+    meterFrame = {};
 
-    // Initialize wow modulator (default to Ampex/disabled, will update in processBlock)
-    wowModulator.prepare (static_cast<float> (sampleRate), true);
+    switchInProgress = false;
+    switchPosition = 0;
+    switchWarmupSamples = static_cast<int> (SWITCH_WARMUP_SECONDS * sampleRate);
+    switchCrossfadeSamples = juce::jmax (1, static_cast<int> (SWITCH_CROSSFADE_SECONDS * sampleRate));
+
+    // Drive and Volume ramps start at the current values
+    inputTrimSmoothed.reset (sampleRate, GAIN_RAMP_SECONDS);
+    outputTrimSmoothed.reset (sampleRate, GAIN_RAMP_SECONDS);
+    inputTrimSmoothed.setCurrentAndTargetValue (*inputTrimParam);
+    outputTrimSmoothed.setCurrentAndTargetValue (getAutoGainOutputTrim());
+    inputGainRamp.assign (static_cast<size_t> (juce::jmax (1, samplesPerBlock)), 1.0f);
+    outputGainRamp.assign (inputGainRamp.size(), 1.0f);
+
+    {
+        // handleAsyncUpdate may be publishing on the message thread right now: one writer at a time
+        const juce::ScopedLock lock (engineSetupLock);
+
+        // Engine coefficients for native rate and every oversampling factor (see makeEngineMode)
+        engineTables.assign (MAX_OVERSAMPLING_ORDER + 1, nullptr);
+        for (int order = 0; order <= MAX_OVERSAMPLING_ORDER; ++order)
+            if (order == 0 || sampleRate * (1 << order) <= MAX_ENGINE_SAMPLE_RATE + 1.0)
+                engineTables[static_cast<size_t> (order)] = TapeEngine::Processor::prepareRate (sampleRate * (1 << order));
+
+        // Oversampler latency for every factor and filter (identical for every group)
+        for (int linearPhase = 0; linearPhase < 2; ++linearPhase)
+            for (int order = 1; order <= MAX_OVERSAMPLING_ORDER; ++order)
+                oversamplingLatency[linearPhase][order] =
+                    juce::roundToInt (trackGroups.front()->oversamplers[linearPhase][order - 1]->getLatencyInSamples());
+
+        engineSetupPending = false;
+        publishEngineSetup();
+    }
 
-    // Initialize tolerance EQ (randomized per instance)
-    // Stereo mode = different tolerances per channel, Mono = same for both
-    // Default to Ampex mode, will update in processBlock if needed
-    bool isStereo = (getTotalNumInputChannels() >= 2);
-    toleranceEQ.prepare (static_cast<float> (sampleRate), isStereo, true);
+    // Select the oversampler and set the engine sample rate (publishEngineSetup reported the latency)
+    engineSetups.update();
 
-    // Initialize print-through (Studer mode only, but prepare always)
-    printThrough.prepare (static_cast<float> (sampleRate));
+    const auto& setup = engineSetups.getCurrent();
+    const auto& mode = isNonRealtime() ? setup.render : setup.playback;
+    oversamplingOrder = -1;
+    applyOversamplingSettings (mode);
+    applyTrackingMode (mode.tracking);
 }
 
 void TapeMachinePluginSimulatorAudioProcessor::releaseResources()
 {
-    // Reset processors when playback stops
-    tapeProcessorLeft.reset();
-    tapeProcessorRight.reset();
-    if (oversampler)
-        oversampler->reset();
-    crosstalkFilter.reset();
-    wowModulator.reset();
-    toleranceEQ.reset();
-    printThrough.reset();
+    // Complete any pending mode switch, then reset processors when playback stops
+    if (switchInProgress)
+        finishModeSwitch();
+
+    for (auto& group : trackGroups)
+    {
+        for (auto& engine : group->tapeEngines)
+            engine.reset();
+        if (group->oversampler != nullptr)
+            group->oversampler->reset();
+        group->crosstalkFilter.reset();
+        group->wowModulator.reset();
+        group->toleranceEQ.reset();
+        group->printThrough.reset();
+        group->silentInputSamples = 0;
+        group->silentOutputSamples = 0;
+    }
+
+    for (auto& filter : trackCrosstalk)
+        filter.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -231,14 +379,14 @@ bool TapeMachinePluginSimulatorAudioProcessor::isBusesLayoutSupported (const Bus
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // Support mono and stereo
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Support mono, stereo and multitrack layouts up to MAX_CHANNELS
+    const auto& mainOutput = layouts.getMainOutputChannelSet();
+    if (mainOutput.isDisabled() || mainOutput.size() > MAX_CHANNELS)
         return false;
 
     // Input and output layouts must match
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    if (mainOutput != layouts.getMainInputChannelSet())
         return false;
    #endif
 
@@ -250,6 +398,7 @@ bool TapeMachinePluginSimulatorAudioProcessor::isBusesLayoutSupported (const Bus
 void TapeMachinePluginSimulatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    const auto blockStart = ProcessorDiagnostics::now();
 
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -258,249 +407,696 @@ void TapeMachinePluginSimulatorAudioProcessor::processBlock (juce::AudioBuffer<f
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    if (trackGroups.empty())
+        return;
+
+    // Follow tracking mode and oversampling quality changes (and realtime/offline transitions)
+    // The setups are prepared on the message thread: picking one up is a single atomic exchange
+    engineSetups.update();
+    {
+        const auto& setup = engineSetups.getCurrent();
+        const auto& mode = isNonRealtime() ? setup.render : setup.playback;
+
+        if (mode.tracking != trackingActive)
+            applyTrackingMode (mode.tracking);
+
+        if (mode.oversamplingOrder != oversamplingOrder
+            || (mode.oversamplingOrder > 0 && mode.linearPhase != oversamplingLinearPhase))
+            applyOversamplingSettings (mode);
+    }
+
     // Get parameter values
     const int machineMode = static_cast<int> (*machineModeParam);
     const int tapeFormula = static_cast<int> (*tapeFormulaParam);
     const float inputTrimValue = *inputTrimParam;
-    const float outputTrimValue = *outputTrimParam;
+    const float outputTrimValue = getAutoGainOutputTrim();
 
-    // Update processor parameters based on machine mode and tape formula
     // Machine Mode: Master (0) = Ampex ATR-102, Tracks (1) = Studer A820
     // Tape Formula: GP9 (0), SM900 (1)
-    // The bias value determines which internal parameters are used (threshold at 0.74)
-    const double bias = (machineMode == 0) ? 0.65 : 0.82;
-
-    // Set processor parameters (input gain = 1.0, we apply drive externally via inputTrim)
-    tapeProcessorLeft.setParameters (bias, 1.0, tapeFormula);
-    tapeProcessorRight.setParameters (bias, 1.0, tapeFormula);
+    // A change starts a crossfade to the standby engine; a change made while a
+    // switch is running is picked up once that switch has completed
+    const TapeEngine& currentEngine = trackGroups.front()->tapeEngines[activeEngine];
+    if (! switchInProgress
+        && (machineMode != currentEngine.machineMode || tapeFormula != currentEngine.tapeFormula))
+        beginModeSwitch (machineMode, tapeFormula);
+
+    // Studer-only effects follow the crossfade (0 = Ampex, 1 = Studer)
+    const bool switching = switchInProgress;
+    const float studerFrom = (currentEngine.machineMode == 1) ? 1.0f : 0.0f;
+    const float studerTo = switching ? ((trackGroups.front()->tapeEngines[1 - activeEngine].machineMode == 1) ? 1.0f : 0.0f)
+                                     : studerFrom;
 
     const int numSamples = buffer.getNumSamples();
-    float peakLevel = 0.0f;
+    const int numChannels = juce::jmin (totalNumInputChannels, numTracks);
 
     // Apply input trim (Drive) BEFORE oversampling and measure level for metering
     // Same input gain for both modes - user controls drive with the knob
     const float globalInputGain = 0.501f;  // -6dB for both modes
 
+    // Drive and Volume changes ramp over GAIN_RAMP_SECONDS (folded into the gain stages)
+    inputTrimSmoothed.setTargetValue (inputTrimValue);
+    outputTrimSmoothed.setTargetValue (outputTrimValue);
+    const bool inputRamping = fillGainRamp (inputTrimSmoothed, inputGainRamp, numSamples, globalInputGain);
+    const bool outputRamping = fillGainRamp (outputTrimSmoothed, outputGainRamp, numSamples, 1.0f / globalInputGain);
+
+    // Meter: even tracks on the left side, odd tracks on the right, averaged per side
+    const int leftTracks = (totalNumInputChannels + 1) / 2;
+    const int rightTracks = totalNumInputChannels / 2;
+    const float sideWeight[MeterFeed::NUM_SIDES] = { 1.0f / static_cast<float> (juce::jmax (1, leftTracks)),
+                                                     rightTracks > 0 ? 1.0f / static_cast<float> (rightTracks) : 0.0f };
+
     for (int ch = 0; ch < totalNumInputChannels; ++ch)
     {
         auto* channelData = buffer.getWritePointer (ch);
-        for (int sample = 0; sample < numSamples; ++sample)
+        if (inputRamping)
+            juce::FloatVectorOperations::multiply (channelData, inputGainRamp.data(), numSamples);
+        else
+            juce::FloatVectorOperations::multiply (channelData, inputTrimValue * globalInputGain, numSamples);
+
+        const int side = ch & 1;
+        const auto range = juce::FloatVectorOperations::findMinAndMax (channelData, numSamples);
+        meterFrame.peak[side] = std::max ({ meterFrame.peak[side], -range.getStart(), range.getEnd() });
+        meterFrame.sumSquares[side] += sumOfSquares (channelData, numSamples) * sideWeight[side];
+    }
+
+    meterFrame.numSamples += numSamples;
+    if (meterFrame.numSamples >= meterFrameSamples)
+    {
+        if (rightTracks == 0)
         {
-            channelData[sample] *= inputTrimValue * globalInputGain;
-            peakLevel = std::max (peakLevel, std::abs (channelData[sample]));
+            meterFrame.peak[1] = meterFrame.peak[0];
+            meterFrame.sumSquares[1] = meterFrame.sumSquares[0];
         }
+
+        meterFeed.push (meterFrame);  // Dropped while no editor is reading
+        meterFrame = {};
     }
 
-    // === TAPE PROCESSING ===
-    // At high sample rates (88.2kHz+), process at native rate (no oversampling)
-    // At lower sample rates, use 2x oversampling for anti-aliasing
+    // === TAPE PROCESSING + POST-PROCESSING, per track group ===
+    // During a mode switch each engine's gain compensation is applied inside the crossfade
+    // finalMakeupGain is exact inverse of globalInputGain for unity gain
+    BlockSettings settings;
+    settings.numSamples = numSamples;
+    settings.tapeGainComp = switching ? 1.0f : currentEngine.getGainCompensation();
+    settings.outputGain = outputTrimValue * (1.0f / globalInputGain);
+    settings.outputGainRamp = outputRamping ? outputGainRamp.data() : nullptr;
+    settings.studerFrom = studerFrom;
+    settings.studerTo = studerTo;
+    settings.switching = switching;
+
+    // Groups touch only their own channels and state: spread them across cores when enabled
+    auto processGroup = [this, &buffer, &settings, numChannels] (int index)
+    {
+        TrackGroup& group = *trackGroups[static_cast<size_t> (index)];
+        if (group.firstChannel + group.numChannels <= numChannels)
+            processTrackGroup (group, buffer, settings);
+    };
 
-    if (useOversampling)
+    const int numGroups = static_cast<int> (trackGroups.size());
+    if (*multicoreParam > 0.5f)
+    {
+        workerPool.run (numGroups, processGroup);
+    }
+    else
     {
-        // === OVERSAMPLING: Upsample to 2x rate ===
-        juce::dsp::AudioBlock<float> block (buffer);
-        juce::dsp::AudioBlock<float> oversampledBlock = oversampler->processSamplesUp (block);
+        for (int g = 0; g < numGroups; ++g)
+            processGroup (g);
+    }
 
-        // Process at oversampled rate (2x sample rate)
-        const int oversampledNumSamples = static_cast<int> (oversampledBlock.getNumSamples());
+    // === ADJACENT-TRACK CROSSTALK (Studer, multitrack buses) ===
+    const auto crosstalkStart = ProcessorDiagnostics::now();
+    if (adjacentTrackCrosstalk && (studerFrom > 0.0f || studerTo > 0.0f))
+        processAdjacentTrackCrosstalk (buffer, numChannels, numSamples, studerFrom, studerTo, switching);
+    const auto crosstalkTicks = ProcessorDiagnostics::now() - crosstalkStart;
 
-        for (int sample = 0; sample < oversampledNumSamples; ++sample)
+    // Advance the mode switch timeline; hand over to the new engine once faded in
+    if (switching)
+    {
+        switchPosition += numSamples;
+        if (switchPosition >= switchWarmupSamples + switchCrossfadeSamples)
+            finishModeSwitch();
+    }
+
+    if constexpr (ProcessorDiagnostics::enabled)
+        publishDiagnostics (blockStart, crosstalkTicks, numSamples);
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::publishDiagnostics (ProcessorDiagnostics::Ticks blockStart,
+                                                                   ProcessorDiagnostics::Ticks crosstalkTicks,
+                                                                   int numSamples)
+{
+    ProcessorDiagnostics::BlockMeasurement block;
+    block.stageTicks[ProcessorDiagnostics::trackCrosstalk] = crosstalkTicks;
+    block.blockDurationSeconds = numSamples / getSampleRate();
+
+    // Groups are finished (workerPool.run has returned): their counters are safe to read here
+    for (auto& group : trackGroups)
+    {
+        for (int s = 0; s < ProcessorDiagnostics::trackCrosstalk; ++s)
         {
-            // Process left channel
-            float leftSample = oversampledBlock.getSample (0, sample);
-            float leftProcessed = static_cast<float> (tapeProcessorLeft.processSample (leftSample));
-            oversampledBlock.setSample (0, sample, leftProcessed);
+            block.stageTicks[s] += group->stageTicks[s];
+            group->stageTicks[s] = 0;
+        }
 
-            // Process right channel (with azimuth delay)
-            if (oversampledBlock.getNumChannels() > 1)
-            {
-                float rightSample = oversampledBlock.getSample (1, sample);
-                float rightProcessed = static_cast<float> (tapeProcessorRight.processRightChannel (rightSample));
-                oversampledBlock.setSample (1, sample, rightProcessed);
-            }
+        for (auto& engine : group->tapeEngines)
+            engine.collectDiagnostics (block.tape);
+    }
+
+    block.blockTicks = ProcessorDiagnostics::now() - blockStart;
+    diagnostics.publish (block);
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::processTrackGroup (TrackGroup& group, juce::AudioBuffer<float>& buffer,
+                                                                  const BlockSettings& settings)
+{
+    const bool isStereo = (group.numChannels > 1);
+    auto stageStart = ProcessorDiagnostics::now();
+
+    // Adds the time since the previous mark to a stage (compiles out without diagnostics)
+    auto markStage = [&group, &stageStart] (int stage)
+    {
+        if constexpr (ProcessorDiagnostics::enabled)
+        {
+            const auto stageEnd = ProcessorDiagnostics::now();
+            group.stageTicks[stage] += stageEnd - stageStart;
+            stageStart = stageEnd;
         }
+        else
+        {
+            juce::ignoreUnused (group, stageStart, stage);
+        }
+    };
+
+    // === IDLE BYPASS ===
+    // Silent input and a decayed tail: nothing to process, output silence
+    if (updateIdleState (group, buffer, settings.numSamples))
+    {
+        for (int ch = 0; ch < group.numChannels; ++ch)
+            buffer.clear (group.firstChannel + ch, 0, settings.numSamples);
+
+        group.wowModulator.advancePhases (settings.numSamples);  // Stay in sync with the other groups
+        return;
+    }
+
+    // === TAPE PROCESSING ===
+    // Oversampled (2x/4x/8x) for anti-aliasing, or native rate when oversampling is off
+    // (Auto turns it off at 88.2kHz+)
+
+    if (group.oversampler != nullptr)
+    {
+        // === OVERSAMPLING: Upsample ===
+        juce::dsp::AudioBlock<float> block = juce::dsp::AudioBlock<float> (buffer)
+            .getSubsetChannelBlock (static_cast<size_t> (group.firstChannel), static_cast<size_t> (group.numChannels));
+        juce::dsp::AudioBlock<float> oversampledBlock = group.oversampler->processSamplesUp (block);
+        markStage (ProcessorDiagnostics::upsample);
+
+        // Process at oversampled rate
+        const int oversampledNumSamples = static_cast<int> (oversampledBlock.getNumSamples());
+        float* leftData = oversampledBlock.getChannelPointer (0);
+        float* rightData = isStereo ? oversampledBlock.getChannelPointer (1) : nullptr;
+        processTapeEngines (group, leftData, rightData, oversampledNumSamples, 1 << oversamplingOrder);
+        markStage (ProcessorDiagnostics::tapeCore);
 
         // === OVERSAMPLING: Downsample back to original rate ===
-        oversampler->processSamplesDown (block);
+        group.oversampler->processSamplesDown (block);
+        markStage (ProcessorDiagnostics::downsample);
     }
     else
     {
-        // === HIGH SAMPLE RATE: Process at native rate (no oversampling) ===
+        // === NATIVE RATE: No oversampling ===
         // At 96kHz+, Nyquist is 48kHz+ providing adequate headroom for saturation harmonics
         // Zero latency, no decimation filter phase artifacts
 
-        float* leftData = buffer.getWritePointer (0);
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            leftData[sample] = static_cast<float> (tapeProcessorLeft.processSample (leftData[sample]));
-        }
-
-        if (totalNumInputChannels > 1)
-        {
-            float* rightData = buffer.getWritePointer (1);
-            for (int sample = 0; sample < numSamples; ++sample)
-            {
-                rightData[sample] = static_cast<float> (tapeProcessorRight.processRightChannel (rightData[sample]));
-            }
-        }
+        float* leftData = buffer.getWritePointer (group.firstChannel);
+        float* rightData = isStereo ? buffer.getWritePointer (group.firstChannel + 1) : nullptr;
+        processTapeEngines (group, leftData, rightData, settings.numSamples, 1);
+        markStage (ProcessorDiagnostics::tapeCore);
     }
 
-    // === POST-PROCESSING GAIN COMPENSATION ===
-    // Tape processing has inherent gain changes - compensate to maintain unity
-    // Measured at 0VU (-10dBFS): Ampex -0.25dB, Studer +0.20dB
-    const float tapeGainComp = (machineMode == 0) ? 1.029f : 0.977f;
-    for (int ch = 0; ch < totalNumInputChannels; ++ch)
+    // === POST-PROCESSING (single fused pass at base rate) ===
+    // Gain comp → Crosstalk (Studer, stereo) → Wow (Studer) → Tolerance EQ → Print-through (Studer)
+    // → Output trim (Volume) and final makeup gain
+    float* leftData = buffer.getWritePointer (group.firstChannel);
+    float* rightData = isStereo ? buffer.getWritePointer (group.firstChannel + 1) : nullptr;
+
+    dispatchPostChain (group, leftData, rightData, settings.numSamples, settings.tapeGainComp,
+                       settings.outputGain, settings.outputGainRamp, settings.studerFrom, settings.studerTo,
+                       settings.switching);
+    markStage (ProcessorDiagnostics::postChain);
+
+    // Output decay towards idle (checked before adjacent-track crosstalk, which is per track)
+    float outputPeak = 0.0f;
+    for (int ch = 0; ch < group.numChannels; ++ch)
+        outputPeak = juce::jmax (outputPeak, buffer.getMagnitude (group.firstChannel + ch, 0, settings.numSamples));
+
+    if (outputPeak < SILENCE_THRESHOLD)
+        group.silentOutputSamples = juce::jmin (group.silentOutputSamples + settings.numSamples, idleHoldSamples);
+    else
+        group.silentOutputSamples = 0;
+}
+
+bool TapeMachinePluginSimulatorAudioProcessor::updateIdleState (TrackGroup& group, const juce::AudioBuffer<float>& buffer,
+                                                                int numSamples) const
+{
+    float inputPeak = 0.0f;
+    for (int ch = 0; ch < group.numChannels; ++ch)
+        inputPeak = juce::jmax (inputPeak, buffer.getMagnitude (group.firstChannel + ch, 0, numSamples));
+
+    if (inputPeak >= SILENCE_THRESHOLD)
     {
-        auto* channelData = buffer.getWritePointer (ch);
-        for (int sample = 0; sample < numSamples; ++sample)
-            channelData[sample] *= tapeGainComp;
+        group.silentInputSamples = 0;
+        return false;
     }
 
-    // === CROSSTALK: Studer mode only ===
-    // Simulates adjacent track bleed on 24-track tape machines
-    // Adds bandpassed mono signal at -55dB to both channels
-    if (machineMode == 1 && totalNumInputChannels >= 2)  // Studer mode, stereo only
-    {
-        float* leftData = buffer.getWritePointer (0);
-        float* rightData = buffer.getWritePointer (1);
+    group.silentInputSamples = juce::jmin (group.silentInputSamples + numSamples, idleHoldSamples);
+
+    // Engines, filters and delay lines keep their (decayed) state, so the block that
+    // brings signal back continues exactly where processing stopped
+    return group.silentInputSamples >= idleHoldSamples
+        && group.silentOutputSamples >= idleHoldSamples;
+}
 
-        for (int sample = 0; sample < numSamples; ++sample)
+//==============================================================================
+void TapeMachinePluginSimulatorAudioProcessor::dispatchPostChain (TrackGroup& group, float* leftData, float* rightData,
+                                                                  int numSamples, float tapeGainComp, float outputGain,
+                                                                  const float* outputGainRamp,
+                                                                  float studerFrom, float studerTo, bool switching)
+{
+    // Studer-only stages run while either side of a switch is Studer
+    const bool studer = (studerFrom > 0.0f || studerTo > 0.0f);
+
+    if (rightData != nullptr)
+    {
+        if (switching)
         {
-            // Sum to mono
-            float mono = (leftData[sample] + rightData[sample]) * 0.5f;
-            // Bandpass and attenuate
-            float crosstalk = crosstalkFilter.process (mono);
-            // Add to both channels
-            leftData[sample] += crosstalk;
-            rightData[sample] += crosstalk;
+            if (studer) processPostChain<true, true, true>   (group, leftData, rightData, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
+            else        processPostChain<true, false, true>  (group, leftData, rightData, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
+        }
+        else
+        {
+            if (studer) processPostChain<true, true, false>  (group, leftData, rightData, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
+            else        processPostChain<true, false, false> (group, leftData, rightData, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
         }
     }
-
-    // === WOW MODULATION: Studer only ===
-    // True pitch-based wow via modulated delay line
-    // Ampex ATR-102 has servo-controlled transport with negligible wow - disabled
-    // Studer A820 multitrack has subtle wow (~0.02%) from heavier reels
+    else
     {
-        // Update modulator and tolerance EQ settings if machine mode or tape formula changed
-        // Note: lastMachineMode/lastTapeFormula are member variables, not static, to support multiple instances
-        if (machineMode != lastMachineMode || tapeFormula != lastTapeFormula)
+        if (switching)
         {
-            bool isAmpex = (machineMode == 0);
-            wowModulator.prepare (static_cast<float> (getSampleRate()), isAmpex);
-            toleranceEQ.prepare (static_cast<float> (getSampleRate()),
-                                 totalNumInputChannels >= 2, isAmpex);
-
-            // Reset all DSP components on mode/formula switch to prevent pops from filter state discontinuities
-            // The tape processor's built-in 50ms fade-in will smoothly bring audio back
-            tapeProcessorLeft.reset();
-            tapeProcessorRight.reset();
-            crosstalkFilter.reset();
-            printThrough.reset();
-            wowModulator.reset();
-            toleranceEQ.reset();
-            if (oversampler)
-                oversampler->reset();
-
-            lastMachineMode = machineMode;
-            lastTapeFormula = tapeFormula;
+            if (studer) processPostChain<false, true, true>   (group, leftData, nullptr, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
+            else        processPostChain<false, false, true>  (group, leftData, nullptr, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
         }
-
-        // Apply wow modulation (per-sample processing with interpolated delay)
-        if (totalNumInputChannels >= 2)
+        else
         {
-            float* leftData = buffer.getWritePointer (0);
-            float* rightData = buffer.getWritePointer (1);
+            if (studer) processPostChain<false, true, false>  (group, leftData, nullptr, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
+            else        processPostChain<false, false, false> (group, leftData, nullptr, numSamples, tapeGainComp, outputGain, outputGainRamp, studerFrom, studerTo);
+        }
+    }
+}
+
+template <bool IsStereo, bool IsStuder, bool IsSwitching>
+void TapeMachinePluginSimulatorAudioProcessor::processPostChain (TrackGroup& group, float* leftData, float* rightData,
+                                                                 int numSamples, float tapeGainComp, float outputGain,
+                                                                 const float* outputGainRamp,
+                                                                 float studerFrom, float studerTo)
+{
+    // Multitrack buses model crosstalk between adjacent tracks instead (processAdjacentTrackCrosstalk)
+    const bool pairCrosstalk = ! adjacentTrackCrosstalk;
+    const bool printThroughEnabled = ! trackingActive;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        float left = leftData[sample] * tapeGainComp;
+        float right = IsStereo ? rightData[sample] * tapeGainComp : 0.0f;
 
-            for (int sample = 0; sample < numSamples; ++sample)
+        // Studer-only effects follow the crossfade (0 = Ampex, 1 = Studer)
+        float studerAmount = studerFrom;
+        if constexpr (IsSwitching)
+            studerAmount = studerFrom + (studerTo - studerFrom) * getSwitchGain (switchPosition + sample + 1);
+
+        if constexpr (IsStuder)
+        {
+            // === CROSSTALK ===
+            // Simulates adjacent track bleed on 24-track tape machines
+            // Adds bandpassed mono signal at -55dB to both channels (stereo only)
+            if constexpr (IsStereo)
             {
-                wowModulator.processSample (leftData[sample], rightData[sample]);
+                if (pairCrosstalk)
+                {
+                    float crosstalk = group.crosstalkFilter.process ((left + right) * 0.5f);
+                    if constexpr (IsSwitching)
+                        crosstalk *= studerAmount;
+                    left += crosstalk;
+                    right += crosstalk;
+                }
             }
-        }
-        else if (totalNumInputChannels == 1)
-        {
-            float* monoData = buffer.getWritePointer (0);
-            float dummy = 0.0f;
 
-            for (int sample = 0; sample < numSamples; ++sample)
+            // === WOW MODULATION ===
+            // True pitch-based wow via modulated delay line (enabled exactly while Studer is active)
+            // During a mode switch the delay itself is faded with studerAmount (see WowModulator)
+            if constexpr (IsSwitching)
             {
-                wowModulator.processSample (monoData[sample], dummy);
+                group.wowModulator.processSample (left, right, studerAmount);
             }
+            else
+            {
+                group.wowModulator.processSample (left, right);
+            }
+        }
+
+        // === TOLERANCE EQ: Both modes, machine-specific ===
+        // Models subtle channel-to-channel frequency response variations
+        // Stereo groups get different L/R tolerances; mono groups use the left filters
+        if constexpr (IsStereo)
+            group.toleranceEQ.processSample (left, right);
+        else
+            left = group.toleranceEQ.processMono (left);
+
+        // === PRINT-THROUGH ===
+        // Tails-out storage: subtle post-echo 65ms after the main signal
+        // Left out in tracking mode
+        if constexpr (IsStuder)
+        {
+            if (printThroughEnabled)
+                group.printThrough.processSample (left, right, studerAmount);
         }
+
+        const float gain = (outputGainRamp != nullptr) ? outputGainRamp[sample] : outputGain;
+        leftData[sample] = left * gain;
+        if constexpr (IsStereo)
+            rightData[sample] = right * gain;
     }
+}
 
-    // === TOLERANCE EQ: Both modes, machine-specific ===
-    // Models subtle channel-to-channel frequency response variations
-    // due to tape head manufacturing tolerances on freshly calibrated machines
-    // Ampex ATR-102: ±0.10dB low (60Hz), ±0.12dB high (16kHz) - precision mastering
-    // Studer A820:   ±0.15dB low (75Hz), ±0.18dB high (15kHz) - multitrack variation
-    // Stereo instances get different L/R tolerances; mono instances use same for both
+void TapeMachinePluginSimulatorAudioProcessor::processAdjacentTrackCrosstalk (juce::AudioBuffer<float>& buffer,
+                                                                              int numChannels, int numSamples,
+                                                                              float studerFrom, float studerTo,
+                                                                              bool switching)
+{
+    // Each track picks up the bandpassed sum of the tracks either side of it (one at the edges)
+    // Crosstalk is linear and ~-55dB, so it is added after the per-group chains; the
+    // unmodified neighbours are kept in two scratch rows (previous track / current track)
+    const int capacity = static_cast<int> (crosstalkScratchA.size());
+
+    for (int offset = 0; offset < numSamples; offset += capacity)
     {
-        if (totalNumInputChannels >= 2)
-        {
-            float* leftData = buffer.getWritePointer (0);
-            float* rightData = buffer.getWritePointer (1);
+        const int chunkSize = juce::jmin (capacity, numSamples - offset);
+        float* previous = crosstalkScratchA.data();
+        float* current = crosstalkScratchB.data();
 
-            for (int sample = 0; sample < numSamples; ++sample)
-            {
-                toleranceEQ.processSample (leftData[sample], rightData[sample]);
-            }
-        }
-        else if (totalNumInputChannels == 1)
+        for (int ch = 0; ch < numChannels; ++ch)
         {
-            float* monoData = buffer.getWritePointer (0);
-            float dummy = 0.0f;
+            float* data = buffer.getWritePointer (ch) + offset;
+            const float* next = (ch + 1 < numChannels) ? buffer.getReadPointer (ch + 1) + offset : nullptr;
+            auto& filter = trackCrosstalk[static_cast<size_t> (ch)];
+
+            std::copy (data, data + chunkSize, current);
 
-            for (int sample = 0; sample < numSamples; ++sample)
+            for (int i = 0; i < chunkSize; ++i)
             {
-                toleranceEQ.processSample (monoData[sample], dummy);
+                float neighbours = 0.0f;
+                if (ch > 0)
+                    neighbours += previous[i];
+                if (next != nullptr)
+                    neighbours += next[i];
+
+                float crosstalk = filter.process (neighbours);
+                if (switching)
+                    crosstalk *= studerFrom + (studerTo - studerFrom) * getSwitchGain (switchPosition + offset + i + 1);
+                data[i] += crosstalk;
             }
+
+            std::swap (previous, current);
         }
     }
+}
 
-    // === PRINT-THROUGH: Studer mode only ===
-    // Simulates tails-out storage: magnetic bleed creating subtle post-echo
-    // Signal-dependent: louder passages create proportionally more print-through
-    // Real-world multitrack tape (more layers, more print-through than 2-track)
-    // 65ms delay represents tape layer spacing at 30 IPS
-    if (machineMode == 1 && totalNumInputChannels >= 2)  // Studer mode, stereo only
+//==============================================================================
+float TapeMachinePluginSimulatorAudioProcessor::sumOfSquares (const float* data, int numSamples)
+{
+    // Four partial sums: independent add chains instead of one long dependency
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    int sample = 0;
+    for (; sample + 4 <= numSamples; sample += 4)
     {
-        float* leftData = buffer.getWritePointer (0);
-        float* rightData = buffer.getWritePointer (1);
+        sum0 += data[sample] * data[sample];
+        sum1 += data[sample + 1] * data[sample + 1];
+        sum2 += data[sample + 2] * data[sample + 2];
+        sum3 += data[sample + 3] * data[sample + 3];
+    }
+    for (; sample < numSamples; ++sample)
+        sum0 += data[sample] * data[sample];
+
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+bool TapeMachinePluginSimulatorAudioProcessor::fillGainRamp (GainSmoother& smoother, std::vector<float>& ramp,
+                                                             int numSamples, float scale)
+{
+    if (! smoother.isSmoothing())
+        return false;
+
+    // Larger than the prepared block size: jump to the target rather than allocate
+    if (numSamples > static_cast<int> (ramp.size()))
+    {
+        smoother.setCurrentAndTargetValue (smoother.getTargetValue());
+        return false;
+    }
+
+    for (int sample = 0; sample < numSamples; ++sample)
+        ramp[static_cast<size_t> (sample)] = smoother.getNextValue() * scale;
+    return true;
+}
+
+//==============================================================================
+TapeMachinePluginSimulatorAudioProcessor::EngineSetup::Mode
+TapeMachinePluginSimulatorAudioProcessor::makeEngineMode (bool nonRealtime) const
+{
+    const double sampleRate = getSampleRate();
+    const int renderQuality = static_cast<int> (*renderQualityParam);
+
+    EngineSetup::Mode mode;
+    mode.tracking = ! nonRealtime && *trackingModeParam > 0.5f;
+
+    int order = 0;
+    if (mode.tracking)
+    {
+        // Tracking: native rate, no oversampler latency (ADAA handles the aliasing)
+        order = 0;
+        mode.linearPhase = false;
+    }
+    else if (nonRealtime && renderQuality > 0)
+    {
+        // Offline render: 4x or 8x linear phase
+        order = renderQuality + 1;
+        mode.linearPhase = true;
+    }
+    else
+    {
+        // Playback: Auto (0), Off (1), 2x (2), 4x (3), 8x (4)
+        const int choice = static_cast<int> (*oversamplingParam);
+        order = (choice == 0) ? (sampleRate < 88200.0 ? 1 : 0) : choice - 1;
+        mode.linearPhase = (static_cast<int> (*oversamplingFilterParam) == 1);
+    }
+
+    // Keep the tape engine at or below 384kHz (8x at 48kHz, 4x at 96kHz, 2x at 192kHz)
+    order = juce::jlimit (0, MAX_OVERSAMPLING_ORDER, order);
+    while (order > 0 && sampleRate * (1 << order) > MAX_ENGINE_SAMPLE_RATE + 1.0)
+        --order;
+
+    mode.oversamplingOrder = order;
+    mode.latencySamples = (order > 0) ? oversamplingLatency[mode.linearPhase ? 1 : 0][order] : 0;
+    mode.tables = engineTables[static_cast<size_t> (order)];
+    return mode;
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::publishEngineSetup()
+{
+    // Message thread or prepareToPlay, with engineSetupLock held: the audio thread only
+    // copies the prepared tables
+    if (engineTables.empty())
+        return;
+
+    auto& setup = engineSetups.getWriteSlot();
+    setup.playback = makeEngineMode (false);
+    setup.render = makeEngineMode (true);
+    publishedLatency[0] = setup.playback.latencySamples;
+    publishedLatency[1] = setup.render.latencySamples;
+    engineSetups.publish();
+
+    reportLatency();
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::reportLatency()
+{
+    // engineSetupLock held, never on the audio thread: hosts may be notified synchronously.
+    // The audio thread swaps the oversampler on its next block
+    setLatencySamples (publishedLatency[isNonRealtime() ? 1 : 0]);
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::setNonRealtime (bool nonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime (nonRealtime);
+
+    // Render and playback modes can run at different oversampling latencies
+    const juce::ScopedLock lock (engineSetupLock);
+    if (! engineTables.empty())
+        reportLatency();
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::applyOversamplingSettings (const EngineSetup::Mode& mode)
+{
+    jassert (mode.tables != nullptr);
+
+    // Engines are re-rated below - hand any running mode switch over first
+    if (switchInProgress)
+        finishModeSwitch();
+
+    const int order = mode.oversamplingOrder;
+    const bool linearPhase = mode.linearPhase;
+    oversamplingOrder = order;
+    oversamplingLinearPhase = linearPhase;
+
+    for (auto& group : trackGroups)
+    {
+        group->oversampler = (order > 0) ? group->oversamplers[linearPhase ? 1 : 0][order - 1].get() : nullptr;
+        if (group->oversampler != nullptr)
+            group->oversampler->reset();
+    }
+
+    // Tape processors run at the oversampled rate
+    // Reset on a quality change - the built-in fade-in brings audio back smoothly
+    setEngineSampleRate (*mode.tables);
+}
 
-        for (int sample = 0; sample < numSamples; ++sample)
+void TapeMachinePluginSimulatorAudioProcessor::applyTrackingMode (bool enabled)
+{
+    trackingActive = enabled;
+
+    for (auto& group : trackGroups)
+    {
+        for (auto& engine : group->tapeEngines)
+            engine.setTrackingMode (enabled);
+
+        // Print-through restarts from silence rather than replaying a stale echo
+        group->printThrough.reset();
+    }
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::setEngineSampleRate (const TapeEngine::Processor::RateTables& tables)
+{
+    for (auto& group : trackGroups)
+    {
+        for (auto& engine : group->tapeEngines)
         {
-            printThrough.processSample (leftData[sample], rightData[sample]);
+            engine.setSampleRate (tables);
+            engine.reset();
         }
+
+        // Reset engines fade in: process again until the fade-in has run and decayed
+        group->silentInputSamples = 0;
+        group->silentOutputSamples = 0;
     }
-    else if (machineMode == 1 && totalNumInputChannels == 1)  // Studer mode, mono
+}
+
+//==============================================================================
+void TapeMachinePluginSimulatorAudioProcessor::beginModeSwitch (int machineMode, int tapeFormula)
+{
+    const bool enteringStuder = (machineMode == 1 && trackGroups.front()->tapeEngines[activeEngine].machineMode != 1);
+
+    for (auto& group : trackGroups)
     {
-        float* monoData = buffer.getWritePointer (0);
-        float dummy = 0.0f;
+        const TapeEngine& current = group->tapeEngines[activeEngine];
+        TapeEngine& standby = group->tapeEngines[1 - activeEngine];
 
-        for (int sample = 0; sample < numSamples; ++sample)
+        // Configure the standby engine and warm-start it from the running state
+        // (configurations are precomputed, so this is a table/coefficient copy)
+        standby.configure (machineMode, tapeFormula);
+        standby.left.copyStateFrom (current.left);
+        standby.right.copyStateFrom (current.right);
+
+        // Entering Studer: start the Studer-only effects from silence, they fade in with the switch
+        if (enteringStuder)
         {
-            printThrough.processSample (monoData[sample], dummy);
+            group->crosstalkFilter.reset();
+            group->printThrough.reset();
+            group->wowModulator.prepare (static_cast<float> (getSampleRate()), false);
         }
     }
 
-    // Apply output trim (Volume) and final makeup gain
-    // finalMakeupGain is exact inverse of globalInputGain for unity gain
-    const float finalMakeupGain = 1.0f / globalInputGain;  // Master: +22dB, Tracks: +18dB
+    if (enteringStuder)
+        for (auto& filter : trackCrosstalk)
+            filter.reset();
 
-    for (int ch = 0; ch < totalNumInputChannels; ++ch)
+    switchInProgress = true;
+    switchPosition = 0;
+}
+
+void TapeMachinePluginSimulatorAudioProcessor::finishModeSwitch()
+{
+    activeEngine = 1 - activeEngine;
+    switchInProgress = false;
+
+    const float sampleRate = static_cast<float> (getSampleRate());
+
+    for (auto& group : trackGroups)
     {
-        auto* channelData = buffer.getWritePointer (ch);
-        for (int sample = 0; sample < numSamples; ++sample)
-            channelData[sample] *= outputTrimValue * finalMakeupGain;
+        const bool isAmpex = (group->tapeEngines[activeEngine].machineMode == 0);
+
+        // Left Studer: wow has faded out, disable it
+        if (isAmpex && group->wowModulator.enabled)
+            group->wowModulator.prepare (sampleRate, true);
+
+        // Swap tolerance EQ coefficients (state kept)
+        group->toleranceEQ.configure (sampleRate, group->numChannels >= 2, isAmpex);
     }
+}
 
-    // Update meter level (convert to dB)
-    float levelDB;
-    if (peakLevel > 0.0001f)
-        levelDB = 20.0f * std::log10 (peakLevel);
-    else
-        levelDB = -96.0f;
-    currentLevelDB.store (levelDB);
+void TapeMachinePluginSimulatorAudioProcessor::processTapeEngines (TrackGroup& group, float* leftData, float* rightData,
+                                                                   int numSamples, int oversamplingFactor)
+{
+    TapeEngine& current = group.tapeEngines[activeEngine];
+
+    if (! switchInProgress)
+    {
+        current.process (leftData, rightData, numSamples);
+        return;
+    }
+
+    // Mode switch: run both engines on the same input and crossfade
+    // Gain compensation of each engine is folded into the mix
+    TapeEngine& target = group.tapeEngines[1 - activeEngine];
+    const float currentComp = current.getGainCompensation();
+    const float targetComp = target.getGainCompensation();
+    const int capacity = static_cast<int> (group.standbyBufferL.size());
+    const double engineToBaseRate = 1.0 / oversamplingFactor;
+
+    // Hosts may exceed the announced block size - work through the preallocated buffers in chunks
+    for (int offset = 0; offset < numSamples; offset += capacity)
+    {
+        const int chunkSize = juce::jmin (capacity, numSamples - offset);
+        float* activeL = leftData + offset;
+        float* activeR = (rightData != nullptr) ? rightData + offset : nullptr;
+        float* standbyL = group.standbyBufferL.data();
+        float* standbyR = (rightData != nullptr) ? group.standbyBufferR.data() : nullptr;
+
+        std::copy (activeL, activeL + chunkSize, standbyL);
+        if (activeR != nullptr)
+            std::copy (activeR, activeR + chunkSize, standbyR);
+
+        current.process (activeL, activeR, chunkSize);
+        target.process (standbyL, standbyR, chunkSize);
+
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            const float gain = getSwitchGain (switchPosition + (offset + i + 1) * engineToBaseRate);
+            const float currentGain = currentComp * (1.0f - gain);
+            const float targetGain = targetComp * gain;
+
+            activeL[i] = activeL[i] * currentGain + standbyL[i] * targetGain;
+            if (activeR != nullptr)
+                activeR[i] = activeR[i] * currentGain + standbyR[i] * targetGain;
+        }
+    }
 }
 
 //==============================================================================
@@ -528,16 +1124,25 @@ void TapeMachinePluginSimulatorAudioProcessor::setStateInformation (const void*
     // Restore parameter state
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
-    if (xmlState.get() != nullptr)
-        if (xmlState->hasTagName (parameters.state.getType()))
-            parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+    if (xmlState.get() != nullptr && xmlState->hasTagName (parameters.state.getType()))
+    {
+        parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+        // A restored state brings its own Volume: drop the auto-gain correction
+        // its Drive change has just queued
+        lastInputTrimValue = static_cast<float> (*inputTrimParam);
+        pendingOutputTrimRatio = 1.0f;
+    }
 }
 
 //==============================================================================
 // Parameter listener callback for auto-gain linking
+// Called on whichever thread changed the parameter (host automation: often the audio
+// thread), so it only records the change: the audio thread applies it at once
+// (getAutoGainOutputTrim), handleAsyncUpdate moves it into the Volume parameter
 void TapeMachinePluginSimulatorAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
 {
-    if (parameterID == PARAM_INPUT_TRIM && !isUpdatingOutputTrim)
+    if (parameterID == PARAM_INPUT_TRIM)
     {
         // Auto-gain: When Drive (input trim) changes, adjust Output Trim to compensate
         // This keeps monitoring level constant while allowing saturation to increase
@@ -546,23 +1151,73 @@ void TapeMachinePluginSimulatorAudioProcessor::parameterChanged (const juce::Str
         //        Output should go from current to current/4 (-12dB compensation)
         //
         // We calculate the RATIO of change and apply it inversely to output trim
+        // Changes arriving before the message thread gets to them accumulate
+        const float ratio = lastInputTrimValue.exchange (newValue) / newValue;  // Inverse ratio
+
+        float pending = pendingOutputTrimRatio.load();
+        while (! pendingOutputTrimRatio.compare_exchange_weak (pending, pending * ratio))
+        {
+        }
+
+        triggerAsyncUpdate();
+    }
+    else if (parameterID != PARAM_OUTPUT_TRIM)
+    {
+        // Oversampling, filter, render quality or tracking mode
+        engineSetupPending = true;
+        triggerAsyncUpdate();
+    }
+}
 
-        float ratio = lastInputTrimValue / newValue;  // Inverse ratio
-        float currentOutputTrim = *outputTrimParam;
-        float newOutputTrim = currentOutputTrim * ratio;
+void TapeMachinePluginSimulatorAudioProcessor::handleAsyncUpdate()
+{
+    if (engineSetupPending.exchange (false))
+    {
+        const juce::ScopedLock lock (engineSetupLock);
+        publishEngineSetup();
+    }
+
+    // The audio thread already applies the correction (getAutoGainOutputTrim); this moves
+    // it into the Volume parameter so the host and the editor see it
+    const float ratio = pendingOutputTrimRatio.load();
+    if (ratio != 1.0f)
+    {
+        // Odd sequence: Volume and the pending ratio disagree until the hand-over is done
+        autoGainSequence.fetch_add (1, std::memory_order_acq_rel);
 
         // Clamp to valid output trim range (0.25 to 4.0)
-        newOutputTrim = std::clamp (newOutputTrim, 0.25f, 4.0f);
+        const float newOutputTrim = std::clamp (*outputTrimParam * ratio, 0.25f, 4.0f);
 
-        // Update output trim parameter (with recursion guard)
-        isUpdatingOutputTrim = true;
         if (auto* param = parameters.getParameter (PARAM_OUTPUT_TRIM))
             param->setValueNotifyingHost (param->convertTo0to1 (newOutputTrim));
-        isUpdatingOutputTrim = false;
 
-        // Remember current input trim for next delta calculation
-        lastInputTrimValue = newValue;
+        // Keep Drive changes that arrived in the meantime
+        float pending = pendingOutputTrimRatio.load();
+        while (! pendingOutputTrimRatio.compare_exchange_weak (pending, pending / ratio))
+        {
+        }
+
+        autoGainSequence.fetch_add (1, std::memory_order_release);
+    }
+}
+
+float TapeMachinePluginSimulatorAudioProcessor::getAutoGainOutputTrim() const
+{
+    // Audio thread: Volume with the auto-gain correction handleAsyncUpdate has not applied
+    // yet, so the output never waits for the message thread (offline bounces)
+    const uint32_t sequence = autoGainSequence.load (std::memory_order_acquire);
+    if ((sequence & 1) == 0)
+    {
+        const float trim = std::clamp (*outputTrimParam * pendingOutputTrimRatio.load (std::memory_order_acquire),
+                                       0.25f, 4.0f);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (autoGainSequence.load (std::memory_order_relaxed) == sequence)
+            return trim;
     }
+
+    // Mid hand-over: hold the last value
+    return outputTrimSmoothed.getTargetValue();
 }
 
 //==============================================================================
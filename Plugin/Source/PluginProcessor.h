@@ -4,7 +4,19 @@
 #include <juce_dsp/juce_dsp.h>
 #include <random>
 #include <chrono>
+#include <vector>
+#include <type_traits>
 #include "DSP/HybridTapeProcessor.h"
+#include "TrackWorkerPool.h"
+#include "ProcessorDiagnostics.h"
+#include "ConfigurationHandoff.h"
+#include "MeterFeed.h"
+
+// Single-precision tape engine (see THDSweepTest::runPrecisionComparison)
+// Off by default: the double engine is the calibrated reference
+#ifndef TAPE_MACHINE_FLOAT_ENGINE
+ #define TAPE_MACHINE_FLOAT_ENGINE 0
+#endif
 
 // Math constants for filter calculations (float precision for JUCE compatibility)
 namespace PluginConstants
@@ -24,11 +36,14 @@ namespace PluginConstants
  * - Machine mode selection (Ampex ATR-102 vs Studer A820)
  * - Input trim control
  * - Auto gain compensation on/off
- * - Zero latency
- * - Stereo processing (independent L/R channels)
+ * - Selectable oversampling (factor, IIR/FIR) with a separate offline render quality
+ * - Mono, stereo and multitrack buses up to 32 channels (one tape processor per track,
+ *   adjacent-track crosstalk, optional multicore processing of track pairs)
+ * - Click-free mode switching (old and new configuration crossfaded, no DSP reset)
  */
 class TapeMachinePluginSimulatorAudioProcessor : public juce::AudioProcessor,
-                                          private juce::AudioProcessorValueTreeState::Listener
+                                          private juce::AudioProcessorValueTreeState::Listener,
+                                          private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -38,6 +53,7 @@ public:
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void setNonRealtime (bool nonRealtime) noexcept override;
 
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
@@ -74,12 +90,23 @@ public:
     static constexpr const char* PARAM_TAPE_FORMULA = "tapeFormula";
     static constexpr const char* PARAM_INPUT_TRIM = "inputTrim";
     static constexpr const char* PARAM_OUTPUT_TRIM = "outputTrim";
+    static constexpr const char* PARAM_OVERSAMPLING = "oversampling";
+    static constexpr const char* PARAM_OVERSAMPLING_FILTER = "oversamplingFilter";
+    static constexpr const char* PARAM_RENDER_QUALITY = "renderQuality";
+    static constexpr const char* PARAM_MULTICORE = "multicore";
+    static constexpr const char* PARAM_TRACKING_MODE = "trackingMode";
+
+    // Largest supported bus (A820 multitrack: 24 tracks, plus headroom for 32-track layouts)
+    static constexpr int MAX_CHANNELS = 32;
 
     // Access to parameter tree state
     juce::AudioProcessorValueTreeState& getValueTreeState() { return parameters; }
 
-    // Get current output level in dB for metering
-    float getCurrentLevelDB() const { return currentLevelDB.load(); }
+    // Tape input level (after Drive) for the editor's meter, drained on the message thread
+    MeterFeed& getMeterFeed() { return meterFeed; }
+
+    // Realtime instrumentation (TAPE_MACHINE_DIAGNOSTICS builds; see ProcessorDiagnostics.h)
+    ProcessorDiagnostics& getDiagnostics() { return diagnostics; }
 
 private:
     //==============================================================================
@@ -89,29 +116,244 @@ private:
     // Parameter tree state
     juce::AudioProcessorValueTreeState parameters;
 
-    // DSP processors (stereo - one per channel)
-    TapeMachine::HybridTapeProcessor tapeProcessorLeft;
-    TapeMachine::HybridTapeProcessor tapeProcessorRight;
+    // Tape engine: one processor per channel, configured for one machine/tape combination
+    struct TapeEngine
+    {
+        using Processor = TapeMachine::HybridTapeProcessorT<std::conditional_t<TAPE_MACHINE_FLOAT_ENGINE != 0, float, double>>;
+
+        Processor left;
+        Processor right;
+        int machineMode = 0;   // 0 = Ampex ATR-102 (Master), 1 = Studer A820 (Tracks)
+        int tapeFormula = 0;   // 0 = GP9, 1 = SM900
+
+        void configure (int newMachineMode, int newTapeFormula)
+        {
+            machineMode = newMachineMode;
+            tapeFormula = newTapeFormula;
+
+            // The bias value determines which internal parameters are used (threshold at 0.74)
+            // Input gain = 1.0, drive is applied externally via inputTrim
+            const double bias = (machineMode == 0) ? 0.65 : 0.82;
+            left.setParameters (bias, 1.0, tapeFormula);
+            right.setParameters (bias, 1.0, tapeFormula);
+        }
+
+        void reset()
+        {
+            left.reset();
+            right.reset();
+        }
+
+        // Prepared tables (Processor::prepareRate): no lock, no allocation
+        void setSampleRate (const Processor::RateTables& tables)
+        {
+            left.setSampleRate (tables);
+            right.setSampleRate (tables);
+
+            // Below 88.2kHz the engine only runs without oversampling: ADAA on the cubic
+            const bool nativeRate = tables.sampleRate < 88200.0;
+            left.setSaturationADAA (nativeRate);
+            right.setSaturationADAA (nativeRate);
+        }
+
+        // Tracking: reduced live-monitoring chain - J-A on its linear small-signal model
+        // and a single dispersive allpass stage. Off = the full calibrated chain.
+        void setTrackingMode (bool enabled)
+        {
+            const double gate = enabled ? std::numeric_limits<double>::infinity()
+                                        : Processor::DEFAULT_JA_GATE_THRESHOLD;
+            const int stages = enabled ? 1 : Processor::NUM_DISPERSIVE_STAGES;
+            left.setJAGateThreshold (gate);
+            right.setJAGateThreshold (gate);
+            left.setDispersiveStages (stages);
+            right.setDispersiveStages (stages);
+        }
+
+        // Azimuth delay on the right channel: stereo buses only. On a multitrack bus the
+        // tracks of a group are neighbours on one head, not a stereo pair, and delaying
+        // every second track would comb-filter when adjacent tracks are summed
+        void setAzimuth (bool enabled) { right.setAzimuthEnabled (enabled); }
+
+        // Tape processing has inherent gain changes - compensate to maintain unity
+        // Measured at 0VU (-10dBFS): Ampex -0.25dB, Studer +0.20dB
+        float getGainCompensation() const { return (machineMode == 0) ? 1.029f : 0.977f; }
+
+        // Counters since the last call, then restarts them (diagnostics builds)
+        void collectDiagnostics (TapeMachine::DiagnosticCounters& sum)
+        {
+            sum += left.getDiagnostics();
+            sum += right.getDiagnostics();
+            left.resetDiagnostics();
+            right.resetDiagnostics();
+        }
+
+        void process (float* leftData, float* rightData, int numSamples)
+        {
+            if (rightData != nullptr)
+            {
+                // Right channel gets the azimuth delay (stereo buses, see setAzimuth)
+                Processor::processStereoBlock (left, right,
+                                               leftData, rightData,
+                                               leftData, rightData,
+                                               numSamples);
+            }
+            else
+            {
+                left.processBlock (leftData, leftData, numSamples);
+            }
+        }
+    };
+
+    // Preallocated engine pool (per track group) - only the active engine runs in steady state
+    // On a machine mode / tape formula change the standby engine is configured for the
+    // new mode, warm-started from the active engine's state, run in parallel and
+    // crossfaded in. Nothing is reset, so the switch neither pops nor drops the audio.
+    // All track groups switch together, so the engine index and timeline are shared.
+    int activeEngine = 0;
+
+    // Mode switch: warm-up (standby runs silently so its EQ/J-A state settles),
+    // then an equal-gain crossfade. Timeline counted in base-rate samples.
+    static constexpr double SWITCH_WARMUP_SECONDS = 0.02;
+    static constexpr double SWITCH_CROSSFADE_SECONDS = 0.03;
+    bool switchInProgress = false;
+    int switchPosition = 0;
+    int switchWarmupSamples = 0;
+    int switchCrossfadeSamples = 1;
+
+    // Idle bypass: once a track group's input has been silent and its output has decayed
+    // below SILENCE_THRESHOLD for IDLE_HOLD_SECONDS, the group is skipped and outputs silence.
+    // The hold outlasts the print-through delay (65 ms) and the DC blocker / EQ ringing;
+    // the first block with signal is processed normally from the state left at idle entry.
+    static constexpr float SILENCE_THRESHOLD = 1.0e-6f;  // -120 dBFS
+    static constexpr double IDLE_HOLD_SECONDS = 0.25;
+    int idleHoldSamples = 1;
+
+    struct TrackGroup;
+    struct BlockSettings;
+
+    void beginModeSwitch (int machineMode, int tapeFormula);
+    void finishModeSwitch();
+    void processTapeEngines (TrackGroup& group, float* leftData, float* rightData,
+                             int numSamples, int oversamplingFactor);
+    void setEngineSampleRate (const TapeEngine::Processor::RateTables& tables);
+
+    // One track group through oversampling, tape engines and the post chain
+    void processTrackGroup (TrackGroup& group, juce::AudioBuffer<float>& buffer, const BlockSettings& settings);
+
+    // Updates the group's silence counters with this block's input; true = skip the block
+    bool updateIdleState (TrackGroup& group, const juce::AudioBuffer<float>& buffer, int numSamples) const;
+
+    // Fused post-tape chain at base rate: one pass for gain comp, crosstalk, wow,
+    // tolerance EQ, print-through and output gain. Specialized for mono/stereo,
+    // Studer effects on/off and mode switch in progress, so disabled stages compile out.
+    void dispatchPostChain (TrackGroup& group, float* leftData, float* rightData, int numSamples,
+                            float tapeGainComp, float outputGain, const float* outputGainRamp,
+                            float studerFrom, float studerTo, bool switching);
+
+    template <bool IsStereo, bool IsStuder, bool IsSwitching>
+    void processPostChain (TrackGroup& group, float* leftData, float* rightData, int numSamples,
+                           float tapeGainComp, float outputGain, const float* outputGainRamp,
+                           float studerFrom, float studerTo);
+
+    // Multitrack buses: bleed from the neighbouring tracks into every track (Studer only)
+    void processAdjacentTrackCrosstalk (juce::AudioBuffer<float>& buffer, int numChannels, int numSamples,
+                                        float studerFrom, float studerTo, bool switching);
+
+    // Crossfade gain (0 = old engine, 1 = new engine) at a base-rate switch position
+    float getSwitchGain (double position) const
+    {
+        const double t = juce::jlimit (0.0, 1.0, (position - switchWarmupSamples) / switchCrossfadeSamples);
+        return static_cast<float> (t * t * (3.0 - 2.0 * t));
+    }
 
     // Atomic parameter pointers for efficient access in process block
     std::atomic<float>* machineModeParam = nullptr;
     std::atomic<float>* tapeFormulaParam = nullptr;
     std::atomic<float>* inputTrimParam = nullptr;
     std::atomic<float>* outputTrimParam = nullptr;
+    std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* oversamplingFilterParam = nullptr;
+    std::atomic<float>* renderQualityParam = nullptr;
+    std::atomic<float>* multicoreParam = nullptr;
+    std::atomic<float>* trackingModeParam = nullptr;
+
+    // Level metering: peak and sum of squares gathered in the Drive loop, pushed to the
+    // editor every METER_FRAME_SECONDS (dB conversion and ballistics happen in the editor)
+    static constexpr double METER_FRAME_SECONDS = 0.005;
+    MeterFeed meterFeed;
+    MeterFeed::Frame meterFrame;  // Being gathered
+    int meterFrameSamples = 240;
+    static float sumOfSquares (const float* data, int numSamples);
+
+    // Oversampling (default "Auto": 2x minimum phase, disabled at sample rates >= 88.2kHz)
+    // Playback: Off / 2x / 4x / 8x with minimum phase IIR or linear phase FIR half-band filters
+    // Offline renders (isNonRealtime) can use a higher quality setting instead
+    // Every factor/filter combination is allocated in prepareToPlay, so switching
+    // quality on the audio thread only selects an oversampler. The new latency is reported
+    // from the message thread (reportLatency)
+    using Oversampler = juce::dsp::Oversampling<float>;
+    static constexpr int MAX_OVERSAMPLING_ORDER = 3;             // 2^3 = 8x
+    static constexpr double MAX_ENGINE_SAMPLE_RATE = 384000.0;   // Factor is reduced above this
+    int oversamplingOrder = -1;          // Active factor = 2^order, -1 = not prepared, 0 = native rate
+    bool oversamplingLinearPhase = false;
+
+    // Shared engine coefficients for every engine rate the oversampling settings can
+    // select (index = order, null above the rate limit), prepared in prepareToPlay: a
+    // quality change on the audio thread then only copies them. Instances at the same
+    // rate share one copy. Guarded by engineSetupLock.
+    using RateTablesHandle = std::shared_ptr<const TapeEngine::Processor::RateTables>;
+    std::vector<RateTablesHandle> engineTables;
+
+    // Tracking mode (live monitoring): native rate, so zero latency, with ADAA saturation,
+    // linearized J-A, one dispersive allpass stage and no print-through.
+    // Realtime only - offline renders always run the full calibrated chain.
+    bool trackingActive = false;
+    void applyTrackingMode (bool enabled);
+
+    // Engine settings derived from the quality parameters (oversampling, filter, render
+    // quality, tracking) with the tables for the resulting engine rate. Prepared on the
+    // message thread whenever one of them changes, picked up by processBlock with one
+    // atomic exchange. Both the realtime and the offline variant are ready, so a switch
+    // to or from non-realtime rendering applies on the very next block.
+    struct EngineSetup
+    {
+        struct Mode
+        {
+            int oversamplingOrder = 0;
+            bool linearPhase = false;
+            bool tracking = false;
+            int latencySamples = 0;     // Oversampler latency, 0 at native rate
+            RateTablesHandle tables;
+        };
+
+        Mode playback;   // Realtime
+        Mode render;     // isNonRealtime()
+    };
+    ConfigurationHandoff<EngineSetup> engineSetups;
+    std::atomic<bool> engineSetupPending { false };
 
-    // Level metering
-    std::atomic<float> currentLevelDB { -96.0f };
+    // Two writers publish setups: prepareToPlay (host thread) and handleAsyncUpdate (message
+    // thread). The lock serializes them and the engineTables rebuild; the audio thread never takes it
+    juce::CriticalSection engineSetupLock;
 
-    // 2x Minimum Phase Oversampling
-    // Automatically disabled at sample rates >= 88.2kHz (already sufficient headroom)
-    // Uses JUCE's IIR half-band polyphase filters for minimum phase response
-    using Oversampler = juce::dsp::Oversampling<float>;
-    std::unique_ptr<Oversampler> oversampler;
-    bool useOversampling = true;  // False when sampleRate >= 88200
+    // Oversampler latency per [linear phase][order] (prepareToPlay), and the playback / render
+    // latency of the last published setup. Guarded by engineSetupLock.
+    int oversamplingLatency[2][MAX_OVERSAMPLING_ORDER + 1] = {};
+    int publishedLatency[2] = {};
+
+    // Reports the latency of the published setup for the current realtime state, with
+    // engineSetupLock held. Message thread / prepareToPlay / setNonRealtime only: latency
+    // changes reach the host from here, never from processBlock
+    void reportLatency();
+
+    EngineSetup::Mode makeEngineMode (bool nonRealtime) const;
+    void publishEngineSetup();
+    void applyOversamplingSettings (const EngineSetup::Mode& mode);
 
     // Crosstalk filter for Studer mode
     // Simulates adjacent track bleed on 24-track tape machines
-    // Bandpassed mono signal mixed at -50dB into both channels
+    // Stereo: bandpassed mono signal mixed at -55dB into both channels
+    // Multitrack: each track gets the bandpassed sum of its neighbours at -55dB
     struct CrosstalkFilter
     {
         // Simple biquad for HP and LP
@@ -185,18 +427,25 @@ private:
         }
     };
 
-    CrosstalkFilter crosstalkFilter;
-
     // Wow Modulator - True pitch-based wow via modulated delay line
     // Real tape wow is frequency modulation from transport speed variations
     // Only active for Studer A820 - ATR-102 has servo-controlled transport with negligible wow
     struct WowModulator
     {
-        // Delay buffer for interpolated delay line
-        static constexpr int MAX_DELAY_SAMPLES = 512;  // ~10ms at 48kHz, plenty for subtle wow
-        float delayBufferL[MAX_DELAY_SAMPLES] = {0};
-        float delayBufferR[MAX_DELAY_SAMPLES] = {0};
-        int writeIndex = 0;
+        // Modulated stereo delay (3rd-order Lagrange interpolation, FractionalDelay.h)
+        // Its ring comes from the track group's delay arena (setBuffer)
+        using Delay = TapeMachine::ModulatedDelay<float>;
+        static constexpr float BASE_DELAY_SECONDS = 0.002f;  // 2ms base delay
+        static constexpr float MODULATION_DEPTH = 0.0004f;   // Max deviation re base delay
+        Delay delay;
+
+        // Base delay + maximum deviation, rounded up to a power of two
+        static int requiredFrames(float sr)
+        {
+            return Delay::requiredFrames(sr * BASE_DELAY_SECONDS * (1.0f + MODULATION_DEPTH));
+        }
+
+        void setBuffer(float* interleaved, int frames) { delay.setBuffer(interleaved, frames); }
 
         // LFO phases (3 incommensurate frequencies for organic feel)
         float phase1 = 0.0f;
@@ -206,6 +455,11 @@ private:
         float initialPhase2 = 0.0f;
         float initialPhase3 = 0.0f;
 
+        // Recursive oscillators follow the phases, re-seeded from them every LFO_RESEED_SAMPLES
+        static constexpr int LFO_RESEED_SAMPLES = 256;
+        TapeMachine::SineLFO<float> lfo1, lfo2, lfo3;
+        int lfoReseedCountdown = 0;  // 0 = re-seed on the next sample
+
         // LFO frequencies (Hz) - slow wow rates typical of multitrack transports
         static constexpr float freq1 = 0.5f;    // Primary capstan wow
         static constexpr float freq2 = 0.83f;   // Reel motor variation
@@ -240,11 +494,28 @@ private:
             phase1 = initialPhase1;
             phase2 = initialPhase2;
             phase3 = initialPhase3;
+
+            delay.setInterpolation(Delay::Interpolation::Lagrange3);
+        }
+
+        // Track groups share one transport: take over another modulator's LFO phases
+        void syncPhasesTo(const WowModulator& other)
+        {
+            initialPhase1 = other.initialPhase1;
+            initialPhase2 = other.initialPhase2;
+            initialPhase3 = other.initialPhase3;
+            phase1 = other.phase1;
+            phase2 = other.phase2;
+            phase3 = other.phase3;
+            lfoReseedCountdown = 0;
         }
 
         void prepare(float sr, bool isAmpex)
         {
             sampleRate = sr;
+            lfo1.setIncrement(2.0 * M_PI * freq1 / sr);
+            lfo2.setIncrement(2.0 * M_PI * freq2 / sr);
+            lfo3.setIncrement(2.0 * M_PI * freq3 / sr);
 
             if (isAmpex)
             {
@@ -263,9 +534,9 @@ private:
                 // At 48kHz, 0.02% speed change = ~0.01 samples variation per sample
                 // We use a base delay of ~2ms with ±0.02% modulation
                 enabled = true;
-                baseDelaySamples = sampleRate * 0.002f;  // 2ms base delay (~96 samples at 48k)
+                baseDelaySamples = sampleRate * BASE_DELAY_SECONDS;  // ~96 samples at 48k
                 // 0.02% wow = base_delay * 0.0002 modulation depth
-                modulationDepthSamples = baseDelaySamples * 0.0004f;  // ~0.04 samples at 48k
+                modulationDepthSamples = baseDelaySamples * MODULATION_DEPTH;  // ~0.04 samples at 48k
             }
 
             reset();
@@ -273,15 +544,24 @@ private:
 
         void reset()
         {
-            for (int i = 0; i < MAX_DELAY_SAMPLES; ++i)
-            {
-                delayBufferL[i] = 0.0f;
-                delayBufferR[i] = 0.0f;
-            }
-            writeIndex = 0;
+            delay.reset();
             phase1 = initialPhase1;
             phase2 = initialPhase2;
             phase3 = initialPhase3;
+            lfoReseedCountdown = 0;
+        }
+
+        // Idle track group: keep the LFOs running with the transport (no audio processed)
+        void advancePhases(int numSamples)
+        {
+            if (!enabled)
+                return;
+
+            const float elapsed = PluginConstants::TWO_PI_F * static_cast<float>(numSamples) / sampleRate;
+            phase1 = std::fmod(phase1 + freq1 * elapsed, PluginConstants::TWO_PI_F);
+            phase2 = std::fmod(phase2 + freq2 * elapsed, PluginConstants::TWO_PI_F);
+            phase3 = std::fmod(phase3 + freq3 * elapsed, PluginConstants::TWO_PI_F);
+            lfoReseedCountdown = 0;
         }
 
         // Process stereo sample with wow modulation
@@ -290,6 +570,35 @@ private:
             if (!enabled)
                 return;
 
+            delay.process(left, right, nextDelaySamples());
+        }
+
+        // Mode switch to or from Studer: the whole delay (base and modulation) is scaled by
+        // amount (0 = none, 1 = full wow), so the signal glides into or out of the delay.
+        // Mixing it with a copy ~2ms behind would comb-filter for the length of the crossfade
+        void processSample(float& left, float& right, float amount)
+        {
+            if (!enabled)
+                return;
+
+            const float delaySamples = amount * nextDelaySamples();
+            if (delaySamples >= 1.0f)
+            {
+                delay.process(left, right, delaySamples);
+                return;
+            }
+
+            // Below one sample (the delay reads one either side): interpolate towards the input
+            const float dryL = left;
+            const float dryR = right;
+            delay.process(left, right, 1.0f);
+            left = dryL + (left - dryL) * delaySamples;
+            right = dryR + (right - dryR) * delaySamples;
+        }
+
+        // Advances the LFOs by one sample: the modulated delay time in samples
+        float nextDelaySamples()
+        {
             // Update LFO phases (per-sample for smooth modulation)
             float phaseInc = PluginConstants::TWO_PI_F / sampleRate;
             phase1 += freq1 * phaseInc;
@@ -300,38 +609,31 @@ private:
             if (phase2 > PluginConstants::TWO_PI_F) phase2 -= PluginConstants::TWO_PI_F;
             if (phase3 > PluginConstants::TWO_PI_F) phase3 -= PluginConstants::TWO_PI_F;
 
+            // Oscillators: one rotation each per sample, exact sines from the phases now and then
+            if (--lfoReseedCountdown < 0)
+            {
+                lfo1.setPhase(phase1);
+                lfo2.setPhase(phase2);
+                lfo3.setPhase(phase3);
+                lfoReseedCountdown = LFO_RESEED_SAMPLES - 1;
+            }
+            else
+            {
+                lfo1.step();
+                lfo2.step();
+                lfo3.step();
+            }
+
             // Combine LFOs with different weights
-            float lfo = std::sin(phase1) * 0.5f +
-                        std::sin(phase2) * 0.3f +
-                        std::sin(phase3) * 0.2f;
+            float lfo = lfo1.value() * 0.5f +
+                        lfo2.value() * 0.3f +
+                        lfo3.value() * 0.2f;
 
             // Calculate modulated delay time
-            float delaySamples = baseDelaySamples + lfo * modulationDepthSamples;
-
-            // Write current samples to delay buffer
-            delayBufferL[writeIndex] = left;
-            delayBufferR[writeIndex] = right;
-
-            // Calculate read position with linear interpolation
-            float readPosFloat = static_cast<float>(writeIndex) - delaySamples;
-            if (readPosFloat < 0.0f) readPosFloat += MAX_DELAY_SAMPLES;
-
-            int readPos0 = static_cast<int>(readPosFloat);
-            int readPos1 = (readPos0 + 1) % MAX_DELAY_SAMPLES;
-            float frac = readPosFloat - static_cast<float>(readPos0);
-            readPos0 = readPos0 % MAX_DELAY_SAMPLES;
-
-            // Linear interpolation for smooth delay modulation
-            left = delayBufferL[readPos0] * (1.0f - frac) + delayBufferL[readPos1] * frac;
-            right = delayBufferR[readPos0] * (1.0f - frac) + delayBufferR[readPos1] * frac;
-
-            // Advance write index
-            writeIndex = (writeIndex + 1) % MAX_DELAY_SAMPLES;
+            return baseDelaySamples + lfo * modulationDepthSamples;
         }
     };
 
-    WowModulator wowModulator;
-
     // Channel Tolerance EQ - models subtle frequency response variations
     // between tape heads/channels due to manufacturing tolerances
     // Based on Studer A820 specs: ±1dB from 60Hz-20kHz, ±2dB at extremes
@@ -441,6 +743,14 @@ private:
         }
 
         void prepare(float sr, bool stereoMode, bool ampexMode)
+        {
+            configure(sr, stereoMode, ampexMode);
+            reset();
+        }
+
+        // Set filter coefficients for a machine type without clearing filter state
+        // (tolerances are fractions of a dB, so swapping coefficients is inaudible)
+        void configure(float sr, bool stereoMode, bool ampexMode)
         {
             sampleRate = sr;
             isStereo = stereoMode;
@@ -509,8 +819,6 @@ private:
                 lowShelfR.setLowShelf(actualLowFreqL, actualLowGainL, Q, sampleRate);
                 highShelfR.setHighShelf(actualHighFreqL, actualHighGainL, Q, sampleRate);
             }
-
-            reset();
         }
 
         void reset()
@@ -528,9 +836,13 @@ private:
             right = lowShelfR.process(right);
             right = highShelfR.process(right);
         }
-    };
 
-    ToleranceEQ toleranceEQ;
+        // Mono: left channel filters only
+        float processMono(float input)
+        {
+            return highShelfL.process(lowShelfL.process(input));
+        }
+    };
 
     // Print-Through (Studer mode only)
     // Simulates magnetic bleed between tape layers on the reel
@@ -539,13 +851,22 @@ private:
     // Real print-through is proportional to the recorded flux level
     struct PrintThrough
     {
-        // Delay buffer for 65ms at up to 192kHz
-        static constexpr int MAX_DELAY_SAMPLES = 12480;  // 65ms @ 192kHz
-        float bufferL[MAX_DELAY_SAMPLES] = {0};
-        float bufferR[MAX_DELAY_SAMPLES] = {0};
+        // Interleaved [L, R] delay line of 65ms at the sample rate, from the track
+        // group's delay arena (setBuffer)
+        static constexpr float DELAY_SECONDS = 0.065f;  // 30 IPS tape layer spacing
+        float* buffer = nullptr;
+        int bufferFrames = 0;
         int writeIndex = 0;
         int delaySamples = 0;
 
+        static int requiredFrames(float sr) { return static_cast<int>(DELAY_SECONDS * sr) + 1; }
+
+        void setBuffer(float* interleaved, int frames)
+        {
+            buffer = interleaved;
+            bufferFrames = frames;
+        }
+
         // Base print-through coefficient (scales with signal level)
         // At unity (0dBFS), this gives approximately -58dB of print-through
         // GP9 tape has ~3dB less print-through than older formulations (456)
@@ -562,30 +883,27 @@ private:
         {
             sampleRate = sr;
             // 65ms delay for 30 IPS tape layer spacing
-            delaySamples = static_cast<int>(0.065f * sampleRate);
-            if (delaySamples >= MAX_DELAY_SAMPLES)
-                delaySamples = MAX_DELAY_SAMPLES - 1;
+            delaySamples = static_cast<int>(DELAY_SECONDS * sampleRate);
+            if (delaySamples >= bufferFrames)
+                delaySamples = bufferFrames - 1;
             reset();
         }
 
         void reset()
         {
-            for (int i = 0; i < MAX_DELAY_SAMPLES; ++i)
-            {
-                bufferL[i] = 0.0f;
-                bufferR[i] = 0.0f;
-            }
+            std::fill(buffer, buffer + 2 * bufferFrames, 0.0f);
             writeIndex = 0;
         }
 
-        void processSample(float& left, float& right)
+        // amount scales the post-echo (1 = Studer, ramps during a mode switch)
+        void processSample(float& left, float& right, float amount = 1.0f)
         {
             // Read delayed ghost from buffer (post-echo stored 65ms ago)
             int readIndex = writeIndex - delaySamples;
-            if (readIndex < 0) readIndex += MAX_DELAY_SAMPLES;
+            if (readIndex < 0) readIndex += bufferFrames;
 
-            float postEchoL = bufferL[readIndex];
-            float postEchoR = bufferR[readIndex];
+            float postEchoL = buffer[2 * readIndex];
+            float postEchoR = buffer[2 * readIndex + 1];
 
             // Signal-dependent print-through:
             // Calculate ghost based on CURRENT signal level (tails-out storage)
@@ -600,31 +918,121 @@ private:
             float printLevelR = (absR > noiseFloor) ? printCoeff * absR : 0.0f;
 
             // Store ghost of current signal (will be read 65ms later as post-echo)
-            bufferL[writeIndex] = left * printLevelL;
-            bufferR[writeIndex] = right * printLevelR;
+            buffer[2 * writeIndex] = left * printLevelL;
+            buffer[2 * writeIndex + 1] = right * printLevelR;
 
             // Advance write index
-            writeIndex = (writeIndex + 1) % MAX_DELAY_SAMPLES;
+            if (++writeIndex == bufferFrames) writeIndex = 0;
 
             // Mix post-echo into output
-            left += postEchoL;
-            right += postEchoR;
+            left += postEchoL * amount;
+            right += postEchoR * amount;
         }
     };
 
-    PrintThrough printThrough;
+    // Track group: one stereo pair of tracks, or a single track (mono bus, last track of
+    // an odd-sized bus). Each group owns its tape engines, oversamplers and post-tape
+    // stages, so groups are independent and can be processed on different cores.
+    // A stereo bus is exactly one group, processed as before.
+    struct TrackGroup
+    {
+        int firstChannel = 0;
+        int numChannels = 2;
+
+        TapeEngine tapeEngines[2];
+        std::unique_ptr<Oversampler> oversamplers[2][MAX_OVERSAMPLING_ORDER];  // [linear phase][order - 1]
+        Oversampler* oversampler = nullptr;  // Active oversampler, nullptr = native rate
 
-    // Track machine mode and tape formula changes (per-instance, not static)
-    int lastMachineMode = -1;
-    int lastTapeFormula = -1;
+        // Standby engine working buffers, sized for the (oversampled) block in prepareToPlay
+        std::vector<float> standbyBufferL;
+        std::vector<float> standbyBufferR;
+
+        CrosstalkFilter crosstalkFilter;  // In-pair crosstalk (stereo bus only)
+        WowModulator wowModulator;
+        ToleranceEQ toleranceEQ;
+        PrintThrough printThrough;
+
+        // Wow and print-through delay lines, one allocation sized for the base rate
+        // (~25 KB at 48kHz); reallocates only when the rate goes up
+        std::vector<float> delayArena;
+
+        void allocateDelayLines(float sampleRate)
+        {
+            const int wowFrames = WowModulator::requiredFrames(sampleRate);
+            const int printFrames = PrintThrough::requiredFrames(sampleRate);
+            delayArena.resize(static_cast<size_t>(2 * (wowFrames + printFrames)));
+            wowModulator.setBuffer(delayArena.data(), wowFrames);
+            printThrough.setBuffer(delayArena.data() + 2 * wowFrames, printFrames);
+        }
+
+        // Idle bypass: consecutive base-rate samples of silent input and of silent output
+        int silentInputSamples = 0;
+        int silentOutputSamples = 0;
+
+        // Stage times of the current block, written by the thread that ran the group
+        ProcessorDiagnostics::Ticks stageTicks[ProcessorDiagnostics::numStages] {};
+    };
+
+    std::vector<std::unique_ptr<TrackGroup>> trackGroups;
+    int numTracks = 0;
+
+    // Multitrack buses (> 2 channels): adjacent-track crosstalk replaces the in-pair mono sum
+    bool adjacentTrackCrosstalk = false;
+    std::vector<CrosstalkFilter> trackCrosstalk;  // One per track
+    std::vector<float> crosstalkScratchA;
+    std::vector<float> crosstalkScratchB;
+
+    // Per-block values shared by all track groups
+    struct BlockSettings
+    {
+        int numSamples = 0;
+        float tapeGainComp = 1.0f;
+        float outputGain = 1.0f;
+        const float* outputGainRamp = nullptr;  // Per-sample output gain while Volume ramps, else outputGain
+        float studerFrom = 0.0f;
+        float studerTo = 0.0f;
+        bool switching = false;
+    };
+
+    // Optional multicore processing of track groups (multitrack buses only)
+    TrackWorkerPool workerPool;
+
+    // Gathers the stage times and engine counters of a block and publishes them
+    ProcessorDiagnostics diagnostics;
+    void publishDiagnostics (ProcessorDiagnostics::Ticks blockStart, ProcessorDiagnostics::Ticks crosstalkTicks,
+                             int numSamples);
+
+    // Drive and Volume ramp per sample instead of stepping once per block (no zipper noise
+    // under automation). Multiplicative = constant speed in dB. Ramps longer than the
+    // prepared block size are not needed: a block larger than that jumps to the target.
+    static constexpr double GAIN_RAMP_SECONDS = 0.02;
+    using GainSmoother = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    GainSmoother inputTrimSmoothed;
+    GainSmoother outputTrimSmoothed;
+    std::vector<float> inputGainRamp;
+    std::vector<float> outputGainRamp;
+
+    // Fills ramp with the next numSamples smoothed values times scale, false once there
+    // is nothing to ramp (the block then uses the constant gain)
+    static bool fillGainRamp (GainSmoother& smoother, std::vector<float>& ramp, int numSamples, float scale);
 
     // Auto-gain: Track the last input trim to detect changes
-    float lastInputTrimValue = 1.0f;  // Default 0dB
-    bool isUpdatingOutputTrim = false;  // Prevent listener recursion
+    // parameterChanged can run on any thread (host automation on the audio thread), so it
+    // only collects the Volume correction. processBlock applies it right away on top of
+    // Volume; handleAsyncUpdate later folds it into the parameter on the message thread
+    std::atomic<float> lastInputTrimValue { 1.0f };  // Default 0dB
+    std::atomic<float> pendingOutputTrimRatio { 1.0f };  // Volume correction not yet applied
+    std::atomic<uint32_t> autoGainSequence { 0 };  // Odd while handleAsyncUpdate hands over
+
+    // Volume times the pending correction, clamped to the Volume range
+    float getAutoGainOutputTrim() const;
 
     // Parameter listener callback
     void parameterChanged (const juce::String& parameterID, float newValue) override;
 
+    // Message thread: auto-gain and engine setups requested by parameterChanged
+    void handleAsyncUpdate() override;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapeMachinePluginSimulatorAudioProcessor)
 };
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include "DSP/HybridTapeProcessor.h"
+
+//==============================================================================
+/**
+ * Realtime instrumentation for the diagnostics panel
+ *
+ * The audio thread measures each block (total time, time per stage, J-A solver
+ * and limiter counters) and publishes it here; the editor polls at 30 Hz.
+ *
+ * - Single writer (audio thread), any number of readers: every value is its own
+ *   relaxed atomic, so a reader may see fields from two neighbouring blocks but
+ *   never waits and never blocks the audio thread
+ * - Stage times are summed over the track groups; with Multicore enabled they are
+ *   CPU time across threads and can add up to more than the block time
+ * - Compile-time switch: with TAPE_MACHINE_DIAGNOSTICS=0 (default) now() is a
+ *   constant, the measuring code is discarded and the panel is not offered
+ */
+class ProcessorDiagnostics
+{
+public:
+    static constexpr bool enabled = TAPE_MACHINE_DIAGNOSTICS != 0;
+
+    enum Stage
+    {
+        upsample = 0,
+        tapeCore,
+        downsample,
+        postChain,
+        trackCrosstalk,
+        numStages
+    };
+
+    static const char* getStageName (int stage)
+    {
+        static const char* const names[numStages] = { "Upsample", "Tape core", "Downsample", "Post chain", "Track crosstalk" };
+        return names[stage];
+    }
+
+    using Ticks = juce::int64;
+
+    static Ticks now() noexcept
+    {
+        if constexpr (enabled)
+            return juce::Time::getHighResolutionTicks();
+        else
+            return 0;
+    }
+
+    // One processed block, filled in by the audio thread
+    struct BlockMeasurement
+    {
+        Ticks blockTicks = 0;
+        Ticks stageTicks[numStages] {};
+        double blockDurationSeconds = 0.0;         // numSamples / sampleRate
+        TapeMachine::DiagnosticCounters tape;      // Summed over all running engines
+    };
+
+    //==============================================================================
+    // Audio thread
+    void publish (const BlockMeasurement& block) noexcept
+    {
+        const double blockSeconds = juce::Time::highResolutionTicksToSeconds (block.blockTicks);
+        const float load = block.blockDurationSeconds > 0.0 ? static_cast<float> (blockSeconds / block.blockDurationSeconds) : 0.0f;
+
+        blockMicroseconds.store (static_cast<float> (blockSeconds * 1.0e6), std::memory_order_relaxed);
+        blockLoad.store (load, std::memory_order_relaxed);
+
+        // Peak since the UI last took it
+        float previousPeak = peakLoad.load (std::memory_order_relaxed);
+        while (load > previousPeak && ! peakLoad.compare_exchange_weak (previousPeak, load, std::memory_order_relaxed)) {}
+
+        for (int s = 0; s < numStages; ++s)
+            stageMicroseconds[s].store (static_cast<float> (juce::Time::highResolutionTicksToSeconds (block.stageTicks[s]) * 1.0e6),
+                                        std::memory_order_relaxed);
+
+        const float iterations = block.tape.jaSolves > 0
+            ? static_cast<float> (static_cast<double> (block.tape.jaIterations) / static_cast<double> (block.tape.jaSolves))
+            : 0.0f;
+        iterationsPerSolve.store (iterations, std::memory_order_relaxed);
+
+        jaNaNResets.fetch_add (block.tape.jaNaNResets, std::memory_order_relaxed);
+        jaSoftLimits.fetch_add (block.tape.jaSoftLimits, std::memory_order_relaxed);
+        jaOutLimits.fetch_add (block.tape.jaOutLimits, std::memory_order_relaxed);
+        jaOutNaNs.fetch_add (block.tape.jaOutNaNs, std::memory_order_relaxed);
+        blocksProcessed.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    //==============================================================================
+    // Any thread
+    float getBlockMicroseconds() const noexcept       { return blockMicroseconds.load (std::memory_order_relaxed); }
+    float getBlockLoad() const noexcept                { return blockLoad.load (std::memory_order_relaxed); }   // 1.0 = whole block duration
+    float takePeakLoad() noexcept                      { return peakLoad.exchange (0.0f, std::memory_order_relaxed); }
+    float getStageMicroseconds (int stage) const noexcept { return stageMicroseconds[stage].load (std::memory_order_relaxed); }
+    float getIterationsPerSolve() const noexcept       { return iterationsPerSolve.load (std::memory_order_relaxed); }  // 0 = linear gate only
+
+    // Totals since the plugin was loaded
+    uint64_t getJANaNResets() const noexcept  { return jaNaNResets.load (std::memory_order_relaxed); }
+    uint64_t getJASoftLimits() const noexcept { return jaSoftLimits.load (std::memory_order_relaxed); }
+    uint64_t getJAOutLimits() const noexcept  { return jaOutLimits.load (std::memory_order_relaxed); }
+    uint64_t getJAOutNaNs() const noexcept    { return jaOutNaNs.load (std::memory_order_relaxed); }
+    uint64_t getBlocksProcessed() const noexcept { return blocksProcessed.load (std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> blockMicroseconds { 0.0f };
+    std::atomic<float> blockLoad { 0.0f };
+    std::atomic<float> peakLoad { 0.0f };
+    std::atomic<float> stageMicroseconds[numStages] {};
+    std::atomic<float> iterationsPerSolve { 0.0f };
+
+    std::atomic<uint64_t> jaNaNResets { 0 };
+    std::atomic<uint64_t> jaSoftLimits { 0 };
+    std::atomic<uint64_t> jaOutLimits { 0 };
+    std::atomic<uint64_t> jaOutNaNs { 0 };
+    std::atomic<uint64_t> blocksProcessed { 0 };
+};
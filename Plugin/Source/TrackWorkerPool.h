@@ -0,0 +1,154 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+/**
+ * Worker pool for multitrack buses
+ *
+ * Runs N independent tasks (one per track group) across a fixed set of worker
+ * threads plus the calling audio thread, and returns once all of them are done.
+ * Tasks are not assigned up front: every thread claims the next unclaimed task
+ * from a shared counter, so a thread that finishes early steals the remaining
+ * groups instead of idling behind a slow one.
+ *
+ * - Threads are started/stopped outside the audio callback (prepareToPlay, destructor)
+ * - run() does not allocate or lock; the audio thread only signals and spins
+ * - Generation, task count and claim index share one atomic word, so a worker still
+ *   busy with the previous block can never claim (or repeat) a task of the next one
+ */
+class TrackWorkerPool
+{
+public:
+    TrackWorkerPool() = default;
+    ~TrackWorkerPool() { stop(); }
+
+    // (Re)start with the given number of worker threads (0 = run everything on the caller)
+    void start (int numWorkers)
+    {
+        if (numWorkers == static_cast<int> (workers.size()))
+            return;
+
+        stop();
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            workers.push_back (std::make_unique<Worker> (*this));
+            workers.back()->startThread (juce::Thread::Priority::highest);
+        }
+    }
+
+    void stop()
+    {
+        for (auto& worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->wakeUp.signal();
+        }
+
+        for (auto& worker : workers)
+            worker->stopThread (1000);
+
+        workers.clear();
+    }
+
+    int getNumWorkers() const { return static_cast<int> (workers.size()); }
+
+    // Runs task (index) for every index in [0, numTasks) and waits for completion
+    template <typename Task>
+    void run (int numTasks, Task& task)
+    {
+        jassert (numTasks <= 0xffff);
+
+        if (workers.empty() || numTasks < 2)
+        {
+            for (int i = 0; i < numTasks; ++i)
+                task (i);
+            return;
+        }
+
+        taskFunction = [] (void* context, int index) { (*static_cast<Task*> (context)) (index); };
+        taskContext = &task;
+        remaining.store (numTasks, std::memory_order_relaxed);
+
+        // Publish the job: new generation and task count, claim index back to 0
+        ++generation;
+        work.store ((static_cast<uint64_t> (generation) << 32) | (static_cast<uint64_t> (numTasks) << 16),
+                    std::memory_order_release);
+
+        const int numToWake = juce::jmin (getNumWorkers(), numTasks - 1);
+        for (int i = 0; i < numToWake; ++i)
+            workers[static_cast<size_t> (i)]->wakeUp.signal();
+
+        // The audio thread works too, then waits for the stragglers
+        processTasks (generation);
+
+        while (remaining.load (std::memory_order_acquire) > 0)
+            std::this_thread::yield();
+    }
+
+private:
+    struct Worker : public juce::Thread
+    {
+        explicit Worker (TrackWorkerPool& p) : juce::Thread ("Tape track worker"), pool (p) {}
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                wakeUp.wait (-1.0);
+
+                if (threadShouldExit())
+                    break;
+
+                pool.processTasks (static_cast<uint32_t> (pool.work.load (std::memory_order_acquire) >> 32));
+            }
+        }
+
+        TrackWorkerPool& pool;
+        juce::WaitableEvent wakeUp;
+    };
+
+    // Claim and run tasks of one job generation until none are left
+    void processTasks (uint32_t jobGeneration)
+    {
+        for (;;)
+        {
+            uint64_t current = work.load (std::memory_order_acquire);
+            int index = -1;
+
+            while (static_cast<uint32_t> (current >> 32) == jobGeneration
+                   && (current & 0xffff) < ((current >> 16) & 0xffff))
+            {
+                if (work.compare_exchange_weak (current, current + 1, std::memory_order_acq_rel))
+                {
+                    index = static_cast<int> (current & 0xffff);
+                    break;
+                }
+            }
+
+            if (index < 0)
+                return;
+
+            taskFunction (taskContext, index);
+            remaining.fetch_sub (1, std::memory_order_acq_rel);
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Current job - written by run() before the generation is published
+    void (*taskFunction) (void*, int) = nullptr;
+    void* taskContext = nullptr;
+    uint32_t generation = 0;
+
+    std::atomic<uint64_t> work { 0 };   // [generation:32 | task count:16 | next task index:16]
+    std::atomic<int> remaining { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackWorkerPool)
+};
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TapeMachine
+{
+
+/**
+ * Benchmark Harness - ns/sample timing with JSON output for regression tracking
+ *
+ * Shared by benchmark.cpp (DSP stages) and the plugin benchmark (full processBlock).
+ * Each measurement times repeated calls of a processing function for at least
+ * minSeconds, several times over, and reports the median and fastest run in
+ * nanoseconds per processed sample (per channel). From that it derives the
+ * real-time load of one instance on one core, and how many instances fit.
+ *
+ * JSON layout: one object per result, one result per line, so reports diff cleanly
+ * and compareWithBaseline() can read an earlier report back without a JSON library.
+ */
+namespace Benchmark
+{
+
+struct Options
+{
+    double minSeconds = 0.05;    // Per repetition
+    int repetitions = 3;         // Median is reported
+    std::vector<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    std::vector<int> blockSizes { 64, 256, 1024 };
+    std::vector<int> channelCounts { 2 };   // Bus widths (plugin benchmark)
+    std::string stageFilter;     // Only stages whose name contains this (empty = all)
+    std::string label;           // Free text stored in the report (release tag, machine name)
+    std::string jsonPath;        // Empty = no JSON file
+    std::string baselinePath;    // Empty = no comparison
+    double tolerancePercent = 10.0;
+};
+
+inline bool wantsStage(const Options& options, const std::string& stage)
+{
+    return options.stageFilter.empty() || stage.find(options.stageFilter) != std::string::npos;
+}
+
+struct Result
+{
+    std::string stage;           // e.g. "HybridTapeProcessor::processSample"
+    std::string config;          // e.g. "studer_gp9"
+    double sampleRate = 0.0;
+    int blockSize = 1;           // 1 for per-sample stages
+    int channels = 1;
+    double nsPerSample = 0.0;    // Median over repetitions, per channel sample
+    double nsPerSampleMin = 0.0;
+
+    // Share of one core needed to run this stage in real time, in percent
+    double realtimeLoadPercent() const { return nsPerSample * sampleRate * channels * 1.0e-7; }
+    double instancesPerCore() const { return realtimeLoadPercent() > 0.0 ? 100.0 / realtimeLoadPercent() : 0.0; }
+
+    std::string key() const
+    {
+        std::ostringstream k;
+        k << stage << '|' << config << '|' << static_cast<long>(sampleRate) << '|' << blockSize << '|' << channels;
+        return k.str();
+    }
+};
+
+struct Configuration
+{
+    const char* name;
+    double biasStrength;         // < 0.74 = Ampex, >= 0.74 = Studer
+    int tapeFormula;             // 0 = GP9, 1 = SM900
+    bool isAmpex() const { return biasStrength < 0.74; }
+    bool isSM900() const { return tapeFormula == 1; }
+};
+
+inline const std::vector<Configuration>& configurations()
+{
+    static const std::vector<Configuration> configs {
+        { "ampex_gp9",    0.50, 0 },
+        { "ampex_sm900",  0.50, 1 },
+        { "studer_gp9",   0.80, 0 },
+        { "studer_sm900", 0.80, 1 }
+    };
+    return configs;
+}
+
+// Deterministic programme-like test signal around 0 VU into the tape core (-6 dB trim
+// already applied): bass, mid and treble partials plus a little noise, so the J-A
+// solver, the level-dependent saturation and the HF split all see realistic work
+inline std::vector<float> makeTestSignal(double sampleRate, int numSamples, double amplitude = 0.35)
+{
+    const double pi = 3.14159265358979323846;
+    std::vector<float> signal(static_cast<size_t>(numSamples));
+    unsigned int noise = 12345u;
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const double t = n / sampleRate;
+        noise = noise * 1664525u + 1013904223u;
+        const double white = (static_cast<double>(noise >> 8) / 16777216.0) * 2.0 - 1.0;
+        const double x = 0.55 * std::sin(2.0 * pi * 97.0 * t)
+                       + 0.30 * std::sin(2.0 * pi * 1013.0 * t)
+                       + 0.10 * std::sin(2.0 * pi * 5521.0 * t)
+                       + 0.05 * white;
+        signal[static_cast<size_t>(n)] = static_cast<float>(amplitude * x);
+    }
+    return signal;
+}
+
+// Keeps results observable so the optimizer cannot drop the measured work
+inline void consume(double value)
+{
+    static volatile double sink = 0.0;
+    sink = sink + value;
+}
+
+/**
+ * Times processChunk(), which must process samplesPerCall samples per channel per call
+ * Returns { median, fastest } ns per sample over the repetitions
+ */
+template <typename ProcessFunction>
+std::pair<double, double> measure(ProcessFunction&& processChunk, int samplesPerCall, const Options& options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warm-up: caches, branch predictors, CPU clock ramp
+    const auto warmupEnd = Clock::now() + std::chrono::duration<double>(0.25 * options.minSeconds);
+    while (Clock::now() < warmupEnd)
+        processChunk();
+
+    std::vector<double> runs;
+    for (int r = 0; r < std::max(1, options.repetitions); ++r)
+    {
+        long long samples = 0;
+        const auto start = Clock::now();
+        double elapsed = 0.0;
+        do
+        {
+            processChunk();
+            samples += samplesPerCall;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < options.minSeconds);
+
+        runs.push_back(elapsed * 1.0e9 / static_cast<double>(samples));
+    }
+
+    std::sort(runs.begin(), runs.end());
+    return { runs[runs.size() / 2], runs.front() };
+}
+
+class Report
+{
+public:
+    explicit Report(std::string benchmarkName) : name(std::move(benchmarkName)) {}
+
+    void add(const Result& result)
+    {
+        results.push_back(result);
+        std::cout << std::left << std::setw(46) << result.stage
+                  << std::setw(14) << result.config << std::right
+                  << std::setw(8) << static_cast<long>(result.sampleRate)
+                  << std::setw(6) << result.blockSize
+                  << std::setw(4) << result.channels
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(11) << result.nsPerSample << " ns"
+                  << std::setw(9) << result.realtimeLoadPercent() << " %"
+                  << std::setprecision(0) << std::setw(9) << result.instancesPerCore() << "\n";
+    }
+
+    static void printHeader()
+    {
+        std::cout << std::left << std::setw(46) << "stage" << std::setw(14) << "config" << std::right
+                  << std::setw(8) << "rate" << std::setw(6) << "block" << std::setw(4) << "ch"
+                  << std::setw(14) << "ns/sample" << std::setw(11) << "core load" << std::setw(9) << "inst" << "\n";
+    }
+
+    const std::vector<Result>& getResults() const { return results; }
+
+    void writeJSON(std::ostream& out, const Options& options, const std::vector<std::pair<std::string, std::string>>& build) const
+    {
+        out << "{\n";
+        out << "  \"benchmark\": \"" << escape(name) << "\",\n";
+        out << "  \"schema\": 1,\n";
+        out << "  \"label\": \"" << escape(options.label) << "\",\n";
+        out << "  \"timestamp\": \"" << timestamp() << "\",\n";
+        out << "  \"build\": {";
+        for (size_t i = 0; i < build.size(); ++i)
+            out << (i ? ", " : " ") << "\"" << escape(build[i].first) << "\": \"" << escape(build[i].second) << "\"";
+        out << " },\n";
+        out << "  \"min_seconds\": " << options.minSeconds << ",\n";
+        out << "  \"repetitions\": " << options.repetitions << ",\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& r = results[i];
+            out << std::fixed
+                << "    { \"stage\": \"" << escape(r.stage) << "\", \"config\": \"" << escape(r.config) << "\""
+                << std::setprecision(0) << ", \"sample_rate\": " << r.sampleRate
+                << ", \"block_size\": " << r.blockSize << ", \"channels\": " << r.channels
+                << std::setprecision(3) << ", \"ns_per_sample\": " << r.nsPerSample
+                << ", \"ns_per_sample_min\": " << r.nsPerSampleMin
+                << ", \"realtime_load_percent\": " << r.realtimeLoadPercent()
+                << std::setprecision(1) << ", \"instances_per_core\": " << r.instancesPerCore() << " }"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    bool writeJSON(const std::string& path, const Options& options,
+                   const std::vector<std::pair<std::string, std::string>>& build) const
+    {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+        writeJSON(file, options, build);
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * Compare against an earlier report written by writeJSON()
+     * Prints every matching result that got slower (or faster) by more than the tolerance
+     * Returns the number of regressions, or -1 if the baseline cannot be read
+     */
+    int compareWithBaseline(const std::string& path, double tolerancePercent) const
+    {
+        std::ifstream file(path);
+        if (!file)
+            return -1;
+
+        std::map<std::string, double> baseline;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            Result r;
+            if (!parseResultLine(line, r))
+                continue;
+            baseline[r.key()] = r.nsPerSample;
+        }
+
+        int regressions = 0, improvements = 0, matched = 0;
+        std::cout << "\nComparison with " << path << " (tolerance " << tolerancePercent << "%):\n";
+        for (const Result& r : results)
+        {
+            const auto it = baseline.find(r.key());
+            if (it == baseline.end() || it->second <= 0.0)
+                continue;
+
+            ++matched;
+            const double change = 100.0 * (r.nsPerSample / it->second - 1.0);
+            if (std::abs(change) <= tolerancePercent)
+                continue;
+
+            const bool slower = change > 0.0;
+            slower ? ++regressions : ++improvements;
+            std::cout << (slower ? "  SLOWER " : "  faster ") << r.stage << " " << r.config
+                      << " " << static_cast<long>(r.sampleRate) << " Hz, block " << r.blockSize
+                      << std::fixed << std::setprecision(2) << ": " << it->second << " -> " << r.nsPerSample
+                      << " ns (" << std::showpos << std::setprecision(1) << change << std::noshowpos << "%)\n";
+        }
+        std::cout << "  " << matched << " matched, " << regressions << " slower, " << improvements << " faster\n";
+        return regressions;
+    }
+
+private:
+    static std::string escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20)
+                escaped += c;
+        }
+        return escaped;
+    }
+
+    static std::string timestamp()
+    {
+        const std::time_t now = std::time(nullptr);
+        char buffer[32] = {};
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        return buffer;
+    }
+
+    // Reads one result line of our own output format
+    static bool findField(const std::string& line, const std::string& field, std::string& value)
+    {
+        const std::string tag = "\"" + field + "\": ";
+        size_t pos = line.find(tag);
+        if (pos == std::string::npos)
+            return false;
+        pos += tag.size();
+
+        if (line[pos] == '"')
+        {
+            const size_t end = line.find('"', pos + 1);
+            if (end == std::string::npos)
+                return false;
+            value = line.substr(pos + 1, end - pos - 1);
+        }
+        else
+        {
+            const size_t end = line.find_first_of(",}", pos);
+            value = line.substr(pos, end - pos);
+        }
+        return true;
+    }
+
+    static bool parseResultLine(const std::string& line, Result& r)
+    {
+        std::string stage, config, rate, block, channels, ns;
+        if (!findField(line, "stage", stage) || !findField(line, "config", config)
+            || !findField(line, "sample_rate", rate) || !findField(line, "block_size", block)
+            || !findField(line, "channels", channels) || !findField(line, "ns_per_sample", ns))
+            return false;
+
+        r.stage = stage;
+        r.config = config;
+        r.sampleRate = std::atof(rate.c_str());
+        r.blockSize = std::atoi(block.c_str());
+        r.channels = std::atoi(channels.c_str());
+        r.nsPerSample = std::atof(ns.c_str());
+        return true;
+    }
+
+    std::string name;
+    std::vector<Result> results;
+};
+
+// Parses the options shared by both benchmarks; returns false on an unknown argument
+// "--rates" / "--blocks" take comma-separated lists, "--quick" is 48 kHz / 256 only
+inline bool parseOptions(int argc, char** argv, Options& options)
+{
+    auto parseList = [](const std::string& text, auto convert) {
+        std::vector<decltype(convert(std::string()))> values;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+            if (!item.empty())
+                values.push_back(convert(item));
+        return values;
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--quick")
+        {
+            options.sampleRates = { 48000.0 };
+            options.blockSizes = { 256 };
+            options.minSeconds = 0.02;
+            options.repetitions = 3;
+        }
+        else if (arg == "--json" && hasValue)         options.jsonPath = argv[++i];
+        else if (arg == "--compare" && hasValue)      options.baselinePath = argv[++i];
+        else if (arg == "--tolerance" && hasValue)    options.tolerancePercent = std::atof(argv[++i]);
+        else if (arg == "--label" && hasValue)        options.label = argv[++i];
+        else if (arg == "--channels" && hasValue)
+            options.channelCounts = parseList(argv[++i], [](const std::string& s) { return std::max(1, std::atoi(s.c_str())); });
+        else if (arg == "--stage" && hasValue)        options.stageFilter = argv[++i];
+        else if (arg == "--min-time" && hasValue)     options.minSeconds = std::max(0.001, std::atof(argv[++i]));
+        else if (arg == "--repetitions" && hasValue)  options.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--rates" && hasValue)
+            options.sampleRates = parseList(argv[++i], [](const std::string& s) { return std::atof(s.c_str()); });
+        else if (arg == "--blocks" && hasValue)
+            options.blockSizes = parseList(argv[++i], [](const std::string& s) { return std::max(1, std::atoi(s.c_str())); });
+        else
+            return false;
+    }
+    return !options.sampleRates.empty() && !options.blockSizes.empty() && !options.channelCounts.empty();
+}
+
+inline void printOptionsUsage()
+{
+    std::cout << "  --json FILE          Write the results as JSON\n"
+                 "  --compare FILE       Compare with an earlier JSON report, exit 1 on slowdowns\n"
+                 "  --tolerance PCT      Slowdown allowed by --compare (default 10)\n"
+                 "  --stage TEXT         Only stages whose name contains TEXT\n"
+                 "  --label TEXT         Stored in the report (release tag, machine name)\n"
+                 "  --rates R1,R2,...    Sample rates (default 44100,48000,88200,96000,176400,192000)\n"
+                 "  --blocks B1,B2,...   Block sizes for the block stages (default 64,256,1024)\n"
+                 "  --channels C1,C2,... Bus widths for the plugin benchmark (default 2)\n"
+                 "  --min-time SECONDS   Time per repetition (default 0.05)\n"
+                 "  --repetitions N      Repetitions, the median is reported (default 3)\n"
+                 "  --quick              48 kHz, block 256, short runs\n";
+}
+
+// Build description stored in the report
+inline std::vector<std::pair<std::string, std::string>> buildInfo()
+{
+    std::vector<std::pair<std::string, std::string>> info;
+#if defined(__clang__)
+    info.push_back({ "compiler", std::string("clang ") + __clang_version__ });
+#elif defined(__GNUC__)
+    info.push_back({ "compiler", std::string("gcc ") + __VERSION__ });
+#elif defined(_MSC_VER)
+    info.push_back({ "compiler", "msvc " + std::to_string(_MSC_VER) });
+#endif
+#ifdef NDEBUG
+    info.push_back({ "assertions", "off" });
+#else
+    info.push_back({ "assertions", "on" });
+#endif
+    return info;
+}
+
+} // namespace Benchmark
+} // namespace TapeMachine
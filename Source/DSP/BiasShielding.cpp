@@ -40,45 +40,60 @@ static void designBell(Biquad& filter, double fc, double gainDB, double Q, doubl
     filter.a2 = (1.0 - alpha / A) / a0;
 }
 
-HFCut::HFCut()
+template <typename SampleType>
+HFCutT<SampleType>::HFCutT()
 {
     updateCoefficients();
     reset();
 }
 
-void HFCut::setSampleRate(double sampleRate)
+template <typename SampleType>
+void HFCutT<SampleType>::setSampleRate(double sampleRate)
 {
     fs = sampleRate;
     updateCoefficients();
 }
 
-void HFCut::setMachineMode(bool isAmpex)
+template <typename SampleType>
+void HFCutT<SampleType>::setMachineMode(bool isAmpex)
 {
     if (ampexMode != isAmpex)
     {
         ampexMode = isAmpex;
-        updateCoefficients();
+        applyCoefficients(ampexMode ? coefficientSet->ampex : coefficientSet->studer);
     }
 }
 
-void HFCut::setMachineAndTape(bool isAmpex, bool isSM900)
+template <typename SampleType>
+void HFCutT<SampleType>::setMachineAndTape(bool isAmpex, bool isSM900)
 {
     if (ampexMode != isAmpex || sm900Mode != isSM900)
     {
         ampexMode = isAmpex;
         sm900Mode = isSM900;
-        updateCoefficients();
+        applyCoefficients(ampexMode ? coefficientSet->ampex : coefficientSet->studer);
     }
 }
 
-void HFCut::reset()
+template <typename SampleType>
+void HFCutT<SampleType>::reset()
 {
     shelf1.reset();
     shelf2.reset();
     bell.reset();
 }
 
-double HFCut::calculateDCGain()
+template <typename SampleType>
+void HFCutT<SampleType>::copyStateFrom(const HFCutT& other)
+{
+    // Same three-biquad topology for both machines, so the memories carry over
+    shelf1.z1 = other.shelf1.z1;  shelf1.z2 = other.shelf1.z2;
+    shelf2.z1 = other.shelf2.z1;  shelf2.z2 = other.shelf2.z2;
+    bell.z1 = other.bell.z1;      bell.z2 = other.bell.z2;
+}
+
+template <typename SampleType>
+double HFCutT<SampleType>::calculateDCGain(const Coefficients& coefficients)
 {
     // Calculate DC gain of each biquad: H(z=1) = (b0 + b1 + b2) / (1 + a1 + a2)
     auto biquadDCGain = [](const Biquad& bq) {
@@ -86,14 +101,15 @@ double HFCut::calculateDCGain()
     };
 
     // Total DC gain is product of all stages
-    double totalGain = biquadDCGain(shelf1)
-                     * biquadDCGain(shelf2)
-                     * biquadDCGain(bell);
+    double totalGain = biquadDCGain(coefficients.shelf1)
+                     * biquadDCGain(coefficients.shelf2)
+                     * biquadDCGain(coefficients.bell);
 
     return totalGain;
 }
 
-void HFCut::updateCoefficients()
+template <typename SampleType>
+void HFCutT<SampleType>::designCoefficients(Coefficients& coefficients, bool isAmpex, double sampleRate)
 {
     // Architecture: Shelf1 + Shelf2 + Bell
     // Achieves flat response below 5kHz with smooth HF rolloff
@@ -102,33 +118,74 @@ void HFCut::updateCoefficients()
     // Research confirms GP9 and SM900 have "compatible frequency response and sensitivity"
     // The bias shielding is determined by machine bias frequency, not tape formula
 
-    if (ampexMode)
+    if (isAmpex)
     {
         // AMPEX ATR-102: 432 kHz bias
         // MORE HF cut (transparent mastering character - HF bypasses saturation)
         // Targets: 0dB@<5k, -4dB@5k, -7dB@10k, -9dB@15k, -11dB@20k
-        designHighShelf(shelf1, 7000.0, -7.0, 1.0, fs);
-        designHighShelf(shelf2, 15000.0, -4.0, 1.0, fs);
-        designBell(bell, 5000.0, -3.5, 2.0, fs);
+        designHighShelf(coefficients.shelf1, 7000.0, -7.0, 1.0, sampleRate);
+        designHighShelf(coefficients.shelf2, 15000.0, -4.0, 1.0, sampleRate);
+        designBell(coefficients.bell, 5000.0, -3.5, 2.0, sampleRate);
     }
     else
     {
         // STUDER A820: 153.6 kHz bias
         // LESS HF cut (warmer multitrack character - more HF into saturation)
         // Targets: 0dB@<5k, -2dB@5k, -5dB@10k, -7dB@15k, -9dB@20k
-        designHighShelf(shelf1, 7500.0, -6.0, 0.8, fs);
-        designHighShelf(shelf2, 16000.0, -3.0, 1.0, fs);
-        designBell(bell, 6000.0, -2.0, 2.0, fs);
+        designHighShelf(coefficients.shelf1, 7500.0, -6.0, 0.8, sampleRate);
+        designHighShelf(coefficients.shelf2, 16000.0, -3.0, 1.0, sampleRate);
+        designBell(coefficients.bell, 6000.0, -2.0, 2.0, sampleRate);
     }
 
     // Normalize to 0dB at DC (LF content goes through saturation at natural level)
-    double dcGain = calculateDCGain();
-    dcNormGain = 1.0 / dcGain;
+    double dcGain = calculateDCGain(coefficients);
+    coefficients.dcNormGain = 1.0 / dcGain;
+}
+
+template <typename SampleType>
+void HFCutT<SampleType>::applyCoefficients(const Coefficients& coefficients)
+{
+    // Copy coefficients only - filter state carries over
+    shelf1.setCoefficients(coefficients.shelf1);
+    shelf2.setCoefficients(coefficients.shelf2);
+    bell.setCoefficients(coefficients.bell);
+    dcNormGain = static_cast<SampleType>(coefficients.dcNormGain);
+}
+
+template <typename SampleType>
+std::shared_ptr<const typename HFCutT<SampleType>::CoefficientSet> HFCutT<SampleType>::acquireCoefficients(double sampleRate)
+{
+    return SharedTableCache<double, CoefficientSet>::acquire(sampleRate, [sampleRate](CoefficientSet& set) {
+        designCoefficients(set.ampex, true, sampleRate);
+        designCoefficients(set.studer, false, sampleRate);
+    });
+}
+
+template <typename SampleType>
+std::shared_ptr<const void> HFCutT<SampleType>::retainCoefficients(double sampleRate)
+{
+    return acquireCoefficients(sampleRate);
+}
+
+template <typename SampleType>
+void HFCutT<SampleType>::setSampleRate(double sampleRate, const std::shared_ptr<const void>& retained)
+{
+    fs = sampleRate;
+    coefficientSet = std::static_pointer_cast<const CoefficientSet>(retained);
+    applyCoefficients(ampexMode ? coefficientSet->ampex : coefficientSet->studer);
 }
 
-double HFCut::processSample(double input)
+template <typename SampleType>
+void HFCutT<SampleType>::updateCoefficients()
 {
-    double x = shelf1.process(input);
+    coefficientSet = acquireCoefficients(fs);
+    applyCoefficients(ampexMode ? coefficientSet->ampex : coefficientSet->studer);
+}
+
+template <typename SampleType>
+SampleType HFCutT<SampleType>::processSample(SampleType input)
+{
+    SampleType x = shelf1.process(input);
     x = shelf2.process(x);
     x = bell.process(x);
 
@@ -136,4 +193,29 @@ double HFCut::processSample(double input)
     return x * dcNormGain;
 }
 
+template <typename SampleType>
+void HFCutT<SampleType>::processBlock(SampleType* data, int numSamples)
+{
+    shelf1.processBlock(data, numSamples);
+    shelf2.processBlock(data, numSamples);
+    bell.processBlock(data, numSamples);
+
+    const SampleType gain = dcNormGain;
+    for (int i = 0; i < numSamples; ++i)
+        data[i] *= gain;
+}
+
+template <typename SampleType>
+void HFCutT<SampleType>::processStereoBlock(HFCutT& left, HFCutT& right, SampleType* interleaved, int numSamples)
+{
+    processBiquadStereo(left.shelf1, right.shelf1, interleaved, numSamples);
+    processBiquadStereo(left.shelf2, right.shelf2, interleaved, numSamples);
+    processBiquadStereo(left.bell, right.bell, interleaved, numSamples);
+
+    applyGainStereo(interleaved, left.dcNormGain, numSamples);
+}
+
+template class HFCutT<float>;
+template class HFCutT<double>;
+
 } // namespace TapeMachine
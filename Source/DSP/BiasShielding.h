@@ -1,28 +1,65 @@
 #pragma once
 
 #include "MathConstants.h"
+#include "SharedTableCache.h"
+#include "StereoLane.h"
 
 namespace TapeMachine
 {
 
 // Biquad filter (Direct Form II Transposed)
-struct Biquad
+// Coefficients, state and arithmetic in SampleType; data may be another type
+// (e.g. a double-precision LF section inside a float engine)
+template <typename SampleType>
+struct BiquadT
 {
-    double b0 = 1.0, b1 = 0.0, b2 = 0.0;
-    double a1 = 0.0, a2 = 0.0;
-    double z1 = 0.0, z2 = 0.0;
+    using ValueType = SampleType;
 
-    void reset() { z1 = z2 = 0.0; }
+    SampleType b0 = 1, b1 = 0, b2 = 0;
+    SampleType a1 = 0, a2 = 0;
+    SampleType z1 = 0, z2 = 0;
 
-    double process(double input)
+    void reset() { z1 = z2 = 0; }
+
+    SampleType process(SampleType input)
     {
-        double output = b0 * input + z1;
+        SampleType output = b0 * input + z1;
         z1 = b1 * input - a1 * output + z2;
         z2 = b2 * input - a2 * output;
         return output;
     }
+
+    // In-place block processing with state held in locals
+    template <typename DataType>
+    void processBlock(DataType* data, int numSamples)
+    {
+        SampleType s1 = z1, s2 = z2;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType input = static_cast<SampleType>(data[i]);
+            const SampleType output = b0 * input + s1;
+            s1 = b1 * input - a1 * output + s2;
+            s2 = b2 * input - a2 * output;
+            data[i] = static_cast<DataType>(output);
+        }
+        z1 = s1;
+        z2 = s2;
+    }
+
+    // Take the coefficients of a (double-precision) design, keep the state
+    template <typename OtherType>
+    void setCoefficients(const BiquadT<OtherType>& design)
+    {
+        b0 = static_cast<SampleType>(design.b0);
+        b1 = static_cast<SampleType>(design.b1);
+        b2 = static_cast<SampleType>(design.b2);
+        a1 = static_cast<SampleType>(design.a1);
+        a2 = static_cast<SampleType>(design.a2);
+    }
 };
 
+using Biquad = BiquadT<double>;
+
 // HFCut - Cut HF before saturation (models AC bias shielding)
 //
 // Models the frequency-dependent effectiveness of AC bias at linearizing
@@ -40,15 +77,34 @@ struct Biquad
 // Target curves:
 //   ATR-102 (GP9): 0dB@<5k, -4dB@5k, -7dB@10k, -9dB@15k, -11dB@20k
 //   A820:          0dB@<5k, -2dB@5k, -5dB@10k, -7dB@15k, -9dB@20k
-class HFCut
+//
+// SampleType (float or double) is the filter precision; the shelves sit at
+// 5kHz and above, so coefficient rounding in float is harmless.
+// Coefficients are always designed in double.
+template <typename SampleType>
+class HFCutT
 {
 public:
-    HFCut();
+    HFCutT();
     void setSampleRate(double sampleRate);
     void setMachineMode(bool isAmpex);
     void setMachineAndTape(bool isAmpex, bool isSM900);
     void reset();
-    double processSample(double input);
+    void copyStateFrom(const HFCutT& other);  // Filter memories only, keeps this curve
+    SampleType processSample(SampleType input);
+    void processBlock(SampleType* data, int numSamples);  // In-place, same result as processSample()
+
+    // Both channels in one SIMD pass over interleaved [L, R] data
+    // Requires identical configuration (coefficients are taken from `left`)
+    static void processStereoBlock(HFCutT& left, HFCutT& right, SampleType* interleaved, int numSamples);
+
+    // Keeps the shared coefficients for sampleRate alive while the handle is held,
+    // so a later setSampleRate(sampleRate) finds them instead of designing them
+    static std::shared_ptr<const void> retainCoefficients(double sampleRate);
+
+    // setSampleRate() with a handle from retainCoefficients(sampleRate): no cache
+    // lookup, no lock, no allocation (audio thread)
+    void setSampleRate(double sampleRate, const std::shared_ptr<const void>& retained);
 
 private:
     double fs = 48000.0;
@@ -56,17 +112,36 @@ private:
     bool sm900Mode = false;
 
     // High shelf filters for main HF rolloff
-    Biquad shelf1;  // Primary shelf (starts around 7kHz)
-    Biquad shelf2;  // Secondary shelf (fine-tune 15-20kHz)
+    BiquadT<SampleType> shelf1;  // Primary shelf (starts around 7kHz)
+    BiquadT<SampleType> shelf2;  // Secondary shelf (fine-tune 15-20kHz)
 
     // Bell filter to shape the knee at 5-6kHz
-    Biquad bell;
+    BiquadT<SampleType> bell;
 
     // DC gain normalization (ensures 0dB at LF)
-    double dcNormGain = 1.0;
+    SampleType dcNormGain = 1;
 
+    // Both machines' coefficients, designed once per sample rate and shared by
+    // every HFCut at that rate (SharedTableCache)
+    // Switching machines copies a set (no trig on the audio thread)
+    struct Coefficients
+    {
+        Biquad shelf1, shelf2, bell;  // Coefficients only, state unused
+        double dcNormGain = 1.0;
+    };
+    struct CoefficientSet
+    {
+        Coefficients ampex, studer;
+    };
+    std::shared_ptr<const CoefficientSet> coefficientSet;
+
+    static std::shared_ptr<const CoefficientSet> acquireCoefficients(double sampleRate);
     void updateCoefficients();
-    double calculateDCGain();
+    void applyCoefficients(const Coefficients& coefficients);
+    static void designCoefficients(Coefficients& coefficients, bool isAmpex, double sampleRate);
+    static double calculateDCGain(const Coefficients& coefficients);
 };
 
+using HFCut = HFCutT<double>;
+
 } // namespace TapeMachine
@@ -0,0 +1,307 @@
+#pragma once
+
+#include "HybridTapeProcessor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace TapeMachine
+{
+
+/**
+ * Calibration Search - parallel parameter search for the calibration tools
+ *
+ * Shared by auto_tune.cpp and fine_sweep.cpp. An objective maps a parameter
+ * vector to an error (e.g. RMS dB deviation from a THD target curve) using a
+ * HybridTapeProcessor; ParallelEvaluator runs batches of such evaluations across
+ * all cores, each worker thread owning its own processor.
+ *
+ * Search modes:
+ *   gridSearch()    - exhaustive cartesian grid (the original sweep, now parallel)
+ *   coarseToFine()  - small grid, then repeatedly zoom the box around the best point
+ *   nelderMead()    - bounded simplex search; reflection, expansion and both
+ *                     contractions are evaluated speculatively in one parallel batch
+ *
+ * A full-chain THD evaluation costs tens of milliseconds, so evaluations dominate
+ * and the searches are written to minimise them, not to be clever about the rest.
+ */
+namespace Calibration
+{
+
+using Parameters = std::vector<double>;
+using Objective = std::function<double(HybridTapeProcessor& proc, const Parameters& params)>;
+
+struct SearchResult
+{
+    Parameters params;
+    double error = 1.0e9;
+    int evaluations = 0;
+    double seconds = 0.0;
+};
+
+inline int defaultThreadCount()
+{
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+class ParallelEvaluator
+{
+public:
+    ParallelEvaluator(double sampleRate, Objective objectiveFunction, int numThreads = 0)
+        : objective(std::move(objectiveFunction))
+    {
+        const int threads = (numThreads > 0) ? numThreads : defaultThreadCount();
+        for (int t = 0; t < threads; ++t)
+        {
+            processors.push_back(std::make_unique<HybridTapeProcessor>());
+            processors.back()->setSampleRate(sampleRate);
+        }
+    }
+
+    int getNumThreads() const { return static_cast<int>(processors.size()); }
+    int getEvaluationCount() const { return evaluationCount; }
+
+    // Errors for all points, in order. Threads take the next unevaluated point.
+    std::vector<double> evaluate(const std::vector<Parameters>& points)
+    {
+        std::vector<double> errors(points.size(), 1.0e9);
+        std::atomic<size_t> next { 0 };
+
+        auto worker = [&](HybridTapeProcessor& proc)
+        {
+            for (size_t i = next++; i < points.size(); i = next++)
+                errors[i] = objective(proc, points[i]);
+        };
+
+        const size_t numThreads = std::min(processors.size(), points.size());
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < numThreads; ++t)
+            threads.emplace_back(worker, std::ref(*processors[t]));
+        if (numThreads > 0)
+            worker(*processors[0]);
+        for (auto& thread : threads)
+            thread.join();
+
+        evaluationCount += static_cast<int>(points.size());
+        return errors;
+    }
+
+    double evaluate(const Parameters& point)
+    {
+        return evaluate(std::vector<Parameters> { point })[0];
+    }
+
+private:
+    Objective objective;
+    std::vector<std::unique_ptr<HybridTapeProcessor>> processors;
+    int evaluationCount = 0;
+};
+
+namespace Detail
+{
+    inline double elapsedSeconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    inline std::vector<Parameters> cartesianProduct(const std::vector<std::vector<double>>& axes)
+    {
+        std::vector<Parameters> points(1);
+        for (const auto& axis : axes)
+        {
+            std::vector<Parameters> expanded;
+            expanded.reserve(points.size() * axis.size());
+            for (const auto& prefix : points)
+            {
+                for (double value : axis)
+                {
+                    expanded.push_back(prefix);
+                    expanded.back().push_back(value);
+                }
+            }
+            points.swap(expanded);
+        }
+        return points;
+    }
+
+    inline Parameters clampToBounds(Parameters p, const Parameters& lower, const Parameters& upper)
+    {
+        for (size_t d = 0; d < p.size(); ++d)
+            p[d] = std::max(lower[d], std::min(upper[d], p[d]));
+        return p;
+    }
+
+    inline Parameters lerp(const Parameters& from, const Parameters& to, double t)
+    {
+        Parameters p(from.size());
+        for (size_t d = 0; d < p.size(); ++d)
+            p[d] = from[d] + t * (to[d] - from[d]);
+        return p;
+    }
+}
+
+// Every combination of the axis values
+inline SearchResult gridSearch(ParallelEvaluator& evaluator, const std::vector<std::vector<double>>& axes)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const int startCount = evaluator.getEvaluationCount();
+
+    const std::vector<Parameters> points = Detail::cartesianProduct(axes);
+    const std::vector<double> errors = evaluator.evaluate(points);
+
+    SearchResult result;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        if (errors[i] < result.error)
+        {
+            result.error = errors[i];
+            result.params = points[i];
+        }
+    }
+    result.evaluations = evaluator.getEvaluationCount() - startCount;
+    result.seconds = Detail::elapsedSeconds(start);
+    return result;
+}
+
+// Grid of pointsPerAxis^N over the box, then the box shrinks to +-1 grid step around
+// the best point (kept inside the original bounds) for the next round
+inline SearchResult coarseToFine(ParallelEvaluator& evaluator, Parameters lower, Parameters upper,
+                                 int pointsPerAxis = 5, int rounds = 4)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const int startCount = evaluator.getEvaluationCount();
+    const Parameters boundsLower = lower;
+    const Parameters boundsUpper = upper;
+    pointsPerAxis = std::max(2, pointsPerAxis);
+
+    SearchResult best;
+    for (int round = 0; round < rounds; ++round)
+    {
+        std::vector<std::vector<double>> axes(lower.size());
+        for (size_t d = 0; d < lower.size(); ++d)
+            for (int i = 0; i < pointsPerAxis; ++i)
+                axes[d].push_back(lower[d] + (upper[d] - lower[d]) * i / (pointsPerAxis - 1));
+
+        const SearchResult roundResult = gridSearch(evaluator, axes);
+        if (roundResult.error < best.error)
+        {
+            best.error = roundResult.error;
+            best.params = roundResult.params;
+        }
+
+        for (size_t d = 0; d < lower.size(); ++d)
+        {
+            const double step = (upper[d] - lower[d]) / (pointsPerAxis - 1);
+            lower[d] = std::max(boundsLower[d], best.params[d] - step);
+            upper[d] = std::min(boundsUpper[d], best.params[d] + step);
+        }
+    }
+
+    best.evaluations = evaluator.getEvaluationCount() - startCount;
+    best.seconds = Detail::elapsedSeconds(start);
+    return best;
+}
+
+// Bounded Nelder-Mead from `initial`, first simplex spread by stepFraction of each range
+// Stops when the simplex errors agree to within `tolerance` (dB) or after maxIterations
+inline SearchResult nelderMead(ParallelEvaluator& evaluator, const Parameters& initial,
+                               const Parameters& lower, const Parameters& upper,
+                               double stepFraction = 0.15, int maxIterations = 200, double tolerance = 1.0e-3)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const int startCount = evaluator.getEvaluationCount();
+    const size_t n = initial.size();
+
+    // Initial simplex: start point plus one step along each axis (inward at the bounds)
+    std::vector<Parameters> simplex { Detail::clampToBounds(initial, lower, upper) };
+    for (size_t d = 0; d < n; ++d)
+    {
+        Parameters vertex = simplex[0];
+        const double step = stepFraction * (upper[d] - lower[d]);
+        vertex[d] = (vertex[d] + step <= upper[d]) ? vertex[d] + step : vertex[d] - step;
+        simplex.push_back(Detail::clampToBounds(vertex, lower, upper));
+    }
+    std::vector<double> errors = evaluator.evaluate(simplex);
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        // Order vertices best to worst
+        std::vector<size_t> order(n + 1);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return errors[a] < errors[b]; });
+        std::vector<Parameters> sortedSimplex;
+        std::vector<double> sortedErrors;
+        for (size_t i : order)
+        {
+            sortedSimplex.push_back(simplex[i]);
+            sortedErrors.push_back(errors[i]);
+        }
+        simplex.swap(sortedSimplex);
+        errors.swap(sortedErrors);
+
+        if (errors[n] - errors[0] < tolerance)
+            break;
+
+        Parameters centroid(n, 0.0);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t d = 0; d < n; ++d)
+                centroid[d] += simplex[i][d] / static_cast<double>(n);
+
+        // Speculative batch: reflection, expansion, outside and inside contraction
+        const Parameters& worst = simplex[n];
+        const std::vector<Parameters> candidates {
+            Detail::clampToBounds(Detail::lerp(centroid, worst, -1.0), lower, upper),
+            Detail::clampToBounds(Detail::lerp(centroid, worst, -2.0), lower, upper),
+            Detail::clampToBounds(Detail::lerp(centroid, worst, -0.5), lower, upper),
+            Detail::clampToBounds(Detail::lerp(centroid, worst, 0.5), lower, upper)
+        };
+        const std::vector<double> candidateErrors = evaluator.evaluate(candidates);
+        const double reflected = candidateErrors[0];
+
+        int accepted = -1;
+        if (reflected < errors[0])
+            accepted = (candidateErrors[1] < reflected) ? 1 : 0;               // Expand
+        else if (reflected < errors[n - 1])
+            accepted = 0;                                                      // Reflect
+        else if (reflected < errors[n])
+            accepted = (candidateErrors[2] <= reflected) ? 2 : -1;             // Outside contraction
+        else
+            accepted = (candidateErrors[3] < errors[n]) ? 3 : -1;              // Inside contraction
+
+        if (accepted >= 0)
+        {
+            simplex[n] = candidates[static_cast<size_t>(accepted)];
+            errors[n] = candidateErrors[static_cast<size_t>(accepted)];
+        }
+        else
+        {
+            // Shrink towards the best vertex
+            std::vector<Parameters> shrunk;
+            for (size_t i = 1; i <= n; ++i)
+                shrunk.push_back(Detail::lerp(simplex[0], simplex[i], 0.5));
+            const std::vector<double> shrunkErrors = evaluator.evaluate(shrunk);
+            for (size_t i = 1; i <= n; ++i)
+            {
+                simplex[i] = shrunk[i - 1];
+                errors[i] = shrunkErrors[i - 1];
+            }
+        }
+    }
+
+    const size_t bestIndex = static_cast<size_t>(std::min_element(errors.begin(), errors.end()) - errors.begin());
+    SearchResult result;
+    result.params = simplex[bestIndex];
+    result.error = errors[bestIndex];
+    result.evaluations = evaluator.getEvaluationCount() - startCount;
+    result.seconds = Detail::elapsedSeconds(start);
+    return result;
+}
+
+} // namespace Calibration
+} // namespace TapeMachine
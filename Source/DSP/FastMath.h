@@ -0,0 +1,122 @@
+#pragma once
+
+#include "MathConstants.h"
+#include <algorithm>
+
+// FastMath - branch-free approximations shared by the tape core and the plugin
+//
+// Every kernel is straight-line code: both sides of a range decision are
+// computed and the result is picked with select(), which compilers lower to
+// a blend / conditional move instead of a jump. That keeps data-dependent
+// branches (zero crossings, level thresholds) out of the J-A solver.
+//
+// fastTanh(), fastLangevin() and clampValue() are templates over the sample
+// type: double or float, or a lane type such as StereoLaneT<double/float>
+// (StereoLane.h) that provides arithmetic, comparisons returning a mask, and
+// select / abs / min / max / copysign (found by argument-dependent lookup).
+// On a lane each lane gets exactly the scalar result (Tests/fast_math_test.cpp).
+// fastSin() reduces its phase with integer arithmetic and is scalar only.
+//
+// fastTanh() and fastLangevin() return exactly what the branched code they
+// replace returned, so porting the J-A solver does not change its output.
+
+namespace TapeMachine
+{
+
+// condition ? a : b, written so the compiler emits a select rather than a jump
+// (lane types bring their own select on a per-lane mask)
+template <typename T>
+inline T select(bool condition, T a, T b)
+{
+    return condition ? a : b;
+}
+
+// std::clamp without the reference-returning branches (lowers to min/max);
+// like std::clamp, a NaN input comes back as NaN
+template <typename T>
+inline T clampValue(T x, T lo, T hi)
+{
+    using std::max;
+    using std::min;
+    return max(min(x, hi), lo);
+}
+
+// Padé approximant of tanh
+// Accurate to ~1e-6 for |x| < 3 (1.5e-5 at |x| = 4), exactly ±1 beyond; ~3-4x faster than std::tanh
+template <typename T>
+inline T fastTanh(T x)
+{
+    // Padé approximant: tanh(x) ≈ x(27 + x²) / (27 + 9x²)
+    // More accurate version with higher order terms
+    T x2 = x * x;
+    T num = x * (T(135135.0) + x2 * (T(17325.0) + x2 * (T(378.0) + x2)));
+    T den = T(135135.0) + x2 * (T(62370.0) + x2 * (T(3150.0) + x2 * T(28.0)));
+    T pade = num / den;
+
+    // For large |x|, tanh saturates to ±1
+    T result = select(x > T(4.0), T(1.0), pade);
+    return select(x < T(-4.0), T(-1.0), result);
+}
+
+/**
+ * Langevin function and its derivative in one pass
+ *   L(x)  = coth(x) - 1/x
+ *   L'(x) = 1/x² - csch²(x) = 1/x² - coth²(x) + 1
+ *
+ * coth(x) is singular at 0, so |x| < 0.01 uses the Taylor series
+ *   L(x)  ≈ x/3 - x³/45 + 2x⁵/945
+ *   L'(x) ≈ 1/3 - x²/15 + 2x⁴/189
+ * Both forms are evaluated; the coth form on a stand-in argument where it is
+ * not used, so it never divides by zero, in a scalar call or in any lane.
+ */
+template <typename T>
+inline void fastLangevin(T x, T& L, T& Ld)
+{
+    using std::abs;
+    const auto small = abs(x) < T(0.01);
+
+    T x2 = x * x;
+    T taylorL = x * (T(1.0 / 3.0) - x2 * (T(1.0 / 45.0) - x2 * T(2.0 / 945.0)));
+    T taylorLd = T(1.0 / 3.0) - x2 * (T(1.0 / 15.0) - x2 * T(2.0 / 189.0));
+
+    T xs = select(small, T(1.0), x);
+    T cothX = T(1.0) / fastTanh(xs);  // coth = 1/tanh
+    T invX = T(1.0) / xs;
+
+    // L is bounded by ±1, L' by its maximum of 1/3 at x = 0
+    T cothL = clampValue(cothX - invX, T(-1.0), T(1.0));
+    T cothLd = clampValue(invX * invX - cothX * cothX + T(1.0), T(0.0), T(1.0 / 3.0 + 0.01));
+
+    L = select(small, taylorL, cothL);
+    Ld = select(small, taylorLd, cothLd);
+}
+
+/**
+ * Sine for phases up to ±2^31·π (radians)
+ * sin(x) = sign(x)·(-1)^q·sin(r) with |x| = qπ + r; r is folded onto [0, π/2]
+ * and evaluated as a degree-11 odd polynomial. Error below 6e-8 in double;
+ * in float the range reduction dominates (2e-7 over one 2π LFO cycle).
+ * Scalar only (the quarter-turn count is an int).
+ */
+template <typename T>
+inline T fastSin(T x)
+{
+    const T halfPi = T(M_PI / 2.0);
+
+    T a = std::abs(x);
+    int q = static_cast<int>(a * T(1.0 / M_PI));
+    T r = a - static_cast<T>(q) * T(M_PI);
+
+    // sin(π - r) = sin(r): fold the upper quarter-turn back onto [0, π/2]
+    r = halfPi - std::abs(r - halfPi);
+
+    T r2 = r * r;
+    T y = r * (T(1.0) + r2 * (T(-1.0 / 6.0) + r2 * (T(1.0 / 120.0) + r2 * (T(-1.0 / 5040.0)
+            + r2 * (T(1.0 / 362880.0) + r2 * T(-1.0 / 39916800.0))))));
+
+    // Odd half-turns flip the sign, and so does a negative phase
+    T sign = static_cast<T>(1 - 2 * (q & 1)) * std::copysign(T(1.0), x);
+    return y * sign;
+}
+
+} // namespace TapeMachine
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "FastMath.h"
+#include <algorithm>
+#include <cmath>
+
+// FractionalDelay - ring-buffer delays with fractional read positions
+//
+//   ThiranDelay      constant delay (azimuth): first-order Thiran allpass,
+//                    flat magnitude, coefficient worked out when the delay changes
+//   ModulatedDelay   time-varying stereo delay (wow): linear or 3rd-order
+//                    Lagrange interpolation on an interleaved [L, R] ring
+//   SineLFO          recursive sine oscillator to drive a modulated delay
+//
+// Ring sizes are powers of two, so wrapping is a mask, not a modulo.
+
+namespace TapeMachine
+{
+
+/**
+ * Constant fractional delay through a first-order Thiran allpass
+ *   y[n] = a*x[n-D] + x[n-D-1] - a*y[n-1],  a = (1 - d) / (1 + d)
+ * with D the integer and d the fractional part of the delay.
+ * The allpass keeps the magnitude response flat (no HF roll-off); the
+ * fraction only shifts the phase. Capacity (a power of two) must exceed the
+ * integer delay + 1.
+ */
+template <typename SampleType, int Capacity>
+class ThiranDelay
+{
+public:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    // Delays below 0.1 samples pass the input straight through
+    void setDelay(double delaySamples)
+    {
+        bypass = delaySamples < 0.1;
+        intDelay = std::min(static_cast<int>(delaySamples), Capacity - 2);
+        const double frac = delaySamples - static_cast<int>(delaySamples);
+        coefficient = static_cast<SampleType>((1.0 - frac) / (1.0 + frac));
+    }
+
+    void reset()
+    {
+        std::fill(buffer, buffer + Capacity, SampleType(0));
+        writeIndex = 0;
+        state = 0;
+    }
+
+    // Signal state only (ring and allpass memory), keeps this delay's setting
+    void copyStateFrom(const ThiranDelay& other)
+    {
+        std::copy(other.buffer, other.buffer + Capacity, buffer);
+        writeIndex = other.writeIndex;
+        state = other.state;
+    }
+
+    SampleType process(SampleType input)
+    {
+        buffer[writeIndex] = input;
+
+        if (bypass) {
+            writeIndex = (writeIndex + 1) & MASK;
+            return input;
+        }
+
+        const int readIndex = (writeIndex - intDelay - 1) & MASK;
+        const int readIndexNext = (readIndex + 1) & MASK;
+        state = coefficient * buffer[readIndexNext] + buffer[readIndex] - coefficient * state;
+
+        writeIndex = (writeIndex + 1) & MASK;
+        return state;
+    }
+
+    // In-place, same result as process() per sample
+    void processBlock(SampleType* data, int numSamples)
+    {
+        int index = writeIndex;
+
+        if (bypass) {
+            for (int i = 0; i < numSamples; ++i) {
+                buffer[index] = data[i];
+                index = (index + 1) & MASK;
+            }
+            writeIndex = index;
+            return;
+        }
+
+        const SampleType a = coefficient;
+        const int offset = intDelay + 1;
+        SampleType y = state;
+        for (int i = 0; i < numSamples; ++i) {
+            buffer[index] = data[i];
+
+            const int readIndex = (index - offset) & MASK;
+            y = a * buffer[(readIndex + 1) & MASK] + buffer[readIndex] - a * y;
+            data[i] = y;
+
+            index = (index + 1) & MASK;
+        }
+        writeIndex = index;
+        state = y;
+    }
+
+private:
+    static constexpr int MASK = Capacity - 1;
+
+    SampleType buffer[Capacity] = {};
+    int writeIndex = 0;
+    SampleType state = 0;  // Allpass output memory
+
+    bool bypass = true;
+    int intDelay = 0;
+    SampleType coefficient = 0;
+};
+
+/**
+ * Time-varying stereo delay on an interleaved [L, R] ring
+ *
+ * The ring lives in caller-owned memory (e.g. a per-track arena allocated in
+ * prepareToPlay): requiredFrames() gives its size, setBuffer() attaches it.
+ * Interpolation loses the most HF at a fraction of 0.5. There linear
+ * interpolation is -1.2 dB at fs/6 and -3 dB at fs/4, and 3rd-order
+ * Lagrange is -0.2 dB and -1.1 dB.
+ */
+template <typename SampleType>
+class ModulatedDelay
+{
+public:
+    enum class Interpolation { Linear, Lagrange3 };
+
+    // Ring frames for delays up to maxDelaySamples: the taps either side of the
+    // read position, rounded up to a power of two
+    static int requiredFrames(double maxDelaySamples)
+    {
+        int frames = 4;
+        while (frames < static_cast<int>(maxDelaySamples) + 4)
+            frames *= 2;
+        return frames;
+    }
+
+    // frames must be a power of two (requiredFrames); memory holds 2 * frames samples
+    void setBuffer(SampleType* interleaved, int frames)
+    {
+        buffer = interleaved;
+        mask = frames - 1;
+    }
+
+    void setInterpolation(Interpolation newInterpolation) { interpolation = newInterpolation; }
+
+    // Clears the frames in use only
+    void reset()
+    {
+        std::fill(buffer, buffer + 2 * (mask + 1), SampleType(0));
+        writeIndex = 0;
+    }
+
+    // Writes (left, right), then replaces them with the signal delaySamples ago
+    // delaySamples must lie in [1, maxDelaySamples] (Lagrange reads one sample either side)
+    void process(SampleType& left, SampleType& right, SampleType delaySamples)
+    {
+        buffer[2 * writeIndex] = left;
+        buffer[2 * writeIndex + 1] = right;
+
+        const int intDelay = static_cast<int>(delaySamples);
+        const SampleType frac = delaySamples - static_cast<SampleType>(intDelay);
+
+        // x0 = x[n - intDelay], x1 = one sample older; the output lies frac of the way to x1
+        const SampleType* x0 = frame(writeIndex - intDelay);
+        const SampleType* x1 = frame(writeIndex - intDelay - 1);
+
+        if (interpolation == Interpolation::Linear) {
+            left = x0[0] * (SampleType(1) - frac) + x1[0] * frac;
+            right = x0[1] * (SampleType(1) - frac) + x1[1] * frac;
+        } else {
+            // Lagrange weights for nodes at -1, 0, 1, 2 evaluated at frac (x[-1] is the newer neighbour)
+            const SampleType* xm = frame(writeIndex - intDelay + 1);
+            const SampleType* x2 = frame(writeIndex - intDelay - 2);
+            const SampleType d = frac;
+            const SampleType dm1 = d - SampleType(1), dm2 = d - SampleType(2), dp1 = d + SampleType(1);
+            const SampleType cm = -d * dm1 * dm2 * SampleType(1.0 / 6.0);
+            const SampleType c0 = dp1 * dm1 * dm2 * SampleType(0.5);
+            const SampleType c1 = -dp1 * d * dm2 * SampleType(0.5);
+            const SampleType c2 = dp1 * d * dm1 * SampleType(1.0 / 6.0);
+            left = cm * xm[0] + c0 * x0[0] + c1 * x1[0] + c2 * x2[0];
+            right = cm * xm[1] + c0 * x0[1] + c1 * x1[1] + c2 * x2[1];
+        }
+
+        writeIndex = (writeIndex + 1) & mask;
+    }
+
+private:
+    SampleType* buffer = nullptr;
+    int mask = -1;
+    int writeIndex = 0;
+    Interpolation interpolation = Interpolation::Linear;
+
+    const SampleType* frame(int index) const { return buffer + 2 * (index & mask); }
+};
+
+/**
+ * Recursive sine oscillator: one complex rotation per sample instead of a sin()
+ *   (s, c) <- (s cos w + c sin w, c cos w - s sin w)
+ * Rounding makes the amplitude drift slowly, so the caller re-seeds it from
+ * its phase accumulator every few hundred samples (setPhase).
+ */
+template <typename SampleType>
+class SineLFO
+{
+public:
+    // increment in radians per sample
+    void setIncrement(double increment)
+    {
+        cosW = static_cast<SampleType>(std::cos(increment));
+        sinW = static_cast<SampleType>(std::sin(increment));
+    }
+
+    // Restart the rotation at phase (radians); value() is then sin(phase)
+    void setPhase(SampleType phase)
+    {
+        s = fastSin(phase);
+        c = fastSin(phase + SampleType(M_PI / 2.0));
+    }
+
+    SampleType value() const { return s; }
+
+    // Advance one sample
+    void step()
+    {
+        const SampleType nextS = s * cosW + c * sinW;
+        c = c * cosW - s * sinW;
+        s = nextS;
+    }
+
+private:
+    SampleType s = 0, c = 1;
+    SampleType cosW = 1, sinW = 0;
+};
+
+} // namespace TapeMachine
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "MathConstants.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace TapeMachine
+{
+
+/**
+ * Harmonic Analyzer - shared THD measurement for the test and calibration tools
+ *
+ * Used by THDSweepTest.h, auto_tune.cpp, fine_sweep.cpp and thd_verify.cpp.
+ * Harmonic amplitudes are read at the exact harmonic frequencies with a
+ * Hann-windowed Goertzel (no FFT bin interpolation, no leakage from bin spacing):
+ *   - The window is computed once per analysis length, not once per sample
+ *   - All harmonics of a tone are evaluated in a single pass over the buffer,
+ *     one Goertzel resonator per harmonic updated side by side
+ *
+ * The results are identical to running the single-frequency Goertzel once per
+ * harmonic; an analyzer is immutable after construction and can be shared
+ * between threads (see CalibrationSearch.h).
+ *
+ * SteppedTone is the matching stimulus: one tone stepping through a list of
+ * levels, so a whole THD-vs-level curve comes from one render instead of a
+ * processor reset and pre-roll per level.
+ */
+class HarmonicAnalyzer
+{
+public:
+    static constexpr int MAX_HARMONIC = 9;
+
+    struct Harmonics
+    {
+        double amplitude[MAX_HARMONIC + 1] = {};  // [1] = fundamental, [n] = nth harmonic, peak
+        int numHarmonics = 0;                     // Highest harmonic measured
+
+        double fundamental() const { return amplitude[1]; }
+
+        // Harmonic n relative to the fundamental, %
+        double percent(int harmonic) const { return (amplitude[harmonic] / amplitude[1]) * 100.0; }
+
+        // sqrt(H2² + ... + Hn²) / H1, %
+        double thdPercent() const
+        {
+            double sumSquares = 0.0;
+            for (int h = 2; h <= numHarmonics; ++h)
+                sumSquares += amplitude[h] * amplitude[h];
+            return (std::sqrt(sumSquares) / amplitude[1]) * 100.0;
+        }
+    };
+
+    HarmonicAnalyzer(double sampleRate, int analysisLength)
+        : fs(sampleRate), window(static_cast<size_t>(analysisLength))
+    {
+        const int N = analysisLength;
+        for (int i = 0; i < N; ++i)
+            window[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / N));
+    }
+
+    int getLength() const { return static_cast<int>(window.size()); }
+    double getSampleRate() const { return fs; }
+
+    /**
+     * Fundamental and harmonics 2..numHarmonics of a tone at fundamentalFreq
+     * Reads getLength() samples from signal
+     */
+    Harmonics analyze(const double* signal, double fundamentalFreq, int numHarmonics = 5) const
+    {
+        numHarmonics = std::clamp(numHarmonics, 1, MAX_HARMONIC);
+        const int N = getLength();
+
+        double cosw[MAX_HARMONIC], sinw[MAX_HARMONIC], coeff[MAX_HARMONIC];
+        double s1[MAX_HARMONIC] = {}, s2[MAX_HARMONIC] = {};
+        for (int h = 0; h < numHarmonics; ++h) {
+            double k = fundamentalFreq * (h + 1) * N / fs;
+            double w = 2.0 * M_PI * k / N;
+            cosw[h] = std::cos(w);
+            sinw[h] = std::sin(w);
+            coeff[h] = 2.0 * cosw[h];
+        }
+
+        for (int i = 0; i < N; ++i) {
+            const double x = signal[i] * window[i];
+            for (int h = 0; h < numHarmonics; ++h) {
+                double s0 = x + coeff[h] * s1[h] - s2[h];
+                s2[h] = s1[h];
+                s1[h] = s0;
+            }
+        }
+
+        Harmonics result;
+        result.numHarmonics = numHarmonics;
+        for (int h = 0; h < numHarmonics; ++h)
+            result.amplitude[h + 1] = magnitude(s1[h], s2[h], cosw[h], sinw[h], N);
+
+        return result;
+    }
+
+    Harmonics analyze(const std::vector<double>& signal, double fundamentalFreq, int numHarmonics = 5) const
+    {
+        return analyze(signal.data(), fundamentalFreq, numHarmonics);
+    }
+
+    /**
+     * Peak amplitude of a single frequency (reads getLength() samples)
+     */
+    double measureAmplitude(const double* signal, double freq) const
+    {
+        const int N = getLength();
+        double k = freq * N / fs;
+        double w = 2.0 * M_PI * k / N;
+        double cosw = std::cos(w);
+        double sinw = std::sin(w);
+        double coeff = 2.0 * cosw;
+
+        double s1 = 0.0, s2 = 0.0;
+        for (int i = 0; i < N; ++i) {
+            double s0 = signal[i] * window[i] + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+
+        return magnitude(s1, s2, cosw, sinw, N);
+    }
+
+private:
+    double fs;
+    std::vector<double> window;  // Hann, getLength() points
+
+    static double magnitude(double s1, double s2, double cosw, double sinw, int N)
+    {
+        double real = s1 - s2 * cosw;
+        double imag = s2 * sinw;
+
+        // Normalize for Hann window (coherent gain 0.5) and DFT scaling
+        return (2.0 * std::sqrt(real * real + imag * imag)) / (N * 0.5);
+    }
+};
+
+/**
+ * Stepped tone stimulus - one sine through a staircase of levels
+ *
+ * Pre-roll at the first level (filters, DC blockers and the processor fade-in
+ * settle), then for every level a settle segment followed by the capture segment
+ * that is analyzed. The phase runs continuously across the steps, so the only
+ * transient is the level change itself, which the settle segment absorbs.
+ * Levels are best given in ascending order: the hysteresis state then moves
+ * from a minor loop out to the next larger one, as it does after a reset.
+ */
+struct SteppedTone
+{
+    struct Step
+    {
+        double levelVU;     // 0VU = amplitude 1.0
+        int captureStart;   // Offset of the capture segment in input
+    };
+
+    std::vector<double> input;
+    std::vector<Step> steps;
+    int captureLength = 0;
+
+    SteppedTone(double sampleRate, double frequency, const double* levelsVU, int numLevels,
+                int preRoll, int settle, int capture)
+        : captureLength(capture)
+    {
+        input.reserve(static_cast<size_t>(preRoll + numLevels * (settle + capture)));
+
+        double phase = 0.0;
+        const double phaseInc = 2.0 * M_PI * frequency / sampleRate;
+        auto addSegment = [&](double amplitude, int length) {
+            for (int i = 0; i < length; ++i) {
+                input.push_back(amplitude * std::sin(phase));
+                phase += phaseInc;
+            }
+        };
+
+        for (int l = 0; l < numLevels; ++l) {
+            double amplitude = std::pow(10.0, levelsVU[l] / 20.0);
+            addSegment(amplitude, l == 0 ? preRoll : settle);
+            steps.push_back({ levelsVU[l], static_cast<int>(input.size()) });
+            addSegment(amplitude, capture);
+        }
+    }
+};
+
+} // namespace TapeMachine
@@ -4,61 +4,85 @@
 namespace TapeMachine
 {
 
-HybridTapeProcessor::HybridTapeProcessor()
+template <typename SampleType>
+HybridTapeProcessorT<SampleType>::HybridTapeProcessorT()
 {
+    // The configurations do not depend on the sample rate: one set for the whole process
+    configurations = SharedTableCache<int, TapeConfigurations>::acquire(0, [this](TapeConfigurations& set) {
+        buildConfigurations(set);
+    });
+    updateConfigurationsForSampleRate();
     updateCachedValues();
     reset();
 }
 
-void HybridTapeProcessor::setSampleRate(double sampleRate)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setSampleRate(double sampleRate)
 {
     fs = sampleRate;
     hfCut.setSampleRate(sampleRate);
-    jaCore.setSampleRate(sampleRate);
     machineEQ.setSampleRate(sampleRate);
 
+    // Allpass coefficients, azimuth delay and DC blocker for all four configurations
+    updateConfigurationsForSampleRate();
+    applySampleRate();
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setSampleRate(const RateTables& tables)
+{
+    fs = tables.sampleRate;
+    hfCut.setSampleRate(fs, tables.hfCut);
+    machineEQ.setSampleRate(fs, tables.machineEQ);
+    rateCoefficients = tables.rateCoefficients;
+    applySampleRate();
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::applySampleRate()
+{
+    jaCore.setSampleRate(fs);
+
     // Envelope follower coefficients for level-dependent J-A blend
     // Fast attack (~1ms) to catch transients, slow release (~50ms) for smooth decay
-    envAttack = std::exp(-1.0 / (0.001 * sampleRate));
-    envRelease = std::exp(-1.0 / (0.050 * sampleRate));
-
-    // Fade-in increment: reach 1.0 in FADE_IN_TIME_MS milliseconds
-    fadeInIncrement = 1.0 / (FADE_IN_TIME_MS * 0.001 * sampleRate);
+    envAttack = std::exp(-1.0 / (0.001 * fs));
+    envRelease = std::exp(-1.0 / (0.050 * fs));
 
-    // Configure dispersive allpass cascade for HF phase smear
-    for (int i = 0; i < NUM_DISPERSIVE_STAGES; ++i) {
-        double freq = dispersiveCornerFreq * std::pow(2.0, i * 0.5);
-        dispersiveAllpass[i].setFrequency(freq, sampleRate);
-    }
+    updateControlRateCoefficients();
 
-    // Design 4th-order Butterworth high-pass at 5 Hz for DC blocking
-    double fc = 5.0;
-    double w0 = 2.0 * M_PI * fc / sampleRate;
-    double cosw0 = std::cos(w0);
-    double sinw0 = std::sin(w0);
-    double alpha = sinw0 / (2.0 * 0.7071);
+    // Fade-in increment: reach 1.0 in FADE_IN_TIME_MS milliseconds
+    fadeInIncrement = 1.0 / (FADE_IN_TIME_MS * 0.001 * fs);
 
-    double b0 = (1.0 + cosw0) / 2.0;
-    double b1 = -(1.0 + cosw0);
-    double b2 = (1.0 + cosw0) / 2.0;
-    double a0 = 1.0 + alpha;
-    double a1 = -2.0 * cosw0;
-    double a2 = 1.0 - alpha;
+    updateCachedValues();
 
-    dcBlocker1.b0 = b0 / a0;
-    dcBlocker1.b1 = b1 / a0;
-    dcBlocker1.b2 = b2 / a0;
-    dcBlocker1.a1 = a1 / a0;
-    dcBlocker1.a2 = a2 / a0;
+    // 4th-order Butterworth high-pass at 5 Hz for DC blocking: two identical sections
+    for (Biquad* dcBlocker : { &dcBlocker1, &dcBlocker2 }) {
+        dcBlocker->b0 = rateCoefficients->dcBlocker.b0;
+        dcBlocker->b1 = rateCoefficients->dcBlocker.b1;
+        dcBlocker->b2 = rateCoefficients->dcBlocker.b2;
+        dcBlocker->a1 = rateCoefficients->dcBlocker.a1;
+        dcBlocker->a2 = rateCoefficients->dcBlocker.a2;
+    }
+}
 
-    dcBlocker2.b0 = dcBlocker1.b0;
-    dcBlocker2.b1 = dcBlocker1.b1;
-    dcBlocker2.b2 = dcBlocker1.b2;
-    dcBlocker2.a1 = dcBlocker1.a1;
-    dcBlocker2.a2 = dcBlocker1.a2;
+template <typename SampleType>
+std::shared_ptr<const typename HybridTapeProcessorT<SampleType>::RateTables>
+HybridTapeProcessorT<SampleType>::prepareRate(double sampleRate)
+{
+    // A processor at this rate acquires (or builds) every set; keep its handles
+    auto processor = std::make_unique<HybridTapeProcessorT>();
+    processor->setSampleRate(sampleRate);
+
+    auto tables = std::make_shared<RateTables>();
+    tables->sampleRate = sampleRate;
+    tables->rateCoefficients = processor->rateCoefficients;
+    tables->hfCut = HFCutT<SampleType>::retainCoefficients(sampleRate);
+    tables->machineEQ = MachineEQT<SampleType>::retainCoefficients(sampleRate);
+    return tables;
 }
 
-void HybridTapeProcessor::reset()
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::reset()
 {
     dcBlocker1.reset();
     dcBlocker2.reset();
@@ -70,17 +94,99 @@ void HybridTapeProcessor::reset()
         dispersiveAllpass[i].reset();
     }
 
-    for (int i = 0; i < DELAY_BUFFER_SIZE; ++i) {
-        delayBuffer[i] = 0.0;
-    }
-    delayWriteIndex = 0;
-    allpassState = 0.0;
-    jaEnvelope = 0.0;
-    satEnvelope = 0.0;
+    azimuthDelay.reset();
+    jaEnvelope = 0;
+    satEnvelope = 0;
+    satPrevious = static_cast<SampleType>(inputBias);  // Biased cubic input at silence
+    controlCountdown = 0;
+    jaAbsSum = 0;
+    a3Current = lookupEffectiveA3(0.0);
     fadeInGain = 0.0;  // Reset fade-in on reset
 }
 
-void HybridTapeProcessor::setParameters(double biasStrength, double inputGain, int tapeFormula)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::copyStateFrom(const HybridTapeProcessorT& other)
+{
+    hfCut.copyStateFrom(other.hfCut);
+    jaCore.copyStateFrom(other.jaCore);
+    machineEQ.copyStateFrom(other.machineEQ);
+
+    for (int i = 0; i < NUM_DISPERSIVE_STAGES; ++i)
+        dispersiveAllpass[i].z1 = other.dispersiveAllpass[i].z1;
+
+    // DC blockers have the same coefficients in every configuration
+    dcBlocker1.z1 = other.dcBlocker1.z1;
+    dcBlocker1.z2 = other.dcBlocker1.z2;
+    dcBlocker2.z1 = other.dcBlocker2.z1;
+    dcBlocker2.z2 = other.dcBlocker2.z2;
+
+    azimuthDelay.copyStateFrom(other.azimuthDelay);
+
+    jaEnvelope = other.jaEnvelope;
+    satEnvelope = other.satEnvelope;
+    satPrevious = other.satPrevious;
+    controlCountdown = std::min(other.controlCountdown, controlRateInterval);
+    jaAbsSum = other.jaAbsSum;
+    a3Current = lookupEffectiveA3(satEnvelope);
+    fadeInGain = other.fadeInGain;
+}
+
+template <typename SampleType>
+DiagnosticCounters HybridTapeProcessorT<SampleType>::getDiagnostics() const
+{
+    DiagnosticCounters counters;
+    counters.jaSolves = jaCore.getTotalSolves();
+    counters.jaIterations = jaCore.getTotalIterations();
+    counters.jaNaNResets = jaCore.getNaNResetCount();
+    counters.jaSoftLimits = jaCore.getSoftLimitCount();
+    counters.jaOutLimits = jaOutLimitCount;
+    counters.jaOutNaNs = jaOutNaNCount;
+    return counters;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::resetDiagnostics()
+{
+    jaCore.resetIterationStats();
+    jaOutLimitCount = 0;
+    jaOutNaNCount = 0;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setControlRateInterval(int interval)
+{
+    controlRateInterval = std::clamp(interval, 1, MAX_SUB_BLOCK_SIZE);
+    updateControlRateCoefficients();
+
+    // Start a fresh control period from the current envelopes
+    controlCountdown = 0;
+    jaAbsSum = 0;
+    a3Current = lookupEffectiveA3(satEnvelope);
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setDispersiveStages(int numStages)
+{
+    numStages = std::clamp(numStages, 0, NUM_DISPERSIVE_STAGES);
+
+    // Stages coming back on start from rest, not from the state they stopped with
+    for (int i = activeDispersiveStages; i < numStages; ++i)
+        dispersiveAllpass[i].reset();
+
+    activeDispersiveStages = numStages;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::updateControlRateCoefficients()
+{
+    // One tick applies the per-sample one-pole N times: coefficient^N
+    const double n = static_cast<double>(controlRateInterval);
+    envAttackN = std::pow(envAttack, n);
+    envReleaseN = std::pow(envRelease, n);
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setParameters(double biasStrength, double inputGain, int tapeFormula)
 {
     double clampedBias = std::clamp(biasStrength, 0.0, 1.0);
     bool newIsAmpexMode = (clampedBias < 0.74);
@@ -95,41 +201,47 @@ void HybridTapeProcessor::setParameters(double biasStrength, double inputGain, i
     }
 }
 
-void HybridTapeProcessor::setTestParameters(double testSatA3, double testSatPower,
-                                             double testLowLevelScale, double testJaBlend)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setTestParameters(double testSatA3, double testSatPower,
+                                                          double testLowLevelScale, double testJaBlend)
 {
     satA3 = testSatA3;
     satPower = testSatPower;
     lowLevelScale = testLowLevelScale;
     jaBlend = testJaBlend;
+    rebuildA3Table();
 }
 
-void HybridTapeProcessor::setTestLowThreshold(double threshold)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setTestLowThreshold(double threshold)
 {
     lowThreshold = threshold;
+    rebuildA3Table();
 }
 
-void HybridTapeProcessor::setTestCurvePower(double power)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setTestCurvePower(double power)
 {
     curvePower = power;
+    rebuildA3Table();
 }
 
-void HybridTapeProcessor::setTestHighKnee(double threshold, double amount)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::setTestHighKnee(double threshold, double amount)
 {
     highKneeThreshold = threshold;
     highKneeAmount = amount;
+    rebuildA3Table();
 }
 
-void HybridTapeProcessor::updateCachedValues()
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::initConfiguration(TapeConfiguration& config, bool isAmpex, bool isSM900)
 {
-    isAmpexMode = (currentBiasStrength < 0.74);
-    bool isSM900 = (currentTapeFormula == TapeFormula::SM900);
-
     // === Realistic J-A Parameters (DAFx 2019 paper) ===
     // Calibrated for actual tape behavior, adjusted for tape formula
     // SM900: Lower retentivity (1540 Gs vs 1600 Gs for GP9) = lower M_s
     // Both have same coercivity (370 Oe) so k remains the same
-    JilesAthertonCore::Parameters jaParams;
+    JilesAthertonBase::Parameters& jaParams = config.jaParams;
     jaParams.a = 22000.0;      // Domain wall density
     jaParams.k = 27500.0;      // Coercivity (370 Oe - same for GP9 and SM900)
     jaParams.c = 0.98;         // High reversibility for calibrated 30 IPS
@@ -139,107 +251,195 @@ void HybridTapeProcessor::updateCachedValues()
         // SM900: Lower retentivity = lower saturation magnetization
         // Ratio: 1540/1600 = 0.9625
         jaParams.M_s = 337000.0;  // ~96.25% of GP9's 350000
-        jaOutputScale = 152.0;    // Adjusted for lower M_s to maintain unity gain
+        config.jaOutputScale = 152.0;  // Adjusted for lower M_s to maintain unity gain
     } else {
         // GP9: Standard parameters
         jaParams.M_s = 350000.0;  // Saturation magnetization
-        jaOutputScale = 146.0;    // Calculated for unity gain at 0VU (0.316 input)
+        config.jaOutputScale = 146.0;  // Calculated for unity gain at 0VU (0.316 input)
     }
-    jaCore.setParameters(jaParams);
 
     // === Saturation Parameters - 4 Configurations ===
     // Machine mode determines E/O ratio and character
     // Tape formula determines saturation onset and curve shape
 
-    if (isAmpexMode) {
+    if (isAmpex) {
         if (isSM900) {
             // AMPEX ATR-102 + SM900
             // Target: THD 0.15% at 0VU, MOL +13 dB
             // Custom mastering head scaled (0.032% @ 355nW reference)
-            satA3 = 0.0052;   // Optimized for 0.15% THD at 0VU
-            satPower = 0.18;  // Tuned for curve shape (RMS 0.25 dB)
-            inputBias = 0.075; // DC bias for E/O ~0.50
-            lowLevelScale = 0.65;
-            dispersiveCornerFreq = 10000.0;
-            jaBlend = 0.002;  // 0.2% J-A - minimal for high bias linearization (432kHz)
-            lowThreshold = 0.5;   // Optimal for high-bias Ampex
-            curvePower = 2.0;     // t² curve shape
+            config.satA3 = 0.0052;   // Optimized for 0.15% THD at 0VU
+            config.satPower = 0.18;  // Tuned for curve shape (RMS 0.25 dB)
+            config.inputBias = 0.075; // DC bias for E/O ~0.50
+            config.lowLevelScale = 0.65;
+            config.dispersiveCornerFreq = 10000.0;
+            config.jaBlend = 0.002;  // 0.2% J-A - minimal for high bias linearization (432kHz)
+            config.lowThreshold = 0.5;   // Optimal for high-bias Ampex
+            config.curvePower = 2.0;     // t² curve shape
         } else {
             // AMPEX ATR-102 + GP9
             // Target: THD 0.09% at 0VU, MOL +15 dB
             // Custom mastering head scaled (0.032% @ 355nW reference)
-            satA3 = 0.0032;   // Optimized for 0.09% THD at 0VU
-            satPower = 0.16;  // Tuned for curve shape (RMS 0.25 dB)
-            inputBias = 0.075; // DC bias for E/O ~0.50
-            lowLevelScale = 0.61;
-            dispersiveCornerFreq = 10000.0;
-            jaBlend = 0.002;  // 0.2% J-A - minimal for high bias linearization (432kHz)
-            lowThreshold = 0.5;   // Optimal for high-bias Ampex
-            curvePower = 2.0;
+            config.satA3 = 0.0032;   // Optimized for 0.09% THD at 0VU
+            config.satPower = 0.16;  // Tuned for curve shape (RMS 0.25 dB)
+            config.inputBias = 0.075; // DC bias for E/O ~0.50
+            config.lowLevelScale = 0.61;
+            config.dispersiveCornerFreq = 10000.0;
+            config.jaBlend = 0.002;  // 0.2% J-A - minimal for high bias linearization (432kHz)
+            config.lowThreshold = 0.5;   // Optimal for high-bias Ampex
+            config.curvePower = 2.0;
         }
     } else {
         if (isSM900) {
             // STUDER A820 + SM900
             // Target: THD 0.30% at 0VU, MOL +10 dB
-            satA3 = 0.0078;   // Optimized for 0.30% THD at 0VU
-            satPower = 0.41;  // Tuned for curve shape (RMS 0.30 dB)
-            inputBias = 0.18; // DC bias for E/O ~1.12
-            lowLevelScale = 0.52;
-            dispersiveCornerFreq = 2800.0;
-            jaBlend = 0.008;  // 0.8% J-A for tape character (153.6kHz bias)
-            lowThreshold = 0.55;  // Higher threshold for Studer (fixes -6VU bump)
-            curvePower = 2.0;
+            config.satA3 = 0.0078;   // Optimized for 0.30% THD at 0VU
+            config.satPower = 0.41;  // Tuned for curve shape (RMS 0.30 dB)
+            config.inputBias = 0.18; // DC bias for E/O ~1.12
+            config.lowLevelScale = 0.52;
+            config.dispersiveCornerFreq = 2800.0;
+            config.jaBlend = 0.008;  // 0.8% J-A for tape character (153.6kHz bias)
+            config.lowThreshold = 0.55;  // Higher threshold for Studer (fixes -6VU bump)
+            config.curvePower = 2.0;
         } else {
             // STUDER A820 + GP9
             // Target: THD 0.18% at 0VU, MOL +12 dB
-            satA3 = 0.0046;   // Optimized for 0.18% @ 0VU
-            satPower = 0.43;  // Tuned for curve shape (RMS 0.31 dB)
-            inputBias = 0.18; // DC bias for E/O ~1.12
-            lowLevelScale = 0.56;
-            dispersiveCornerFreq = 2800.0;
-            jaBlend = 0.008;  // 0.8% J-A for tape character (153.6kHz bias)
-            lowThreshold = 0.55;  // Higher threshold for Studer (fixes -6VU bump)
-            curvePower = 2.0;
+            config.satA3 = 0.0046;   // Optimized for 0.18% @ 0VU
+            config.satPower = 0.43;  // Tuned for curve shape (RMS 0.31 dB)
+            config.inputBias = 0.18; // DC bias for E/O ~1.12
+            config.lowLevelScale = 0.56;
+            config.dispersiveCornerFreq = 2800.0;
+            config.jaBlend = 0.008;  // 0.8% J-A for tape character (153.6kHz bias)
+            config.lowThreshold = 0.55;  // Higher threshold for Studer (fixes -6VU bump)
+            config.curvePower = 2.0;
         }
     }
 
     // Azimuth delay: Ampex 8μs, Studer 12μs (machine-dependent, not tape-dependent)
-    double delayMicroseconds = isAmpexMode ? 8.0 : 12.0;
-    cachedDelaySamples = delayMicroseconds * 1e-6 * fs;
+    config.delayMicroseconds = isAmpex ? 8.0 : 12.0;
+}
 
-    // Reconfigure allpass filters
-    for (int i = 0; i < NUM_DISPERSIVE_STAGES; ++i) {
-        double freq = dispersiveCornerFreq * std::pow(2.0, i * 0.5);
-        dispersiveAllpass[i].setFrequency(freq, fs);
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::buildConfigurations(TapeConfigurations& set)
+{
+    for (int index = 0; index < NUM_CONFIGURATIONS; ++index) {
+        TapeConfiguration& config = set.config[index];
+        initConfiguration(config, index >= 2, (index & 1) != 0);
+
+        // The a3 curve reads the member parameters: load them, then tabulate
+        // (updateCachedValues() loads the active configuration afterwards)
+        satA3 = config.satA3;
+        satPower = config.satPower;
+        lowLevelScale = config.lowLevelScale;
+        lowThreshold = config.lowThreshold;
+        curvePower = config.curvePower;
+        fillA3Table(config.a3Table);
+    }
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::designRateCoefficients(RateCoefficients& rate, const TapeConfigurations& set,
+                                                              double sampleRate)
+{
+    for (int index = 0; index < NUM_CONFIGURATIONS; ++index) {
+        const TapeConfiguration& config = set.config[index];
+
+        // Dispersive allpass cascade for HF phase smear
+        for (int i = 0; i < NUM_DISPERSIVE_STAGES; ++i) {
+            rate.allpassCoefficients[index][i] =
+                AllpassFilter::designCoefficient(config.dispersiveCornerFreq * std::pow(2.0, i * 0.5), sampleRate);
+        }
+
+        rate.delaySamples[index] = config.delayMicroseconds * 1e-6 * sampleRate;
     }
 
+    // Design 4th-order Butterworth high-pass at 5 Hz for DC blocking
+    double fc = 5.0;
+    double w0 = 2.0 * M_PI * fc / sampleRate;
+    double cosw0 = std::cos(w0);
+    double sinw0 = std::sin(w0);
+    double alpha = sinw0 / (2.0 * 0.7071);
+
+    double b0 = (1.0 + cosw0) / 2.0;
+    double b1 = -(1.0 + cosw0);
+    double b2 = (1.0 + cosw0) / 2.0;
+    double a0 = 1.0 + alpha;
+    double a1 = -2.0 * cosw0;
+    double a2 = 1.0 - alpha;
+
+    rate.dcBlocker.b0 = b0 / a0;
+    rate.dcBlocker.b1 = b1 / a0;
+    rate.dcBlocker.b2 = b2 / a0;
+    rate.dcBlocker.a1 = a1 / a0;
+    rate.dcBlocker.a2 = a2 / a0;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::updateConfigurationsForSampleRate()
+{
+    const TapeConfigurations& set = *configurations;
+    const double sampleRate = fs;
+    rateCoefficients = SharedTableCache<double, RateCoefficients>::acquire(sampleRate, [&set, sampleRate](RateCoefficients& rate) {
+        designRateCoefficients(rate, set, sampleRate);
+    });
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::applyConfiguration(int index)
+{
+    const TapeConfiguration& config = configurations->config[index];
+
+    jaCore.setParameters(config.jaParams);
+    jaOutputScale = config.jaOutputScale;
+
+    satA3 = config.satA3;
+    satPower = config.satPower;
+    inputBias = config.inputBias;
+    lowLevelScale = config.lowLevelScale;
+    dispersiveCornerFreq = config.dispersiveCornerFreq;
+    jaBlend = config.jaBlend;
+    lowThreshold = config.lowThreshold;
+    curvePower = config.curvePower;
+
+    // Thiran coefficient worked out here, not per sample
+    azimuthDelay.setDelay(rateCoefficients->delaySamples[index]);
+
+    // Coefficients only - filter state carries over
+    for (int i = 0; i < NUM_DISPERSIVE_STAGES; ++i)
+        dispersiveAllpass[i].coefficient = static_cast<SampleType>(rateCoefficients->allpassCoefficients[index][i]);
+
+    // Cached tables assume the high knee is off (it is a test-only control)
+    if (highKneeAmount > 0.0)
+        rebuildA3Table();
+    else
+        a3Table = config.a3Table;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::updateCachedValues()
+{
+    isAmpexMode = (currentBiasStrength < 0.74);
+    bool isSM900 = (currentTapeFormula == TapeFormula::SM900);
+
+    // === Saturation Parameters - 4 Configurations (see initConfiguration) ===
+    applyConfiguration((isAmpexMode ? 2 : 0) + (isSM900 ? 1 : 0));
+
     // Update machine EQ (machine-dependent, not tape-dependent)
-    machineEQ.setMachine(isAmpexMode ? MachineEQ::Machine::Ampex : MachineEQ::Machine::Studer);
+    // Both machines' coefficients are designed in setSampleRate - this only selects
+    using Machine = typename MachineEQT<SampleType>::Machine;
+    machineEQ.setMachine(isAmpexMode ? Machine::Ampex : Machine::Studer);
 
     // Update AC bias shielding curve (machine-dependent only)
     // Research confirms GP9 and SM900 have compatible frequency response when properly biased
     hfCut.setMachineMode(isAmpexMode);
+
+    a3Current = lookupEffectiveA3(satEnvelope);
 }
 
-double HybridTapeProcessor::saturate(double x)
+template <typename SampleType>
+double HybridTapeProcessorT<SampleType>::computeEffectiveA3(double clampedEnv) const
 {
-    // Level-scaled cubic saturation with DC bias for even harmonics
-    // effectiveA3 = satA3 * level^satPower
-    // This gives THD slope of (2 + satPower) on log-log scale
-    // Steeper than pure cubic, matching real tape behavior
-
-    // Update saturation envelope (tracks signal level for a3 scaling)
-    double absLevel = std::abs(x);
-    double satEnvCoeff = (absLevel > satEnvelope) ? 0.9 : 0.999;
-    satEnvelope = satEnvCoeff * satEnvelope + (1.0 - satEnvCoeff) * absLevel;
-
-    // Add bias for even harmonic generation (E/O ratio control)
-    double biased = x + inputBias;
-
     // Scale a3 coefficient based on envelope level
     // effectiveA3 = satA3 * (envelope)^power
-    // Using std::pow which compilers optimize well for fractional exponents
-    double clampedEnv = std::max(0.01, satEnvelope);
     double effectiveA3 = satA3 * std::pow(clampedEnv, satPower);
 
     // Extra reduction at low levels to match tape's low-level linearity
@@ -256,78 +456,301 @@ double HybridTapeProcessor::saturate(double x)
         effectiveA3 *= 1.0 / (1.0 + highKneeAmount * excess);
     }
 
-    // Cubic saturation: y = x - a3*x³
-    double biasedSq = biased * biased;
-    double saturated = biased - effectiveA3 * biasedSq * biased;
+    return effectiveA3;
+}
 
-    return saturated;
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::fillA3Table(double* table) const
+{
+    // Entries below the 0.01 envelope floor hold the floor value, so the
+    // interval straddling 0.01 interpolates correctly
+    for (int i = 0; i <= A3_TABLE_SIZE; ++i) {
+        double env = static_cast<double>(i) / A3_TABLE_SCALE;
+        table[i] = computeEffectiveA3(std::max(0.01, env));
+    }
 }
 
-double HybridTapeProcessor::processSample(double input)
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::rebuildA3Table()
 {
-    double gained = input * currentInputGain;
+    // Test overrides get their own table so the cached configurations stay intact
+    fillA3Table(customA3Table);
+    a3Table = customA3Table;
+}
 
-    // === PARALLEL PATH PROCESSING (AC Bias Shielding) ===
-    // LF goes to saturation via HFCut
-    // HF bypasses saturation: cleanHF = input - HFCut(input)
-    // This is a complementary filter - cleanHF extracts what HFCut removed
-    double hfCutSignal = hfCut.processSample(gained);
-    double cleanHF = gained - hfCutSignal;
+template <typename SampleType>
+double HybridTapeProcessorT<SampleType>::lookupEffectiveA3(double envelope) const
+{
+    // Table lookup replaces the two std::pow calls per sample
+    double clampedEnv = std::max(0.01, envelope);
+    if (clampedEnv < A3_TABLE_MAX_ENV) {
+        double pos = clampedEnv * A3_TABLE_SCALE;
+        int index = static_cast<int>(pos);
+        double frac = pos - index;
+        return a3Table[index] + frac * (a3Table[index + 1] - a3Table[index]);
+    }
+    return computeEffectiveA3(clampedEnv);
+}
 
-    // === LEVEL-DEPENDENT J-A BLENDING ===
-    // Simulates AC bias linearization: J-A is nearly linear at normal levels
-    // and progressively engages nonlinearity at high levels
-    double absLevel = std::abs(hfCutSignal);
+template <typename SampleType>
+SampleType HybridTapeProcessorT<SampleType>::saturate(SampleType x, SampleType& envelope, SampleType& previous) const
+{
+    using S = SampleType;
 
-    // Envelope follower for smooth blend transitions
-    double envCoeff = (absLevel > jaEnvelope) ? envAttack : envRelease;
-    jaEnvelope = envCoeff * jaEnvelope + (1.0 - envCoeff) * absLevel;
+    // Level-scaled cubic saturation with DC bias for even harmonics
+    // effectiveA3 = satA3 * level^satPower
+    // This gives THD slope of (2 + satPower) on log-log scale
+    // Steeper than pure cubic, matching real tape behavior
+
+    // Update saturation envelope (tracks signal level for a3 scaling)
+    S absLevel = std::abs(x);
+    S satEnvCoeff = (absLevel > envelope) ? S(0.9) : S(0.999);
+    envelope = satEnvCoeff * envelope + (S(1.0) - satEnvCoeff) * absLevel;
+
+    // Add bias for even harmonic generation (E/O ratio control)
+    const S bias = S(inputBias);
+    S biased = x + bias;
+
+    // Scale a3 coefficient based on envelope level (see computeEffectiveA3)
+    S effectiveA3 = S(lookupEffectiveA3(envelope));
+
+    // Cubic saturation: y = x - a3*x³
+    S biasedSq = biased * biased;
+    S saturated;
+    if (saturationADAA) {
+        // x³ averaged between the previous and the current sample (see setSaturationADAA)
+        S cubed = (biased + previous) * (biasedSq + previous * previous) * S(0.25);
+        previous = biased;
+        saturated = biased - effectiveA3 * cubed;
+    } else {
+        saturated = biased - effectiveA3 * biasedSq * biased;
+    }
+
+    // Remove the static bias again - only its harmonic products remain
+    return saturated - bias;
+}
+
+template <typename SampleType>
+template <bool LinearRegion>
+SampleType HybridTapeProcessorT<SampleType>::processJA(SampleType hfCutSignal)
+{
+    using S = SampleType;
 
     // === J-A HYSTERESIS (magnetic feel) ===
     // Machine-specific blend based on AC bias frequency:
     // Higher bias = more linearization = less hysteresis character
     // Ampex (432kHz): 6%, Studer (153.6kHz): 12%
-    double jaOut = jaCore.process(hfCutSignal) * jaOutputScale;
+    // Quiet passages: J-A is linear there (and only jaBlend of it is heard),
+    // so skip the Newton solve and follow the small-signal model instead
+    const S outputScale = S(jaOutputScale);
+    S jaOut;
+    if constexpr (LinearRegion)
+        jaOut = jaCore.processLinear(hfCutSignal) * outputScale;
+    else
+        jaOut = jaCore.process(hfCutSignal) * outputScale;
 
     // STABILITY FIX: Soft limit J-A output to prevent pops from numerical artifacts
     // The 146x scaling can amplify small glitches to audible levels
     // Limit to ±2.0 (well beyond normal signal range) with soft knee
-    if (std::abs(jaOut) > 1.5) {
-        double sign = (jaOut >= 0.0) ? 1.0 : -1.0;
-        double excess = std::abs(jaOut) - 1.5;
-        jaOut = sign * (1.5 + 0.5 * std::tanh(excess * 2.0));
+    if (std::abs(jaOut) > S(1.5)) {
+#if TAPE_MACHINE_DIAGNOSTICS
+        ++jaOutLimitCount;
+#endif
+        S sign = (jaOut >= S(0.0)) ? S(1.0) : S(-1.0);
+        S excess = std::abs(jaOut) - S(1.5);
+        jaOut = sign * (S(1.5) + S(0.5) * fastTanh(excess * S(2.0)));
     }
 
     // NaN/Inf protection - pass through dry signal if J-A produces garbage
     if (!std::isfinite(jaOut)) {
+#if TAPE_MACHINE_DIAGNOSTICS
+        ++jaOutNaNCount;
+#endif
         jaOut = hfCutSignal;
     }
 
-    double blended = hfCutSignal * (1.0 - jaBlend) + jaOut * jaBlend;
+    return jaOut;
+}
+
+template <typename SampleType>
+SampleType HybridTapeProcessorT<SampleType>::processNonlinear(SampleType hfCutSignal, SampleType& jaEnv, SampleType& satEnv)
+{
+    using S = SampleType;
+
+    // === LEVEL-DEPENDENT J-A BLENDING ===
+    // Simulates AC bias linearization: J-A is nearly linear at normal levels
+    // and progressively engages nonlinearity at high levels
+    S absLevel = std::abs(hfCutSignal);
+
+    // Envelope follower for smooth blend transitions
+    S envCoeff = S((absLevel > jaEnv) ? envAttack : envRelease);
+    jaEnv = envCoeff * jaEnv + (S(1.0) - envCoeff) * absLevel;
+
+    const S gate = S(jaGateThreshold);
+    S jaOut = (jaEnv < gate && absLevel < gate) ? processJA<true>(hfCutSignal)
+                                                : processJA<false>(hfCutSignal);
+
+    const S blend = S(jaBlend);
+    S blended = hfCutSignal * (S(1.0) - blend) + jaOut * blend;
 
     // === LEVEL-SCALED CUBIC SATURATION ===
     // Adds bias internally for even harmonics (E/O ratio control)
     // effectiveA3 = a3 * level^power for steeper THD curve
-    double saturated = saturate(blended);
+    return saturate(blended, satEnv, satPrevious);
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::controlTick()
+{
+    // J-A envelope advances once per tick from the mean level of the last period
+    using S = SampleType;
+    S jaLevel = jaAbsSum / static_cast<S>(controlRateInterval);
+    S jaCoeff = S((jaLevel > jaEnvelope) ? envAttackN : envReleaseN);
+    jaEnvelope = jaCoeff * jaEnvelope + (S(1.0) - jaCoeff) * jaLevel;
+
+    jaAbsSum = 0;
+    controlCountdown = controlRateInterval;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::processNonlinearBlock(SampleType* data, const SampleType* cleanHF, int stride, int numSamples)
+{
+    using S = SampleType;
+    const S hfBlend = S(cleanHfBlend);
+
+    if (controlRateInterval <= 1) {
+        S jaEnv = jaEnvelope;
+        S satEnv = satEnvelope;
+        for (int i = 0; i < numSamples; ++i) {
+            const int k = i * stride;
+            data[k] = processNonlinear(data[k], jaEnv, satEnv) + cleanHF[k] * hfBlend;
+        }
+        jaEnvelope = jaEnv;
+        satEnvelope = satEnv;
+        return;
+    }
+
+    const S gate = S(jaGateThreshold);
+
+    int i = 0;
+    while (i < numSamples) {
+        if (controlCountdown == 0)
+            controlTick();
+
+        const int segmentEnd = i + std::min(controlCountdown, numSamples - i);
+        const int segmentLength = segmentEnd - i;
+
+        // J-A gate decided once per segment: the HFCut signal for the whole
+        // segment is already known, so its peak guards against transients
+        S peak = 0;
+        for (int j = i; j < segmentEnd; ++j)
+            peak = std::max(peak, std::abs(data[j * stride]));
+        const bool linearRegion = jaEnvelope < gate && peak < gate;
+
+        // J-A blend (sample-serial); the saturation envelope only needs its end value
+        const S satEnv = linearRegion ? blendSegment<true>(data, stride, i, segmentEnd, satEnvelope)
+                                      : blendSegment<false>(data, stride, i, segmentEnd, satEnvelope);
+        satEnvelope = satEnv;
+
+        // effectiveA3 evaluated at the segment end, ramped from the previous end value
+        const S a3Start = S(a3Current);
+        const S a3End = S(lookupEffectiveA3(satEnv));
+        const S a3Step = (a3End - a3Start) / static_cast<S>(segmentLength);
+
+        if (saturationADAA)
+            saturateSegment<true>(data, cleanHF, stride, i, segmentEnd, a3Start, a3Step);
+        else
+            saturateSegment<false>(data, cleanHF, stride, i, segmentEnd, a3Start, a3Step);
+        a3Current = static_cast<double>(a3End);
+
+        controlCountdown -= segmentLength;
+        i = segmentEnd;
+    }
+}
+
+template <typename SampleType>
+template <bool LinearRegion>
+SampleType HybridTapeProcessorT<SampleType>::blendSegment(SampleType* data, int stride, int begin, int end, SampleType satEnv)
+{
+    using S = SampleType;
+    const S dryGain = S(1.0 - jaBlend);
+    const S wetGain = S(jaBlend);
+
+    for (int j = begin; j < end; ++j) {
+        const int k = j * stride;
+        const S x = data[k];
+        jaAbsSum += std::abs(x);
+
+        const S blended = x * dryGain + processJA<LinearRegion>(x) * wetGain;
+        const S absLevel = std::abs(blended);
+        const S satEnvCoeff = (absLevel > satEnv) ? S(0.9) : S(0.999);
+        satEnv = satEnvCoeff * satEnv + (S(1.0) - satEnvCoeff) * absLevel;
+        data[k] = blended;
+    }
+
+    return satEnv;
+}
+
+template <typename SampleType>
+template <bool ADAA>
+void HybridTapeProcessorT<SampleType>::saturateSegment(SampleType* data, const SampleType* cleanHF, int stride,
+                                                       int begin, int end, SampleType a3Start, SampleType a3Step)
+{
+    // Cubic saturation with the ramped coefficient (no branches; ADAA keeps one sample of state)
+    using S = SampleType;
+    const S hfBlend = S(cleanHfBlend);
+    const S bias = S(inputBias);
+
+    S previous = satPrevious;
+    for (int j = begin; j < end; ++j) {
+        const int k = j * stride;
+        const S a3 = a3Start + a3Step * static_cast<S>(j - begin + 1);
+        const S biased = data[k] + bias;
+        if constexpr (ADAA) {
+            const S cubed = (biased + previous) * (biased * biased + previous * previous) * S(0.25);
+            previous = biased;
+            data[k] = (biased - a3 * cubed - bias) + cleanHF[k] * hfBlend;
+        } else {
+            data[k] = (biased - a3 * biased * biased * biased - bias) + cleanHF[k] * hfBlend;
+        }
+    }
+
+    if constexpr (ADAA)
+        satPrevious = previous;
+}
+
+template <typename SampleType>
+SampleType HybridTapeProcessorT<SampleType>::processSample(SampleType input)
+{
+    using S = SampleType;
+    S gained = input * S(currentInputGain);
+
+    // === PARALLEL PATH PROCESSING (AC Bias Shielding) ===
+    // LF goes to saturation via HFCut
+    // HF bypasses saturation: cleanHF = input - HFCut(input)
+    // This is a complementary filter - cleanHF extracts what HFCut removed
+    S hfCutSignal = hfCut.processSample(gained);
+    S cleanHF = gained - hfCutSignal;
+
+    S saturated = processNonlinear(hfCutSignal, jaEnvelope, satEnvelope);
 
     // === COMBINE PATHS ===
-    double output = saturated + cleanHF * cleanHfBlend;
+    S output = saturated + cleanHF * S(cleanHfBlend);
 
     // Machine-specific EQ
     output = machineEQ.processSample(output);
 
     // HF dispersive allpass (tape head phase smear)
-    for (int i = 0; i < NUM_DISPERSIVE_STAGES; ++i) {
+    for (int i = 0; i < activeDispersiveStages; ++i) {
         output = dispersiveAllpass[i].process(output);
     }
 
     // DC blocking
-    output = dcBlocker1.process(output);
-    output = dcBlocker2.process(output);
+    output = static_cast<S>(dcBlocker2.process(dcBlocker1.process(output)));
 
     // Fade-in to prevent pop from DC blocker initialization
     if (fadeInGain < 1.0) {
-        output *= fadeInGain;
+        output *= static_cast<S>(fadeInGain);
         fadeInGain += fadeInIncrement;
         if (fadeInGain > 1.0) fadeInGain = 1.0;
     }
@@ -335,43 +758,245 @@ double HybridTapeProcessor::processSample(double input)
     return output;
 }
 
-double HybridTapeProcessor::processRightChannel(double input)
+template <typename SampleType>
+SampleType HybridTapeProcessorT<SampleType>::processRightChannel(SampleType input)
 {
-    double processed = processSample(input);
+    return applyAzimuthDelay(processSample(input));
+}
 
+template <typename SampleType>
+SampleType HybridTapeProcessorT<SampleType>::applyAzimuthDelay(SampleType processed)
+{
     // Azimuth delay using Thiran allpass interpolation
     // Allpass preserves flat magnitude response (no HF roll-off)
     // Only adds phase shift for the timing difference
+    return azimuthEnabled ? azimuthDelay.process(processed) : processed;
+}
+
+//==============================================================================
+// Block processing
+//==============================================================================
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::processSubBlock(SampleType* data, int numSamples)
+{
+    SampleType cleanHF[MAX_SUB_BLOCK_SIZE];
+
+    // === PARALLEL PATH PROCESSING (AC Bias Shielding) ===
+    const SampleType inputGain = static_cast<SampleType>(currentInputGain);
+    for (int i = 0; i < numSamples; ++i) {
+        data[i] *= inputGain;
+        cleanHF[i] = data[i];
+    }
+
+    hfCut.processBlock(data, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+        cleanHF[i] -= data[i];
+
+    // === J-A + SATURATION (sample-serial nonlinear stage) ===
+    processNonlinearBlock(data, cleanHF, 1, numSamples);
+
+    // === LINEAR POST-STAGES ===
+    machineEQ.processBlock(data, numSamples);
 
-    delayBuffer[delayWriteIndex] = processed;
+    for (int s = 0; s < activeDispersiveStages; ++s)
+        dispersiveAllpass[s].processBlock(data, numSamples);
 
-    // Integer and fractional parts of delay
-    int intDelay = static_cast<int>(cachedDelaySamples);
-    double frac = cachedDelaySamples - intDelay;
+    Biquad::processCascadeBlock(dcBlocker1, dcBlocker2, data, numSamples);
 
-    // For very small delays (< 0.1 samples), just return processed signal
-    if (cachedDelaySamples < 0.1) {
-        delayWriteIndex = (delayWriteIndex + 1) % DELAY_BUFFER_SIZE;
-        return processed;
+    // Fade-in (only while the startup ramp is running)
+    if (fadeInGain < 1.0) {
+        double gain = fadeInGain;
+        const double increment = fadeInIncrement;
+        for (int i = 0; i < numSamples && gain < 1.0; ++i) {
+            data[i] *= static_cast<SampleType>(gain);
+            gain += increment;
+            if (gain > 1.0) gain = 1.0;
+        }
+        fadeInGain = gain;
     }
+}
 
-    // Thiran allpass coefficient: a = (1-d)/(1+d) for fractional delay d
-    double allpassCoeff = (1.0 - frac) / (1.0 + frac);
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::applyAzimuthDelayBlock(SampleType* data, int numSamples)
+{
+    if (azimuthEnabled)
+        azimuthDelay.processBlock(data, numSamples);
+}
 
-    // Read positions for integer delay
-    int readIndex = (delayWriteIndex - intDelay - 1 + DELAY_BUFFER_SIZE) % DELAY_BUFFER_SIZE;
-    int readIndexNext = (readIndex + 1) % DELAY_BUFFER_SIZE;
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::processBlock(const float* input, float* output, int numSamples)
+{
+    SampleType buffer[MAX_SUB_BLOCK_SIZE];
 
-    // First-order Thiran allpass: y[n] = a*x[n] + x[n-1] - a*y[n-1]
-    double x_curr = delayBuffer[readIndexNext];
-    double x_prev = delayBuffer[readIndex];
+    for (int start = 0; start < numSamples; start += MAX_SUB_BLOCK_SIZE) {
+        const int n = std::min(MAX_SUB_BLOCK_SIZE, numSamples - start);
 
-    double delayed = allpassCoeff * x_curr + x_prev - allpassCoeff * allpassState;
-    allpassState = delayed;
+        for (int i = 0; i < n; ++i)
+            buffer[i] = static_cast<SampleType>(input[start + i]);
 
-    delayWriteIndex = (delayWriteIndex + 1) % DELAY_BUFFER_SIZE;
+        processSubBlock(buffer, n);
 
-    return delayed;
+        for (int i = 0; i < n; ++i)
+            output[start + i] = static_cast<float>(buffer[i]);
+    }
 }
 
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::processRightChannelBlock(const float* input, float* output, int numSamples)
+{
+    SampleType buffer[MAX_SUB_BLOCK_SIZE];
+
+    for (int start = 0; start < numSamples; start += MAX_SUB_BLOCK_SIZE) {
+        const int n = std::min(MAX_SUB_BLOCK_SIZE, numSamples - start);
+
+        for (int i = 0; i < n; ++i)
+            buffer[i] = static_cast<SampleType>(input[start + i]);
+
+        processSubBlock(buffer, n);
+        applyAzimuthDelayBlock(buffer, n);
+
+        for (int i = 0; i < n; ++i)
+            output[start + i] = static_cast<float>(buffer[i]);
+    }
+}
+
+template <typename SampleType>
+bool HybridTapeProcessorT<SampleType>::sharesLinearConfiguration(const HybridTapeProcessorT& other) const
+{
+    // HFCut, MachineEQ, dispersive allpass and DC blocker coefficients depend
+    // only on the machine and the sample rate (plus the dispersive stage count)
+    return fs == other.fs
+        && isAmpexMode == other.isAmpexMode
+        && cleanHfBlend == other.cleanHfBlend
+        && activeDispersiveStages == other.activeDispersiveStages;
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::processStereoSubBlock(HybridTapeProcessorT& left, HybridTapeProcessorT& right,
+                                                          SampleType* lr, int numSamples)
+{
+    using Lane = StereoLaneT<SampleType>;
+    alignas(16) SampleType cleanHF[2 * MAX_SUB_BLOCK_SIZE];
+    const int n = numSamples;
+
+    // === PARALLEL PATH PROCESSING (AC Bias Shielding) ===
+    const Lane inputGain = Lane::set(static_cast<SampleType>(left.currentInputGain),
+                                     static_cast<SampleType>(right.currentInputGain));
+    for (int i = 0; i < n; ++i) {
+        const Lane gained = Lane::load(lr + 2 * i) * inputGain;
+        gained.store(lr + 2 * i);
+        gained.store(cleanHF + 2 * i);
+    }
+
+    HFCutT<SampleType>::processStereoBlock(left.hfCut, right.hfCut, lr, n);
+
+    for (int i = 0; i < n; ++i)
+        (Lane::load(cleanHF + 2 * i) - Lane::load(lr + 2 * i)).store(cleanHF + 2 * i);
+
+    // === J-A + SATURATION (nonlinear, per channel) ===
+    left.processNonlinearBlock(lr, cleanHF, 2, n);
+    right.processNonlinearBlock(lr + 1, cleanHF + 1, 2, n);
+
+    // === LINEAR POST-STAGES (one vector recursion for both channels) ===
+    MachineEQT<SampleType>::processStereoBlock(left.machineEQ, right.machineEQ, lr, n);
+
+    for (int s = 0; s < left.activeDispersiveStages; ++s) {
+        const Lane coeff = Lane::broadcast(left.dispersiveAllpass[s].coefficient);
+        Lane z1 = Lane::set(left.dispersiveAllpass[s].z1, right.dispersiveAllpass[s].z1);
+        for (int i = 0; i < n; ++i) {
+            const Lane input = Lane::load(lr + 2 * i);
+            const Lane output = coeff * input + z1;
+            z1 = input - coeff * output;
+            output.store(lr + 2 * i);
+        }
+        left.dispersiveAllpass[s].z1 = z1.left();
+        right.dispersiveAllpass[s].z1 = z1.right();
+    }
+
+    // Both DC blockers in one pass, the value in between kept in double (as in processSample())
+    {
+        BiquadLanes<Biquad> dc1(left.dcBlocker1, right.dcBlocker1);
+        BiquadLanes<Biquad> dc2(left.dcBlocker2, right.dcBlocker2);
+        using DCLane = typename BiquadLanes<Biquad>::Lane;
+        for (int i = 0; i < n; ++i)
+            storeLane(dc2.process(dc1.process(loadLane<DCLane>(lr + 2 * i))), lr + 2 * i);
+        dc1.storeState(left.dcBlocker1, right.dcBlocker1);
+        dc2.storeState(left.dcBlocker2, right.dcBlocker2);
+    }
+
+    // Fade-in (per channel, only while the startup ramp is running)
+    for (int ch = 0; ch < 2; ++ch) {
+        HybridTapeProcessorT& proc = (ch == 0) ? left : right;
+        if (proc.fadeInGain < 1.0) {
+            double gain = proc.fadeInGain;
+            for (int i = 0; i < n && gain < 1.0; ++i) {
+                lr[2 * i + ch] *= static_cast<SampleType>(gain);
+                gain += proc.fadeInIncrement;
+                if (gain > 1.0) gain = 1.0;
+            }
+            proc.fadeInGain = gain;
+        }
+    }
+}
+
+template <typename SampleType>
+void HybridTapeProcessorT<SampleType>::processStereoBlock(HybridTapeProcessorT& left, HybridTapeProcessorT& right,
+                                                       const float* inputL, const float* inputR,
+                                                       float* outputL, float* outputR, int numSamples)
+{
+    SampleType bufferL[MAX_SUB_BLOCK_SIZE];
+    SampleType bufferR[MAX_SUB_BLOCK_SIZE];
+
+    if (!left.sharesLinearConfiguration(right)) {
+        // Both channels advance one sub-block at a time so L and R data stay hot together
+        for (int start = 0; start < numSamples; start += MAX_SUB_BLOCK_SIZE) {
+            const int n = std::min(MAX_SUB_BLOCK_SIZE, numSamples - start);
+
+            for (int i = 0; i < n; ++i) {
+                bufferL[i] = static_cast<SampleType>(inputL[start + i]);
+                bufferR[i] = static_cast<SampleType>(inputR[start + i]);
+            }
+
+            left.processSubBlock(bufferL, n);
+            right.processSubBlock(bufferR, n);
+            right.applyAzimuthDelayBlock(bufferR, n);
+
+            for (int i = 0; i < n; ++i) {
+                outputL[start + i] = static_cast<float>(bufferL[i]);
+                outputR[start + i] = static_cast<float>(bufferR[i]);
+            }
+        }
+        return;
+    }
+
+    alignas(16) SampleType interleaved[2 * MAX_SUB_BLOCK_SIZE];
+
+    for (int start = 0; start < numSamples; start += MAX_SUB_BLOCK_SIZE) {
+        const int n = std::min(MAX_SUB_BLOCK_SIZE, numSamples - start);
+
+        for (int i = 0; i < n; ++i) {
+            interleaved[2 * i] = static_cast<SampleType>(inputL[start + i]);
+            interleaved[2 * i + 1] = static_cast<SampleType>(inputR[start + i]);
+        }
+
+        processStereoSubBlock(left, right, interleaved, n);
+
+        for (int i = 0; i < n; ++i) {
+            outputL[start + i] = static_cast<float>(interleaved[2 * i]);
+            bufferR[i] = interleaved[2 * i + 1];
+        }
+
+        // Azimuth delay is right-channel only
+        right.applyAzimuthDelayBlock(bufferR, n);
+
+        for (int i = 0; i < n; ++i)
+            outputR[start + i] = static_cast<float>(bufferR[i]);
+    }
+}
+
+template class HybridTapeProcessorT<float>;
+template class HybridTapeProcessorT<double>;
+
 } // namespace TapeMachine
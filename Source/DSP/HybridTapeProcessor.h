@@ -2,12 +2,41 @@
 
 #include "MathConstants.h"
 #include "BiasShielding.h"
+#include "FractionalDelay.h"
 #include "JilesAthertonCore.h"
 #include "MachineEQ.h"
+#include "SharedTableCache.h"
+#include "StereoLane.h"
 
 namespace TapeMachine
 {
 
+/**
+ * Event counters of one processor (see HybridTapeProcessorT::getDiagnostics)
+ * Solves and iterations are always counted; the NaN and limiter events only
+ * in TAPE_MACHINE_DIAGNOSTICS builds
+ */
+struct DiagnosticCounters
+{
+    unsigned long long jaSolves = 0;        // Full Newton solves (the linear gate skips these)
+    unsigned long long jaIterations = 0;    // Newton iterations over those solves
+    unsigned long long jaNaNResets = 0;     // J-A state reset after a NaN/Inf magnetization
+    unsigned long long jaSoftLimits = 0;    // J-A magnetization soft-limited near M_s
+    unsigned long long jaOutLimits = 0;     // Scaled J-A output through the +-1.5 soft limiter
+    unsigned long long jaOutNaNs = 0;       // Non-finite J-A output replaced by the dry signal
+
+    DiagnosticCounters& operator+=(const DiagnosticCounters& other)
+    {
+        jaSolves += other.jaSolves;
+        jaIterations += other.jaIterations;
+        jaNaNResets += other.jaNaNResets;
+        jaSoftLimits += other.jaSoftLimits;
+        jaOutLimits += other.jaOutLimits;
+        jaOutNaNs += other.jaOutNaNs;
+        return *this;
+    }
+};
+
 /**
  * Tape Formula enumeration
  * GP9: Quantegy GP9 - Clean but "boring", higher MOL, steeper distortion curve
@@ -26,6 +55,8 @@ enum class TapeFormula
  *   1. AC Bias Shielding (HFCut) - Splits HF for clean bypass
  *   2. J-A Hysteresis - Realistic magnetic feel (DAFx paper params, c=0.98)
  *   3. Level-Scaled Cubic Saturation - THD curve with DC bias for E/O control
+ *      (the static bias is removed again after the cubic, so configurations
+ *      with different bias don't differ by a DC step)
  *   4. Clean HF Path - Recombines with saturated signal (sums to unity)
  *
  * Level-Scaled Cubic: effectiveA3 = a3Base * level^power
@@ -39,16 +70,49 @@ enum class TapeFormula
  * TRACKS MODE (Studer A820):
  *   - E/O ratio ~1.14 at 0dB (target 1.12, even-dominant)
  *   - Saturation: a3=0.0066, bias=0.19, power=0.50, lowLevelScale=0.80
+ *
+ * SAMPLE TYPE:
+ *   HybridTapeProcessor (double) is the reference engine. HybridTapeProcessorFloat
+ *   runs the signal path, J-A solver and filter state in float; parameters, the a3
+ *   tables, fade-in, the 5 Hz DC blockers and the MachineEQ sections up to 1kHz
+ *   stay in double.
+ *   See THDSweepTest::runPrecisionComparison() for the measured difference.
  */
-class HybridTapeProcessor
+template <typename SampleType>
+class HybridTapeProcessorT
 {
 public:
-    HybridTapeProcessor();
-    ~HybridTapeProcessor() = default;
+    HybridTapeProcessorT();
+    ~HybridTapeProcessorT() = default;
+
+    // Not copyable: the active a3 table may point into this object (customA3Table)
+    HybridTapeProcessorT(const HybridTapeProcessorT&) = delete;
+    HybridTapeProcessorT& operator=(const HybridTapeProcessorT&) = delete;
 
     void setSampleRate(double sampleRate);
     void reset();
 
+    /**
+     * Every shared coefficient set for one sample rate (allpass, delay, DC blocker,
+     * HFCut and MachineEQ), kept alive while the handle is held.
+     * prepareRate() looks them up or designs them, so it takes the cache lock and may
+     * allocate: call it from setup code. setSampleRate(tables) then takes neither a
+     * lock nor memory and is safe on the audio thread. A plain setSampleRate() at a
+     * prepared rate also finds the sets instead of designing them.
+     * The configurations and a3 tables are shared from construction on.
+     */
+    struct RateTables;
+    static std::shared_ptr<const RateTables> prepareRate(double sampleRate);
+    void setSampleRate(const RateTables& tables);
+
+    /**
+     * Copy the running signal state (filter memories, envelopes, J-A magnetization,
+     * azimuth delay line, fade-in) from another processor at the same sample rate,
+     * keeping this processor's own machine/tape configuration.
+     * Used to warm-start a standby processor before crossfading to it.
+     */
+    void copyStateFrom(const HybridTapeProcessorT& other);
+
     /**
      * @param biasStrength - < 0.74 = Master (Ampex), >= 0.74 = Tracks (Studer)
      * @param inputGain - Input gain scaling
@@ -70,23 +134,104 @@ public:
     void setTestCurvePower(double power);
     void setTestHighKnee(double threshold, double amount);
 
-    double processSample(double input);
-    double processRightChannel(double input);  // With azimuth delay
+    /**
+     * J-A Newton solver control and statistics
+     * Adaptive (default) exits early once converged; Fixed8 is the reference solver
+     */
+    void setJASolverMode(JilesAthertonBase::SolverMode mode) { jaCore.setSolverMode(mode); }
+    double getAverageJAIterations() const { return jaCore.getAverageIterations(); }
+    void resetJAIterationStats() { jaCore.resetIterationStats(); }
+
+    /**
+     * Event counters since the last resetDiagnostics() (J-A solver and output limiter)
+     * Read and reset from the thread that runs this processor
+     */
+    DiagnosticCounters getDiagnostics() const;
+    void resetDiagnostics();
+
+    /**
+     * J-A level gate: below this level (envelope and instantaneous |x|) the hysteresis
+     * solve is replaced by its small-signal linear model. Error grows with level^2 and
+     * stays below -130 dBFS of the output at the default threshold. 0 = always solve.
+     */
+    void setJAGateThreshold(double threshold) { jaGateThreshold = std::max(0.0, threshold); }
+    static constexpr double DEFAULT_JA_GATE_THRESHOLD = 0.03;
+
+    /**
+     * Number of HF dispersive allpass stages that run (0..NUM_DISPERSIVE_STAGES)
+     * All of them (default) for the calibrated phase response; fewer trade some
+     * of the HF phase smear for CPU (low-latency tracking).
+     */
+    static constexpr int NUM_DISPERSIVE_STAGES = 4;
+    void setDispersiveStages(int numStages);
+    int getDispersiveStages() const { return activeDispersiveStages; }
+
+    /**
+     * Azimuth delay of the right-channel paths (processRightChannel*, the right side
+     * of processStereoBlock). On by default: the stereo head's gap error between L/R.
+     * Off = right channel processed like the left, for tracks of a multitrack head
+     * that share no stereo pair.
+     */
+    void setAzimuthEnabled(bool enabled) { azimuthEnabled = enabled; }
+    bool getAzimuthEnabled() const { return azimuthEnabled; }
+
+    /**
+     * Control-rate evaluation for the block paths (processBlock / processStereoBlock)
+     * 1 (default) = per-sample envelopes and effectiveA3, identical to processSample()
+     * N > 1 = effectiveA3 and the J-A envelope/gate are evaluated every N samples,
+     *         effectiveA3 is linearly ramped in between (16-32 typical, max 64)
+     */
+    void setControlRateInterval(int interval);
+    int getControlRateInterval() const { return controlRateInterval; }
+
+    /**
+     * Antiderivative anti-aliasing (ADAA) for the level-scaled cubic
+     * First-order ADAA on the cubic term only: x³ is replaced by its average over
+     * the interval between two samples, (F(u[n]) - F(u[n-1])) / (u[n] - u[n-1])
+     * with F(u) = u⁴/4, which reduces to (u[n] + u[n-1])(u[n]² + u[n-1]²)/4 -
+     * no division, no ill-conditioned case. The linear term passes unchanged, so
+     * the HFCut / clean HF split still sums to unity.
+     * Meant for native-rate operation below 88.2kHz; off (default) = plain cubic.
+     */
+    void setSaturationADAA(bool enabled) { saturationADAA = enabled; }
+    bool getSaturationADAA() const { return saturationADAA; }
+
+    SampleType processSample(SampleType input);
+    SampleType processRightChannel(SampleType input);  // With azimuth delay
+
+    /**
+     * Block processing - bit-identical to calling processSample() per sample, for
+     * float and double engines (Tests/processing_paths_test.cpp), but each stage
+     * runs as a tight loop over the block with its state in locals.
+     * In-place processing (input == output) is allowed.
+     */
+    void processBlock(const float* input, float* output, int numSamples);
+    void processRightChannelBlock(const float* input, float* output, int numSamples);  // With azimuth delay
+
+    /**
+     * Stereo block processing: left through `left`, right (with azimuth delay) through `right`
+     *
+     * When both processors share a configuration (same machine and sample rate - the
+     * normal stereo case) the linear stages run as one SIMD recursion with L and R in
+     * the two lanes of a StereoLane. Otherwise each channel runs its own block path.
+     */
+    static void processStereoBlock(HybridTapeProcessorT& left, HybridTapeProcessorT& right,
+                                   const float* inputL, const float* inputR,
+                                   float* outputL, float* outputR, int numSamples);
 
 private:
-    // Azimuth delay buffer (supports up to 384kHz)
+    // Block processing works in sub-blocks so scratch buffers stay on the stack (and in L1)
+    static constexpr int MAX_SUB_BLOCK_SIZE = 64;
+
+    // Members read per sample come first, so the hot path spans as few cache lines as
+    // possible; setup, mode and test-only state follows after the MachineEQ sections
+
+    // Azimuth delay: Thiran allpass fractional delay (ring supports up to 384kHz)
     static constexpr int DELAY_BUFFER_SIZE = 8;
-    double delayBuffer[DELAY_BUFFER_SIZE] = {0.0};
-    int delayWriteIndex = 0;
-    double cachedDelaySamples = 0.0;
-    double allpassState = 0.0;  // Thiran allpass filter state for fractional delay
+    ThiranDelay<SampleType, DELAY_BUFFER_SIZE> azimuthDelay;
+    bool azimuthEnabled = true;
 
-    // Parameters
-    double currentBiasStrength = 0.5;
-    double currentInputGain = 1.0;
-    bool isAmpexMode = true;
-    TapeFormula currentTapeFormula = TapeFormula::GP9;
-    double fs = 48000.0;
+    double currentInputGain = 1.0;  // Input gain scaling (setParameters)
 
     // Global input bias for E/O ratio (even harmonics)
     double inputBias = 0.0;
@@ -94,19 +239,36 @@ private:
     // Level-scaled cubic saturation parameters
     double satA3 = 0.0028;   // Base cubic coefficient
     double satPower = 0.5;   // Level scaling exponent (THD slope = 2 + power)
-    double satEnvelope = 0.0; // Saturation envelope follower
+    SampleType satEnvelope = 0; // Saturation envelope follower
+    bool saturationADAA = false;    // First-order ADAA on the cubic term
+    SampleType satPrevious = 0;     // Previous biased input of the cubic (ADAA state)
     double lowLevelScale = 0.5;  // Min a3 scale at very low levels (machine-specific)
     double lowThreshold = 0.5;   // Threshold below which low-level scaling applies
     double curvePower = 2.0;     // Power for low-level curve shape (2.0 = t²)
-    double highKneeThreshold = 1.0;  // Threshold above which high-level reduction applies
-    double highKneeAmount = 0.0;     // Amount of high-level reduction (0 = off)
+
+    // effectiveA3(envelope) gain curve, tabulated whenever the saturation parameters change
+    // Linear interpolation over [0, A3_TABLE_MAX_ENV]; hotter envelopes are computed directly
+    static constexpr int A3_TABLE_SIZE = 1024;
+    static constexpr double A3_TABLE_MAX_ENV = 2.0;
+    static constexpr double A3_TABLE_SCALE = A3_TABLE_SIZE / A3_TABLE_MAX_ENV;
+    const double* a3Table = nullptr;  // Points at the active configuration's table (or customA3Table)
+
+    // Control-rate state (block paths with controlRateInterval > 1)
+    int controlRateInterval = 1;
+    int controlCountdown = 0;       // Samples left until the next control tick
+    SampleType jaAbsSum = 0;        // |J-A input| accumulated since the last tick
+    double a3Current = 0.0;         // effectiveA3 at the end of the last segment (ramp start)
+    double envAttackN = 0.0;        // J-A envelope attack coefficient per tick
+    double envReleaseN = 0.0;       // J-A envelope release coefficient per tick
 
     // J-A hysteresis blend (machine-specific based on AC bias frequency)
     // Higher bias freq = more linearization = less hysteresis character
     double jaBlend = 0.10;   // Ampex: 0.06 (432kHz bias), Studer: 0.12 (153.6kHz bias)
 
     // DC blocking (4th-order Butterworth @ 5Hz)
+    // Always double: the poles sit within ~1e-4 of z = 1 at oversampled rates
     struct Biquad {
+        using ValueType = double;
         double b0 = 1.0, b1 = 0.0, b2 = 0.0;
         double a1 = 0.0, a2 = 0.0;
         double z1 = 0.0, z2 = 0.0;
@@ -117,53 +279,171 @@ private:
             z2 = b2 * input - a2 * output;
             return output;
         }
+        // first then second in one pass, the value in between kept in double (as in
+        // processSample()), so float data gets the same result on every path
+        template <typename DataType>
+        static void processCascadeBlock(Biquad& first, Biquad& second, DataType* data, int numSamples) {
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = static_cast<DataType>(second.process(first.process(static_cast<double>(data[i]))));
+        }
     };
     Biquad dcBlocker1, dcBlocker2;
 
     // AC Bias Shielding (parallel path)
     // HFCut extracts LF for saturation, cleanHF = input - HFCut(input) bypasses
-    HFCut hfCut;
+    HFCutT<SampleType> hfCut;
     double cleanHfBlend = 1.0;
 
     // Dispersive allpass (HF phase smear)
     struct AllpassFilter {
-        double coefficient = 0.0;
-        double z1 = 0.0;
-        void setFrequency(double freq, double sampleRate) {
+        SampleType coefficient = 0;
+        SampleType z1 = 0;
+        static double designCoefficient(double freq, double sampleRate) {
+            // A corner at or above Nyquist (the top Ampex stage at native 44.1/48kHz)
+            // gives |coefficient| > 1, an unstable filter: hold it just below Nyquist
+            freq = std::min(freq, 0.49 * sampleRate);
             double w0 = 2.0 * M_PI * freq / sampleRate;
             double tanHalf = std::tan(w0 / 2.0);
-            coefficient = (1.0 - tanHalf) / (1.0 + tanHalf);
+            return (1.0 - tanHalf) / (1.0 + tanHalf);
         }
-        void reset() { z1 = 0.0; }
-        double process(double input) {
-            double output = coefficient * input + z1;
+        void reset() { z1 = 0; }
+        SampleType process(SampleType input) {
+            SampleType output = coefficient * input + z1;
             z1 = input - coefficient * output;
             return output;
         }
+        void processBlock(SampleType* data, int numSamples) {
+            const SampleType coeff = coefficient;
+            SampleType s1 = z1;
+            for (int i = 0; i < numSamples; ++i) {
+                const SampleType input = data[i];
+                const SampleType output = coeff * input + s1;
+                s1 = input - coeff * output;
+                data[i] = output;
+            }
+            z1 = s1;
+        }
     };
-    static constexpr int NUM_DISPERSIVE_STAGES = 4;
     AllpassFilter dispersiveAllpass[NUM_DISPERSIVE_STAGES];
+    int activeDispersiveStages = NUM_DISPERSIVE_STAGES;
     double dispersiveCornerFreq = 10000.0;
 
     // Jiles-Atherton hysteresis (realistic DAFx parameters)
-    JilesAthertonCore jaCore;
+    JilesAthertonCoreT<SampleType> jaCore;
     double jaOutputScale = 1.0;  // Calculated for unity gain at 0VU
+    unsigned long long jaOutLimitCount = 0;  // Diagnostics (TAPE_MACHINE_DIAGNOSTICS builds)
+    unsigned long long jaOutNaNCount = 0;
+    double jaGateThreshold = DEFAULT_JA_GATE_THRESHOLD;  // Below this level J-A runs its linear small-signal model
 
     // J-A envelope follower (for smooth level tracking)
-    double jaEnvelope = 0.0;        // Envelope follower state
+    SampleType jaEnvelope = 0;      // Envelope follower state
     double envAttack = 0.0;         // Attack coefficient (computed from sample rate)
     double envRelease = 0.0;        // Release coefficient (computed from sample rate)
 
     // Machine EQ
-    MachineEQ machineEQ;
+    MachineEQT<SampleType> machineEQ;
 
     // Startup fade-in to prevent pop from DC blocker initialization
-    double fadeInGain = 0.0;       // Current fade-in gain (0 to 1)
+    double fadeInGain = 0.0;       // Current fade-in gain (0 to 1), double: accumulates ~1e5 steps
     double fadeInIncrement = 0.0;  // Increment per sample (set in setSampleRate)
     static constexpr double FADE_IN_TIME_MS = 150.0;  // 150ms fade-in (4th-order DC blocker needs time)
 
+    // === Cold state: read when the sample rate, mode or test parameters change ===
+    double currentBiasStrength = 0.5;
+    bool isAmpexMode = true;
+    TapeFormula currentTapeFormula = TapeFormula::GP9;
+    double fs = 48000.0;
+
+    // Test-only high-level knee (see setTestHighKnee) and the a3 table it forces
+    double highKneeThreshold = 1.0;  // Threshold above which high-level reduction applies
+    double highKneeAmount = 0.0;     // Amount of high-level reduction (0 = off)
+    double customA3Table[A3_TABLE_SIZE + 1] = {0.0};  // Rebuilt by the test-parameter setters
+
+    // Precomputed machine/tape configurations (Studer/Ampex x GP9/SM900)
+    // Parameters and a3 tables are built once per process, filter coefficients once
+    // per sample rate, and both are shared read-only by every processor
+    // (SharedTableCache), so a mode switch copies scalars - no trig, no allocation
+    struct TapeConfiguration {
+        JilesAthertonCore::Parameters jaParams;
+        double jaOutputScale = 1.0;
+        double satA3 = 0.0;
+        double satPower = 0.0;
+        double inputBias = 0.0;
+        double lowLevelScale = 0.0;
+        double dispersiveCornerFreq = 10000.0;
+        double jaBlend = 0.0;
+        double lowThreshold = 0.5;
+        double curvePower = 2.0;
+        double delayMicroseconds = 0.0;
+
+        double a3Table[A3_TABLE_SIZE + 1] = {0.0};
+    };
+    static constexpr int NUM_CONFIGURATIONS = 4;  // Index: (isAmpex ? 2 : 0) + (isSM900 ? 1 : 0)
+    struct TapeConfigurations {
+        TapeConfiguration config[NUM_CONFIGURATIONS];
+    };
+
+    // Sample-rate dependent part of the configurations
+    struct RateCoefficients {
+        double allpassCoefficients[NUM_CONFIGURATIONS][NUM_DISPERSIVE_STAGES] = {};
+        double delaySamples[NUM_CONFIGURATIONS] = {};
+        Biquad dcBlocker;  // Coefficients only, state unused
+    };
+
+    std::shared_ptr<const TapeConfigurations> configurations;
+    std::shared_ptr<const RateCoefficients> rateCoefficients;
+
+    static void initConfiguration(TapeConfiguration& config, bool isAmpex, bool isSM900);
+    void buildConfigurations(TapeConfigurations& set);
+    static void designRateCoefficients(RateCoefficients& rate, const TapeConfigurations& set, double sampleRate);
+    void updateConfigurationsForSampleRate();
+    void applyConfiguration(int index);
+    void applySampleRate();  // Everything that follows fs once the coefficient sets are in place
+
     void updateCachedValues();
-    double saturate(double x);  // Main saturation function
+    void rebuildA3Table();
+    void fillA3Table(double* table) const;
+    double computeEffectiveA3(double clampedEnv) const;  // Direct evaluation of the a3 curve
+    double lookupEffectiveA3(double envelope) const;     // Table lookup of the a3 curve
+    SampleType saturate(SampleType x, SampleType& envelope, SampleType& previous) const;  // Main saturation function
+    SampleType processNonlinear(SampleType hfCutSignal, SampleType& jaEnv, SampleType& satEnv);  // J-A + saturation
+    template <bool LinearRegion>
+    SampleType processJA(SampleType hfCutSignal);  // Scaled, limited J-A output (LinearRegion: small-signal model)
+
+    // Nonlinear stage over a sub-block: data holds the HFCut signal (every `stride`
+    // samples) and receives saturated + cleanHF * cleanHfBlend
+    void processNonlinearBlock(SampleType* data, const SampleType* cleanHF, int stride, int numSamples);
+
+    // Control-rate segment kernels: the J-A gate and the saturation variant are fixed for a
+    // segment, so each is a compile-time parameter and the inner loops carry no branches
+    template <bool LinearRegion>
+    SampleType blendSegment(SampleType* data, int stride, int begin, int end, SampleType satEnv);  // Returns satEnv
+    template <bool ADAA>
+    void saturateSegment(SampleType* data, const SampleType* cleanHF, int stride, int begin, int end,
+                         SampleType a3Start, SampleType a3Step);
+    void updateControlRateCoefficients();
+    void controlTick();
+    SampleType applyAzimuthDelay(SampleType processed);
+
+    // Block stages (in-place on a sub-block of at most MAX_SUB_BLOCK_SIZE samples)
+    void processSubBlock(SampleType* data, int numSamples);
+    void applyAzimuthDelayBlock(SampleType* data, int numSamples);
+
+    // Stereo-lane path: interleaved [L, R] sub-block through both processors at once
+    bool sharesLinearConfiguration(const HybridTapeProcessorT& other) const;
+    static void processStereoSubBlock(HybridTapeProcessorT& left, HybridTapeProcessorT& right,
+                                      SampleType* interleaved, int numSamples);
+};
+
+template <typename SampleType>
+struct HybridTapeProcessorT<SampleType>::RateTables {
+    double sampleRate = 0.0;
+    std::shared_ptr<const RateCoefficients> rateCoefficients;
+    std::shared_ptr<const void> hfCut;      // HFCutT::retainCoefficients
+    std::shared_ptr<const void> machineEQ;  // MachineEQT::retainCoefficients
 };
 
+using HybridTapeProcessor = HybridTapeProcessorT<double>;
+using HybridTapeProcessorFloat = HybridTapeProcessorT<float>;
+
 } // namespace TapeMachine
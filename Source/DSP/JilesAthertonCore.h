@@ -1,25 +1,17 @@
 #pragma once
 
+#include "FastMath.h"
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 
-namespace TapeMachine {
+// Event counters for the plugin's diagnostics panel (NaN resets, soft limiting)
+// Compiled out unless the build defines TAPE_MACHINE_DIAGNOSTICS=1
+#ifndef TAPE_MACHINE_DIAGNOSTICS
+ #define TAPE_MACHINE_DIAGNOSTICS 0
+#endif
 
-// Fast tanh approximation using Padé approximant
-// Accurate to ~1e-6 for |x| < 4, smoothly saturates beyond
-// ~3-4x faster than std::tanh
-inline double fastTanh(double x) {
-    // For large |x|, tanh saturates to ±1
-    if (x > 4.0) return 1.0;
-    if (x < -4.0) return -1.0;
-
-    // Padé approximant: tanh(x) ≈ x(27 + x²) / (27 + 9x²)
-    // More accurate version with higher order terms
-    double x2 = x * x;
-    double num = x * (135135.0 + x2 * (17325.0 + x2 * (378.0 + x2)));
-    double den = 135135.0 + x2 * (62370.0 + x2 * (3150.0 + x2 * 28.0));
-    return num / den;
-}
+namespace TapeMachine {
 
 // Jiles-Atherton Hysteresis Model
 // Based on "Real-Time Physical Modelling for Analog Tape Machines" (DAFx 2019)
@@ -28,8 +20,22 @@ inline double fastTanh(double x) {
 // - Increased Langevin threshold from 1e-4 to 0.01 to avoid coth(x) singularity
 // - Added output soft limiting to prevent pops from numerical artifacts
 // - Added denormal and NaN/Inf protection
-class JilesAthertonCore {
+//
+// SOLVER MODES:
+// - Fixed8:   always 8 Newton-Raphson iterations from M_n1 (original behaviour)
+// - Adaptive: warm-started from M_n1 + (dM/dH)_n1 * dH, exits once the Newton
+//             step falls below the convergence tolerance (default)
+//             ~2 iterations per sample, matches Fixed8 to ~1e-13 relative
+//
+// SAMPLE TYPE:
+// - JilesAthertonCoreT<double>: reference precision (JilesAthertonCore)
+// - JilesAthertonCoreT<float>:  single-precision state and solver; the default
+//             adaptive tolerance is relaxed to what float can resolve
+//             Parameters and the sample period are always given in double
+class JilesAthertonBase {
 public:
+    enum class SolverMode { Fixed8, Adaptive };
+
     struct Parameters {
         double M_s = 350000.0;   // Saturation magnetization
         double a = 22000.0;      // Domain wall density
@@ -37,51 +43,132 @@ public:
         double c = 1.7e-1;       // Reversibility
         double alpha = 1.6e-3;   // Mean field parameter
     };
+};
+
+template <typename SampleType>
+class JilesAthertonCoreT : public JilesAthertonBase {
+public:
+    using S = SampleType;
 
-    JilesAthertonCore() { reset(); }
+    // Smallest relative Newton step the adaptive solver waits for by default
+    static constexpr double defaultTolerance = std::is_same<SampleType, float>::value ? 1e-6 : 1e-9;
+
+    JilesAthertonCoreT() { reset(); }
 
     void setParameters(const Parameters& p) {
-        params = p;
-        oneOverA = 1.0 / params.a;
-        cAlpha = params.c * params.alpha;
+        M_s = S(p.M_s);
+        k = S(p.k);
+        c = S(p.c);
+        alpha = S(p.alpha);
+        oneOverA = S(1.0) / S(p.a);
+        cAlpha = c * alpha;
+
+        // Small-signal slope around M = 0: L'(0) = 1/3, so dM/dH = c*M_s*alpha/(3a) / (1 - c*alpha)
+        S denom = S(1.0) - cAlpha;
+        if (std::abs(denom) < S(1e-12)) denom = S(1e-12);
+        smallSignalChi = c * M_s * alpha * oneOverA / S(3.0) / denom;
     }
 
     void setSampleRate(double sr) {
-        T = 1.0 / sr;
+        T = S(1.0 / sr);
     }
 
+    // Adaptive mode: stop when |update| <= tolerance * max(|M|, 1e-12)
+    void setSolverMode(SolverMode mode, double relativeTolerance = defaultTolerance, int maxIterations = 8) {
+        solverMode = mode;
+        tolerance = S(relativeTolerance);
+        maxIter = std::max(1, maxIterations);
+    }
+
+    SolverMode getSolverMode() const { return solverMode; }
+
     void reset() {
-        M_n1 = 0.0;
-        H_n1 = 0.0;
+        M_n1 = 0;
+        H_n1 = 0;
+        dMdH_n1 = 0;
     }
 
-    double process(double H) {
+    // Take over another core's magnetization history (same material or not)
+    void copyStateFrom(const JilesAthertonCoreT& other) {
+        M_n1 = other.M_n1;
+        H_n1 = other.H_n1;
+        dMdH_n1 = other.dMdH_n1;
+    }
+
+    // Newton iteration statistics (for verifying the adaptive solver)
+    int getLastIterationCount() const { return lastIterations; }
+    unsigned long long getTotalIterations() const { return totalIterations; }
+    unsigned long long getTotalSolves() const { return totalSolves; }
+    double getAverageIterations() const {
+        return totalSolves > 0 ? static_cast<double>(totalIterations) / static_cast<double>(totalSolves) : 0.0;
+    }
+    void resetIterationStats() {
+        totalIterations = 0;
+        totalSolves = 0;
+        lastIterations = 0;
+        nanResets = 0;
+        softLimits = 0;
+    }
+
+    // NaN/Inf state resets and output soft-limit events since resetIterationStats()
+    // Always 0 unless TAPE_MACHINE_DIAGNOSTICS is enabled
+    unsigned long long getNaNResetCount() const { return nanResets; }
+    unsigned long long getSoftLimitCount() const { return softLimits; }
+
+    // Linearized susceptibility used by processLinear()
+    S getSmallSignalSusceptibility() const { return smallSignalChi; }
+
+    // Advance along the small-signal model M = chi * H without running the solver
+    // Used when the caller knows the level is far below the hysteresis knee; the
+    // state (M_n1, H_n1, dM/dH) is kept consistent so process() can resume seamlessly
+    S processLinear(S H) {
+        S M = smallSignalChi * H;
+        dMdH_n1 = smallSignalChi;
+        H_n1 = H;
+        M_n1 = M;
+        return M;
+    }
+
+    S process(S H) {
         // Flush denormals in input
-        if (std::abs(H) < 1e-15) H = 0.0;
+        if (std::abs(H) < S(1e-15)) H = S(0.0);
 
         // Calculate derivative with slew rate limiting
         // Limit delta to prevent numerical instability from sudden changes
-        double delta = H - H_n1;
-        delta = std::clamp(delta, -10000.0 * T, 10000.0 * T);  // Max 10000 units/second
-        double H_d = delta / T;
+        S delta = H - H_n1;
+        delta = std::clamp(delta, S(-10000.0) * T, S(10000.0) * T);  // Max 10000 units/second
+        S H_d = delta / T;
 
-        double M = solveNR8(H, H_d);
+        S M = (solverMode == SolverMode::Adaptive) ? solveAdaptive(H, H_d) : solveNR8(H, H_d);
+
+        totalIterations += static_cast<unsigned long long>(lastIterations);
+        ++totalSolves;
 
         // NaN/Inf protection - reset state if we get garbage
         if (!std::isfinite(M)) {
-            M = 0.0;
-            M_n1 = 0.0;
+#if TAPE_MACHINE_DIAGNOSTICS
+            ++nanResets;
+#endif
+            M = 0;
+            M_n1 = 0;
             H_n1 = H;
-            return 0.0;
+            dMdH_n1 = 0;
+            return 0;
         }
 
+        // Slope of the step just taken seeds the next sample's initial guess
+        dMdH_n1 = (std::abs(delta) > S(0.0)) ? (M - M_n1) / delta : dMdH_n1;
+
         H_n1 = H;
         M_n1 = M;
 
         // Soft limit output to prevent pops from numerical artifacts
         // Uses gentle tanh limiting at ±M_s with some headroom
-        double maxOutput = params.M_s * 1.1;
-        if (std::abs(M) > maxOutput * 0.9) {
+        S maxOutput = M_s * S(1.1);
+        if (std::abs(M) > maxOutput * S(0.9)) {
+#if TAPE_MACHINE_DIAGNOSTICS
+            ++softLimits;
+#endif
             M = maxOutput * fastTanh(M / maxOutput);
         }
 
@@ -89,103 +176,110 @@ public:
     }
 
 private:
-    Parameters params;
-    double T = 1.0 / 48000.0;
-    double M_n1 = 0.0;
-    double H_n1 = 0.0;
-    double oneOverA = 1.0 / 22000.0;
-    double cAlpha = 0.0;
-
-    // Combined Langevin function and derivative computation
-    // Returns both L(x) and L'(x) in a single pass to avoid redundant tanh calls
-    // L(x) = coth(x) - 1/x
-    // L'(x) = 1/x² - csch²(x) = 1/x² - coth²(x) + 1
-    //
-    // STABILITY FIX: Increased threshold from 1e-4 to 0.01
-    // Near x=0, coth(x) approaches infinity, so we use Taylor series
-    // for small x to avoid the singularity
-    void langevinBoth(double x, double& L, double& Ld) const {
-        // Use Taylor series for small x to avoid coth singularity
-        // Taylor series: L(x) ≈ x/3 - x³/45 + 2x⁵/945 - ...
-        // L'(x) ≈ 1/3 - x²/15 + 2x⁴/189 - ...
-        // Threshold increased to 0.01 for better numerical stability
-        if (std::abs(x) < 0.01) {
-            double x2 = x * x;
-            // More terms for better accuracy at the boundary
-            L = x * (1.0/3.0 - x2 * (1.0/45.0 - x2 * (2.0/945.0)));
-            Ld = 1.0/3.0 - x2 * (1.0/15.0 - x2 * (2.0/189.0));
-            return;
+    S M_s = S(350000.0);  // Parameters in SampleType
+    S k = S(27500.0);
+    S c = S(1.7e-1);
+    S alpha = S(1.6e-3);
+    S T = S(1.0 / 48000.0);
+    S M_n1 = 0;
+    S H_n1 = 0;
+    S oneOverA = S(1.0 / 22000.0);
+    S cAlpha = 0;
+    S dMdH_n1 = 0;  // Previous dM/dH (adaptive solver warm start)
+    S smallSignalChi = 0;  // Linearized dM/dH around M = 0
+
+    SolverMode solverMode = SolverMode::Adaptive;
+    S tolerance = S(defaultTolerance);
+    int maxIter = 8;
+
+    int lastIterations = 0;
+    unsigned long long totalIterations = 0;
+    unsigned long long totalSolves = 0;
+    unsigned long long nanResets = 0;
+    unsigned long long softLimits = 0;
+
+    // One Newton-Raphson step on f(M) = M - M_n1 - T * dM/dH(M) * H_d
+    // Returns the (clamped) update that was subtracted from M
+    S newtonStep(S& M, S H, S H_d, S delta, S denom) const {
+        S H_eff = H + alpha * M;
+        S x = H_eff * oneOverA;
+
+        // Langevin function and its derivative in one branch-free pass (FastMath.h)
+        // STABILITY FIX: Taylor series below |x| = 0.01 (was 1e-4) keeps clear of the coth singularity
+        S L, Ld;
+        fastLangevin(x, L, Ld);
+
+        S M_an = M_s * L;
+        S dM_an_dM = M_s * Ld * oneOverA * alpha;
+        S M_diff = M_an - M;
+        S delta_k = delta * k;
+
+        // Protect against division issues
+        S denomDiff = delta_k - alpha * M_diff;
+        if (std::abs(denomDiff) < S(1e-10)) denomDiff = (denomDiff >= 0) ? S(1e-10) : S(-1e-10);
+
+        S dM_dH = (std::abs(M_diff) > S(1e-12) && delta * M_diff > 0)
+            ? (M_diff / denomDiff + c * dM_an_dM) / denom
+            : c * dM_an_dM / denom;
+
+        S f = M - M_n1 - T * dM_dH * H_d;
+        S df_dM = (std::abs(denomDiff) > S(1e-12))
+            ? (dM_an_dM - S(1.0)) / denomDiff / denom
+            : S(0.0);
+        S f_prime = S(1.0) - T * H_d * df_dM;
+
+        // Newton-Raphson update with protection
+        S update = 0;
+        if (std::abs(f_prime) > S(1e-10)) {
+            update = f / f_prime;
+            // Limit update step size to prevent oscillation
+            update = std::clamp(update, -M_s * S(0.1), M_s * S(0.1));
+            M -= update;
         }
 
-        double tanhX = fastTanh(x);
+        M = std::clamp(M, -M_s, M_s);
+        return update;
+    }
 
-        // Protect against division by very small tanh values
-        // This can happen at intermediate x values near the threshold
-        if (std::abs(tanhX) < 1e-6) {
-            // Use Taylor approximation as fallback
-            double x2 = x * x;
-            L = x * (1.0/3.0 - x2 * (1.0/45.0));
-            Ld = 1.0/3.0 - x2 * (1.0/15.0);
-            return;
-        }
+    S solverDenominator() const {
+        S denom = S(1.0) - cAlpha;
 
-        double cothX = 1.0 / tanhX;  // coth = 1/tanh
-        double invX = 1.0 / x;
-        L = cothX - invX;
-        Ld = invX * invX - cothX * cothX + 1.0;
+        // Protect against division by zero
+        if (std::abs(denom) < S(1e-12)) denom = S(1e-12);
+        return denom;
+    }
+
+    S solveNR8(S H, S H_d) {
+        S delta = (H_d >= S(0.0)) ? S(1.0) : S(-1.0);
+        S M = M_n1;
+        S denom = solverDenominator();
 
-        // Sanity check - L should be bounded by ±1 for reasonable x
-        L = std::clamp(L, -1.0, 1.0);
-        Ld = std::clamp(Ld, 0.0, 1.0/3.0 + 0.01);  // Ld max is 1/3 at x=0
+        for (int i = 0; i < 8; ++i) {
+            newtonStep(M, H, H_d, delta, denom);
+        }
+        lastIterations = 8;
+        return M;
     }
 
-    double solveNR8(double H, double H_d) {
-        double delta = (H_d >= 0.0) ? 1.0 : -1.0;
-        double M = M_n1;
-        double denom = 1.0 - cAlpha;
+    S solveAdaptive(S H, S H_d) {
+        S delta = (H_d >= S(0.0)) ? S(1.0) : S(-1.0);
+        S denom = solverDenominator();
 
-        // Protect against division by zero
-        if (std::abs(denom) < 1e-12) denom = 1e-12;
+        // Warm start: extrapolate along the previous slope
+        S M = std::clamp(M_n1 + dMdH_n1 * T * H_d, -M_s, M_s);
 
-        for (int i = 0; i < 8; ++i) {
-            double H_eff = H + params.alpha * M;
-            double x = H_eff * oneOverA;
-
-            // Get both Langevin and its derivative in one call
-            double L, Ld;
-            langevinBoth(x, L, Ld);
-
-            double M_an = params.M_s * L;
-            double dM_an_dM = params.M_s * Ld * oneOverA * params.alpha;
-            double M_diff = M_an - M;
-            double delta_k = delta * params.k;
-
-            // Protect against division issues
-            double denomDiff = delta_k - params.alpha * M_diff;
-            if (std::abs(denomDiff) < 1e-10) denomDiff = (denomDiff >= 0) ? 1e-10 : -1e-10;
-
-            double dM_dH = (std::abs(M_diff) > 1e-12 && delta * M_diff > 0)
-                ? (M_diff / denomDiff + params.c * dM_an_dM) / denom
-                : params.c * dM_an_dM / denom;
-
-            double f = M - M_n1 - T * dM_dH * H_d;
-            double df_dM = (std::abs(denomDiff) > 1e-12)
-                ? (dM_an_dM - 1.0) / denomDiff / denom
-                : 0.0;
-            double f_prime = 1.0 - T * H_d * df_dM;
-
-            // Newton-Raphson update with protection
-            if (std::abs(f_prime) > 1e-10) {
-                double update = f / f_prime;
-                // Limit update step size to prevent oscillation
-                update = std::clamp(update, -params.M_s * 0.1, params.M_s * 0.1);
-                M -= update;
-            }
-
-            M = std::clamp(M, -params.M_s, params.M_s);
+        int iterations = 0;
+        while (iterations < maxIter) {
+            S update = newtonStep(M, H, H_d, delta, denom);
+            ++iterations;
+            if (std::abs(update) <= tolerance * std::max(std::abs(M), S(1e-12)))
+                break;
         }
+        lastIterations = iterations;
         return M;
     }
 };
 
+using JilesAthertonCore = JilesAthertonCoreT<double>;
+
 } // namespace TapeMachine
@@ -3,24 +3,28 @@
 namespace TapeMachine
 {
 
-MachineEQ::MachineEQ()
+template <typename SampleType>
+MachineEQT<SampleType>::MachineEQT()
 {
     setMachine(Machine::Ampex);
     updateCoefficients();
 }
 
-void MachineEQ::setSampleRate(double sampleRate)
+template <typename SampleType>
+void MachineEQT<SampleType>::setSampleRate(double sampleRate)
 {
     fs = sampleRate;
     updateCoefficients();
 }
 
-void MachineEQ::setMachine(Machine machine)
+template <typename SampleType>
+void MachineEQT<SampleType>::setMachine(Machine machine)
 {
     currentMachine = machine;
 }
 
-void MachineEQ::reset()
+template <typename SampleType>
+void MachineEQT<SampleType>::reset()
 {
     // Reset Ampex filters
     ampexHP.reset();
@@ -28,11 +32,9 @@ void MachineEQ::reset()
     ampexBell2.reset();
     ampexBell3.reset();
     ampexBell4.reset();
-    ampexBell5.reset();
     ampexBell6.reset();
     ampexBell7.reset();
     ampexBell8.reset();
-    ampexBell9.reset();
     ampexBell10.reset();
     ampexLP.reset();
 
@@ -50,77 +52,152 @@ void MachineEQ::reset()
     studerBell9.reset();
 }
 
-void MachineEQ::updateCoefficients()
+template <typename SampleType>
+void MachineEQT<SampleType>::copyStateFrom(const MachineEQT& other)
+{
+    // Only the chain `other` is running holds live state. Same machine and rate:
+    // coefficients are identical, so a plain copy carries the memories over.
+    // Different machine: start this chain from rest
+    if (other.currentMachine == currentMachine && other.fs == fs)
+        *this = other;
+    else
+        reset();
+}
+
+template <typename SampleType>
+void MachineEQT<SampleType>::designCoefficients(Coefficients& c, double sampleRate)
 {
     // === Ampex ATR-102 "Master" EQ ===
     // Targets: 15Hz=-1.5dB, 20Hz=-1.2dB, 28Hz=0, 40Hz=+1.1dB, 70Hz=+0.15dB,
     // 105Hz=+0.3dB, 150Hz=0, 250Hz=-0.1dB, 1kHz=+0.1dB, 5.5kHz=-0.25dB,
     // 10.5kHz=0, 15kHz=+0.15dB, 20kHz=0, 30kHz=-3dB
     // Optimized parameters: RMS error 0.03dB
-    ampexHP.setHighPass(16.0, 0.7071, fs);       // HP @ 16Hz
-    ampexBell1.setBell(15.0, 6.0, 2.0, fs);      // Tight LF lift
-    ampexBell2.setBell(40.0, 2.0, 1.2, fs);      // Head bump @ 40Hz
-    ampexBell3.setBell(75.0, 2.0, -0.1, fs);     // -0.1dB @ 75Hz
-    ampexBell4.setBell(100.0, 2.0, 0.3, fs);     // +0.3dB @ 100Hz
-    ampexBell5.setBell(150.0, 2.0, 0.0, fs);     // Disabled
+    c.ampexHP.setHighPass(16.0, 0.7071, sampleRate);        // HP @ 16Hz
+    c.ampexBell1.setBell(15.0, 6.0, 2.0, sampleRate);       // Tight LF lift
+    c.ampexBell2.setBell(40.0, 2.0, 1.2, sampleRate);       // Head bump @ 40Hz
+    c.ampexBell3.setBell(75.0, 2.0, -0.1, sampleRate);      // -0.1dB @ 75Hz
+    c.ampexBell4.setBell(100.0, 2.0, 0.3, sampleRate);      // +0.3dB @ 100Hz
+    // 150Hz: no section (a 0 dB bell here is an exact identity)
     // Midrange
-    ampexBell6.setBell(250.0, 2.0, -0.1, fs);    // -0.1dB @ 250Hz
-    ampexBell7.setBell(1000.0, 1.5, 0.1, fs);    // +0.1dB @ 1kHz
-    ampexBell8.setBell(5500.0, 1.0, -0.25, fs);  // -0.25dB @ 5.5kHz (trough)
-    ampexBell9.setBell(10500.0, 1.5, 0.0, fs);   // Disabled
+    c.ampexBell6.setBell(250.0, 2.0, -0.1, sampleRate);     // -0.1dB @ 250Hz
+    c.ampexBell7.setBell(1000.0, 1.5, 0.1, sampleRate);     // +0.1dB @ 1kHz
+    c.ampexBell8.setBell(5500.0, 1.0, -0.25, sampleRate);   // -0.25dB @ 5.5kHz (trough)
+    // 10.5kHz: no section (as at 150Hz)
     // HF
-    ampexBell10.setBell(18000.0, 1.0, 0.35, fs); // +0.15dB @ 15kHz (air)
-    ampexLP.setLowPass(30000.0, 0.7, fs);        // LP2 @ 30kHz, -3dB
+    c.ampexBell10.setBell(18000.0, 1.0, 0.35, sampleRate);  // +0.15dB @ 15kHz (air)
+    c.ampexLP.setLowPass(30000.0, 0.7, sampleRate);         // LP2 @ 30kHz, -3dB
 
     // === Studer A820 "Tracks" EQ ===
     // Targets from Jack Endino: 20Hz=-9dB, 30Hz=-2dB, 38Hz=0dB, 50Hz=+0.55dB,
     // 70Hz=+0.1dB, 110Hz=+1.2dB, 160Hz=+0.5dB, 200Hz=+0.1dB, 400Hz=+0.1dB,
     // 600Hz=+0.2dB, 2kHz=+0.1dB, 5kHz=+0.5dB, 10kHz=0dB, 20kHz=+0.5dB
     // Optimized parameters: RMS error 0.039dB
-    studerHP1.setHighPass(27.0, 1.0, fs);        // 2nd order @ 27Hz
-    studerHP2.setHighPass(30.5, fs);             // 1st order @ 30.5Hz (total 18 dB/oct)
+    c.studerHP1.setHighPass(27.0, 1.0, sampleRate);         // 2nd order @ 27Hz
+    c.studerHP2.setHighPass(30.5, sampleRate);              // 1st order @ 30.5Hz (total 18 dB/oct)
     // Head bumps and LF shaping
-    studerBell1.setBell(46.0, 1.4, 1.10, fs);    // Head bump @ 46Hz
-    studerBell2.setBell(70.0, 2.0, -0.50, fs);   // Dip at 70Hz
-    studerBell3.setBell(110.0, 2.0, 1.20, fs);   // Head bump 2 @ 110Hz
-    studerBell4.setBell(160.0, 1.5, 0.30, fs);   // Shape at 160Hz
-    studerBell5.setBell(200.0, 2.0, -0.30, fs);  // Notch at 200Hz
+    c.studerBell1.setBell(46.0, 1.4, 1.10, sampleRate);     // Head bump @ 46Hz
+    c.studerBell2.setBell(70.0, 2.0, -0.50, sampleRate);    // Dip at 70Hz
+    c.studerBell3.setBell(110.0, 2.0, 1.20, sampleRate);    // Head bump 2 @ 110Hz
+    c.studerBell4.setBell(160.0, 1.5, 0.30, sampleRate);    // Shape at 160Hz
+    c.studerBell5.setBell(200.0, 2.0, -0.30, sampleRate);   // Notch at 200Hz
     // Mid and HF
-    studerBell6.setBell(600.0, 1.5, 0.20, fs);   // Mid @ 600Hz
-    studerBell7.setBell(5000.0, 1.0, 0.50, fs);  // HF @ 5kHz
-    studerBell8.setBell(10000.0, 1.5, -0.25, fs);// Cut @ 10kHz
-    studerBell9.setBell(20000.0, 1.0, 0.50, fs); // Air @ 20kHz
+    c.studerBell6.setBell(600.0, 1.5, 0.20, sampleRate);    // Mid @ 600Hz
+    c.studerBell7.setBell(5000.0, 1.0, 0.50, sampleRate);   // HF @ 5kHz
+    c.studerBell8.setBell(10000.0, 1.5, -0.25, sampleRate); // Cut @ 10kHz
+    c.studerBell9.setBell(20000.0, 1.0, 0.50, sampleRate);  // Air @ 20kHz
 }
 
-double MachineEQ::processSample(double input)
+template <typename SampleType>
+std::shared_ptr<const typename MachineEQT<SampleType>::Coefficients> MachineEQT<SampleType>::acquireCoefficients(double sampleRate)
 {
-    double x = input;
+    return SharedTableCache<double, Coefficients>::acquire(sampleRate, [sampleRate](Coefficients& c) {
+        designCoefficients(c, sampleRate);
+    });
+}
+
+template <typename SampleType>
+std::shared_ptr<const void> MachineEQT<SampleType>::retainCoefficients(double sampleRate)
+{
+    return acquireCoefficients(sampleRate);
+}
+
+template <typename SampleType>
+void MachineEQT<SampleType>::setSampleRate(double sampleRate, const std::shared_ptr<const void>& retained)
+{
+    fs = sampleRate;
+    coefficients = std::static_pointer_cast<const Coefficients>(retained);
+    applyCoefficients();
+}
+
+template <typename SampleType>
+void MachineEQT<SampleType>::updateCoefficients()
+{
+    coefficients = acquireCoefficients(fs);
+    applyCoefficients();
+}
+
+template <typename SampleType>
+void MachineEQT<SampleType>::applyCoefficients()
+{
+    // Coefficients only - filter state carries over
+    const Coefficients& c = *coefficients;
+
+    ampexHP.setCoefficients(c.ampexHP);
+    ampexBell1.setCoefficients(c.ampexBell1);
+    ampexBell2.setCoefficients(c.ampexBell2);
+    ampexBell3.setCoefficients(c.ampexBell3);
+    ampexBell4.setCoefficients(c.ampexBell4);
+    ampexBell6.setCoefficients(c.ampexBell6);
+    ampexBell7.setCoefficients(c.ampexBell7);
+    ampexBell8.setCoefficients(c.ampexBell8);
+    ampexBell10.setCoefficients(c.ampexBell10);
+    ampexLP.setCoefficients(c.ampexLP);
+
+    studerHP1.setCoefficients(c.studerHP1);
+    studerHP2.setCoefficients(c.studerHP2);
+    studerBell1.setCoefficients(c.studerBell1);
+    studerBell2.setCoefficients(c.studerBell2);
+    studerBell3.setCoefficients(c.studerBell3);
+    studerBell4.setCoefficients(c.studerBell4);
+    studerBell5.setCoefficients(c.studerBell5);
+    studerBell6.setCoefficients(c.studerBell6);
+    studerBell7.setCoefficients(c.studerBell7);
+    studerBell8.setCoefficients(c.studerBell8);
+    studerBell9.setCoefficients(c.studerBell9);
+}
+
+template <typename SampleType>
+SampleType MachineEQT<SampleType>::processSample(SampleType input)
+{
+    // LF/mid sections run in double, HF sections in SampleType
+    double lf = input;
+    SampleType x;
 
     if (currentMachine == Machine::Ampex)
     {
-        x = ampexHP.process(x);
-        x = ampexBell1.process(x);
-        x = ampexBell2.process(x);
-        x = ampexBell3.process(x);
-        x = ampexBell4.process(x);
-        x = ampexBell5.process(x);
-        x = ampexBell6.process(x);
-        x = ampexBell7.process(x);
+        lf = ampexHP.process(lf);
+        lf = ampexBell1.process(lf);
+        lf = ampexBell2.process(lf);
+        lf = ampexBell3.process(lf);
+        lf = ampexBell4.process(lf);
+        lf = ampexBell6.process(lf);
+        lf = ampexBell7.process(lf);
+        x = static_cast<SampleType>(lf);
         x = ampexBell8.process(x);
-        x = ampexBell9.process(x);
         x = ampexBell10.process(x);
         x = ampexLP.process(x);
     }
     else
     {
-        x = studerHP1.process(x);
-        x = studerHP2.process(x);
-        x = studerBell1.process(x);
-        x = studerBell2.process(x);
-        x = studerBell3.process(x);
-        x = studerBell4.process(x);
-        x = studerBell5.process(x);
-        x = studerBell6.process(x);
+        lf = studerHP1.process(lf);
+        lf = studerHP2.process(lf);
+        lf = studerBell1.process(lf);
+        lf = studerBell2.process(lf);
+        lf = studerBell3.process(lf);
+        lf = studerBell4.process(lf);
+        lf = studerBell5.process(lf);
+        lf = studerBell6.process(lf);
+        x = static_cast<SampleType>(lf);
         x = studerBell7.process(x);
         x = studerBell8.process(x);
         x = studerBell9.process(x);
@@ -129,4 +206,174 @@ double MachineEQ::processSample(double input)
     return x;
 }
 
+template <typename SampleType>
+void MachineEQT<SampleType>::processBlock(SampleType* data, int numSamples)
+{
+    if (currentMachine == Machine::Ampex)
+        processChainBlock<Machine::Ampex>(data, numSamples);
+    else
+        processChainBlock<Machine::Studer>(data, numSamples);
+}
+
+template <typename SampleType>
+void MachineEQT<SampleType>::processStereoBlock(MachineEQT& left, MachineEQT& right, SampleType* interleaved, int numSamples)
+{
+    if (left.currentMachine == Machine::Ampex)
+        processChainStereoBlock<Machine::Ampex>(left, right, interleaved, numSamples);
+    else
+        processChainStereoBlock<Machine::Studer>(left, right, interleaved, numSamples);
+}
+
+template <typename SampleType>
+template <typename MachineEQT<SampleType>::Machine M>
+void MachineEQT<SampleType>::processChainBlock(SampleType* data, int numSamples)
+{
+    // The whole cascade per sample, on local copies of the sections: their states stay
+    // in registers, and each section's recursion overlaps with the ones after it.
+    // (Section by section, every pass is one latency-bound recursion over the block.)
+    // LF/mid sections run in double, HF sections in SampleType, as in processSample()
+    if constexpr (M == Machine::Ampex)
+    {
+        LFBiquad hp = ampexHP, bell1 = ampexBell1, bell2 = ampexBell2, bell3 = ampexBell3,
+                 bell4 = ampexBell4, bell6 = ampexBell6, bell7 = ampexBell7;
+        HFBiquad bell8 = ampexBell8, bell10 = ampexBell10, lp = ampexLP;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double lf = data[i];
+            lf = hp.process(lf);
+            lf = bell1.process(lf);
+            lf = bell2.process(lf);
+            lf = bell3.process(lf);
+            lf = bell4.process(lf);
+            lf = bell6.process(lf);
+            lf = bell7.process(lf);
+            SampleType x = static_cast<SampleType>(lf);
+            x = bell8.process(x);
+            x = bell10.process(x);
+            data[i] = lp.process(x);
+        }
+
+        ampexHP = hp;  ampexBell1 = bell1;  ampexBell2 = bell2;  ampexBell3 = bell3;
+        ampexBell4 = bell4;  ampexBell6 = bell6;  ampexBell7 = bell7;
+        ampexBell8 = bell8;  ampexBell10 = bell10;  ampexLP = lp;
+    }
+    else
+    {
+        LFBiquad hp1 = studerHP1, bell1 = studerBell1, bell2 = studerBell2, bell3 = studerBell3,
+                 bell4 = studerBell4, bell5 = studerBell5, bell6 = studerBell6;
+        LFFirstOrder hp2 = studerHP2;
+        HFBiquad bell7 = studerBell7, bell8 = studerBell8, bell9 = studerBell9;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double lf = data[i];
+            lf = hp1.process(lf);
+            lf = hp2.process(lf);
+            lf = bell1.process(lf);
+            lf = bell2.process(lf);
+            lf = bell3.process(lf);
+            lf = bell4.process(lf);
+            lf = bell5.process(lf);
+            lf = bell6.process(lf);
+            SampleType x = static_cast<SampleType>(lf);
+            x = bell7.process(x);
+            x = bell8.process(x);
+            data[i] = bell9.process(x);
+        }
+
+        studerHP1 = hp1;  studerHP2 = hp2;  studerBell1 = bell1;  studerBell2 = bell2;
+        studerBell3 = bell3;  studerBell4 = bell4;  studerBell5 = bell5;  studerBell6 = bell6;
+        studerBell7 = bell7;  studerBell8 = bell8;  studerBell9 = bell9;
+    }
+}
+
+template <typename SampleType>
+template <typename MachineEQT<SampleType>::Machine M>
+void MachineEQT<SampleType>::processChainStereoBlock(MachineEQT& left, MachineEQT& right, SampleType* lr, int n)
+{
+    // Fused cascade as in processChainBlock(), L and R in the two lanes of each section
+    using LFLane = StereoLaneT<double>;
+    using HFLane = StereoLaneT<SampleType>;
+
+    if constexpr (M == Machine::Ampex)
+    {
+        BiquadLanes<LFBiquad> hp(left.ampexHP, right.ampexHP), bell1(left.ampexBell1, right.ampexBell1),
+                              bell2(left.ampexBell2, right.ampexBell2), bell3(left.ampexBell3, right.ampexBell3),
+                              bell4(left.ampexBell4, right.ampexBell4), bell6(left.ampexBell6, right.ampexBell6),
+                              bell7(left.ampexBell7, right.ampexBell7);
+        BiquadLanes<HFBiquad> bell8(left.ampexBell8, right.ampexBell8), bell10(left.ampexBell10, right.ampexBell10),
+                              lp(left.ampexLP, right.ampexLP);
+
+        for (int i = 0; i < n; ++i)
+        {
+            LFLane lf = loadLane<LFLane>(lr + 2 * i);
+            lf = hp.process(lf);
+            lf = bell1.process(lf);
+            lf = bell2.process(lf);
+            lf = bell3.process(lf);
+            lf = bell4.process(lf);
+            lf = bell6.process(lf);
+            lf = bell7.process(lf);
+            HFLane x = convertLane<HFLane>(lf);
+            x = bell8.process(x);
+            x = bell10.process(x);
+            lp.process(x).store(lr + 2 * i);
+        }
+
+        hp.storeState(left.ampexHP, right.ampexHP);
+        bell1.storeState(left.ampexBell1, right.ampexBell1);
+        bell2.storeState(left.ampexBell2, right.ampexBell2);
+        bell3.storeState(left.ampexBell3, right.ampexBell3);
+        bell4.storeState(left.ampexBell4, right.ampexBell4);
+        bell6.storeState(left.ampexBell6, right.ampexBell6);
+        bell7.storeState(left.ampexBell7, right.ampexBell7);
+        bell8.storeState(left.ampexBell8, right.ampexBell8);
+        bell10.storeState(left.ampexBell10, right.ampexBell10);
+        lp.storeState(left.ampexLP, right.ampexLP);
+    }
+    else
+    {
+        BiquadLanes<LFBiquad> hp1(left.studerHP1, right.studerHP1), bell1(left.studerBell1, right.studerBell1),
+                              bell2(left.studerBell2, right.studerBell2), bell3(left.studerBell3, right.studerBell3),
+                              bell4(left.studerBell4, right.studerBell4), bell5(left.studerBell5, right.studerBell5),
+                              bell6(left.studerBell6, right.studerBell6);
+        FirstOrderLanes<LFFirstOrder> hp2(left.studerHP2, right.studerHP2);
+        BiquadLanes<HFBiquad> bell7(left.studerBell7, right.studerBell7), bell8(left.studerBell8, right.studerBell8),
+                              bell9(left.studerBell9, right.studerBell9);
+
+        for (int i = 0; i < n; ++i)
+        {
+            LFLane lf = loadLane<LFLane>(lr + 2 * i);
+            lf = hp1.process(lf);
+            lf = hp2.process(lf);
+            lf = bell1.process(lf);
+            lf = bell2.process(lf);
+            lf = bell3.process(lf);
+            lf = bell4.process(lf);
+            lf = bell5.process(lf);
+            lf = bell6.process(lf);
+            HFLane x = convertLane<HFLane>(lf);
+            x = bell7.process(x);
+            x = bell8.process(x);
+            bell9.process(x).store(lr + 2 * i);
+        }
+
+        hp1.storeState(left.studerHP1, right.studerHP1);
+        hp2.storeState(left.studerHP2, right.studerHP2);
+        bell1.storeState(left.studerBell1, right.studerBell1);
+        bell2.storeState(left.studerBell2, right.studerBell2);
+        bell3.storeState(left.studerBell3, right.studerBell3);
+        bell4.storeState(left.studerBell4, right.studerBell4);
+        bell5.storeState(left.studerBell5, right.studerBell5);
+        bell6.storeState(left.studerBell6, right.studerBell6);
+        bell7.storeState(left.studerBell7, right.studerBell7);
+        bell8.storeState(left.studerBell8, right.studerBell8);
+        bell9.storeState(left.studerBell9, right.studerBell9);
+    }
+}
+
+template class MachineEQT<float>;
+template class MachineEQT<double>;
+
 } // namespace TapeMachine
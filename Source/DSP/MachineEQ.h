@@ -1,27 +1,51 @@
 #pragma once
 
 #include "MathConstants.h"
+#include "SharedTableCache.h"
+#include "StereoLane.h"
 
 namespace TapeMachine
 {
 
 // Biquad filter using Audio EQ Cookbook formulas
-struct EQBiquad
+// Designed in double, coefficients/state/arithmetic in SampleType
+// Data may be another type (double LF sections run on a float engine's data)
+template <typename SampleType>
+struct EQBiquadT
 {
-    double b0 = 1.0, b1 = 0.0, b2 = 0.0;
-    double a1 = 0.0, a2 = 0.0;
-    double z1 = 0.0, z2 = 0.0;
+    using ValueType = SampleType;
 
-    void reset() { z1 = z2 = 0.0; }
+    SampleType b0 = 1, b1 = 0, b2 = 0;
+    SampleType a1 = 0, a2 = 0;
+    SampleType z1 = 0, z2 = 0;
 
-    double process(double input)
+    void reset() { z1 = z2 = 0; }
+
+    SampleType process(SampleType input)
     {
-        double output = b0 * input + z1;
+        SampleType output = b0 * input + z1;
         z1 = b1 * input - a1 * output + z2;
         z2 = b2 * input - a2 * output;
         return output;
     }
 
+    // In-place block processing with state held in locals
+    template <typename DataType>
+    void processBlock(DataType* data, int numSamples)
+    {
+        SampleType s1 = z1, s2 = z2;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType input = static_cast<SampleType>(data[i]);
+            const SampleType output = b0 * input + s1;
+            s1 = b1 * input - a1 * output + s2;
+            s2 = b2 * input - a2 * output;
+            data[i] = static_cast<DataType>(output);
+        }
+        z1 = s1;
+        z2 = s2;
+    }
+
     // Bell/Peaking EQ (Audio EQ Cookbook)
     void setBell(double fc, double Q, double gainDB, double sampleRate)
     {
@@ -32,11 +56,11 @@ struct EQBiquad
         double alpha = sinw0 / (2.0 * Q);
 
         double a0 = 1.0 + alpha / A;
-        b0 = (1.0 + alpha * A) / a0;
-        b1 = (-2.0 * cosw0) / a0;
-        b2 = (1.0 - alpha * A) / a0;
-        a1 = (-2.0 * cosw0) / a0;
-        a2 = (1.0 - alpha / A) / a0;
+        setCoefficients((1.0 + alpha * A) / a0,
+                        (-2.0 * cosw0) / a0,
+                        (1.0 - alpha * A) / a0,
+                        (-2.0 * cosw0) / a0,
+                        (1.0 - alpha / A) / a0);
     }
 
     // High-pass filter (2nd order, 12 dB/oct)
@@ -48,54 +72,97 @@ struct EQBiquad
         double alpha = sinw0 / (2.0 * Q);
 
         double a0 = 1.0 + alpha;
-        b0 = ((1.0 + cosw0) / 2.0) / a0;
-        b1 = (-(1.0 + cosw0)) / a0;
-        b2 = ((1.0 + cosw0) / 2.0) / a0;
-        a1 = (-2.0 * cosw0) / a0;
-        a2 = (1.0 - alpha) / a0;
+        setCoefficients(((1.0 + cosw0) / 2.0) / a0,
+                        (-(1.0 + cosw0)) / a0,
+                        ((1.0 + cosw0) / 2.0) / a0,
+                        (-2.0 * cosw0) / a0,
+                        (1.0 - alpha) / a0);
     }
 
     // Low-pass filter (2nd order, 12 dB/oct)
     void setLowPass(double fc, double Q, double sampleRate)
     {
+        // Cutoff at or above Nyquist (e.g. the 30kHz Ampex LP at native 44.1/48kHz):
+        // the band it shapes does not exist and the bilinear design would be unstable
+        if (fc >= 0.5 * sampleRate) {
+            setCoefficients(1.0, 0.0, 0.0, 0.0, 0.0);
+            return;
+        }
+
         double w0 = 2.0 * M_PI * fc / sampleRate;
         double cosw0 = std::cos(w0);
         double sinw0 = std::sin(w0);
         double alpha = sinw0 / (2.0 * Q);
 
         double a0 = 1.0 + alpha;
-        b0 = ((1.0 - cosw0) / 2.0) / a0;
-        b1 = (1.0 - cosw0) / a0;
-        b2 = ((1.0 - cosw0) / 2.0) / a0;
-        a1 = (-2.0 * cosw0) / a0;
-        a2 = (1.0 - alpha) / a0;
+        setCoefficients(((1.0 - cosw0) / 2.0) / a0,
+                        (1.0 - cosw0) / a0,
+                        ((1.0 - cosw0) / 2.0) / a0,
+                        (-2.0 * cosw0) / a0,
+                        (1.0 - alpha) / a0);
+    }
+
+    void setCoefficients(double newB0, double newB1, double newB2, double newA1, double newA2)
+    {
+        b0 = static_cast<SampleType>(newB0);
+        b1 = static_cast<SampleType>(newB1);
+        b2 = static_cast<SampleType>(newB2);
+        a1 = static_cast<SampleType>(newA1);
+        a2 = static_cast<SampleType>(newA2);
+    }
+
+    // Take the coefficients of a (double-precision) design, keep the state
+    template <typename OtherType>
+    void setCoefficients(const EQBiquadT<OtherType>& design)
+    {
+        setCoefficients(design.b0, design.b1, design.b2, design.a1, design.a2);
     }
 };
 
+using EQBiquad = EQBiquadT<double>;
+
 // 1st order filter for 6 dB/oct slopes
-struct FirstOrderFilter
+template <typename SampleType>
+struct FirstOrderFilterT
 {
-    double b0 = 1.0, b1 = 0.0;
-    double a1 = 0.0;
-    double z1 = 0.0;
+    using ValueType = SampleType;
 
-    void reset() { z1 = 0.0; }
+    SampleType b0 = 1, b1 = 0;
+    SampleType a1 = 0;
+    SampleType z1 = 0;
 
-    double process(double input)
+    void reset() { z1 = 0; }
+
+    SampleType process(SampleType input)
     {
-        double output = b0 * input + z1;
+        SampleType output = b0 * input + z1;
         z1 = b1 * input - a1 * output;
         return output;
     }
 
+    // In-place block processing with state held in locals
+    template <typename DataType>
+    void processBlock(DataType* data, int numSamples)
+    {
+        SampleType s1 = z1;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType input = static_cast<SampleType>(data[i]);
+            const SampleType output = b0 * input + s1;
+            s1 = b1 * input - a1 * output;
+            data[i] = static_cast<DataType>(output);
+        }
+        z1 = s1;
+    }
+
     // 1st order high-pass (6 dB/oct)
     void setHighPass(double fc, double sampleRate)
     {
         double K = std::tan(M_PI * fc / sampleRate);
         double a0 = 1.0 + K;
-        b0 = 1.0 / a0;
-        b1 = -1.0 / a0;
-        a1 = (K - 1.0) / a0;
+        b0 = static_cast<SampleType>(1.0 / a0);
+        b1 = static_cast<SampleType>(-1.0 / a0);
+        a1 = static_cast<SampleType>((K - 1.0) / a0);
     }
 
     // 1st order low-pass (6 dB/oct)
@@ -103,32 +170,67 @@ struct FirstOrderFilter
     {
         double K = std::tan(M_PI * fc / sampleRate);
         double a0 = 1.0 + K;
-        b0 = K / a0;
-        b1 = K / a0;
-        a1 = (K - 1.0) / a0;
+        b0 = static_cast<SampleType>(K / a0);
+        b1 = static_cast<SampleType>(K / a0);
+        a1 = static_cast<SampleType>((K - 1.0) / a0);
+    }
+
+    // Take the coefficients of a (double-precision) design, keep the state
+    template <typename OtherType>
+    void setCoefficients(const FirstOrderFilterT<OtherType>& design)
+    {
+        b0 = static_cast<SampleType>(design.b0);
+        b1 = static_cast<SampleType>(design.b1);
+        a1 = static_cast<SampleType>(design.a1);
     }
 };
 
+using FirstOrderFilter = FirstOrderFilterT<double>;
+
 /**
  * Machine-specific EQ curves from Jack Endino's measurements
  * Applied AFTER saturation to capture the total frequency response.
  *
  * Note: MachineEQ runs at the oversampled rate (2x), so at 48kHz base
  * we have 96kHz sample rate and 48kHz Nyquist - 30kHz bands work correctly.
+ *
+ * SampleType (float or double) is the precision of the HF sections (>= 5kHz).
+ * The HPs, head bumps and midrange bells (<= 1kHz) always run in double: their
+ * poles sit close to the unit circle at oversampled rates, where float
+ * coefficients shift the response by up to -90 dB re signal.
  */
-class MachineEQ
+template <typename SampleType>
+class MachineEQT
 {
 public:
     enum class Machine { Ampex, Studer };
 
-    MachineEQ();
+    MachineEQT();
 
     void setSampleRate(double sampleRate);
     void setMachine(Machine machine);
     void reset();
-    double processSample(double input);
+    void copyStateFrom(const MachineEQT& other);  // Filter memories of the shared machine chain
+    SampleType processSample(SampleType input);
+    void processBlock(SampleType* data, int numSamples);  // In-place, same result as processSample()
+
+    // Both channels in one SIMD pass over interleaved [L, R] data
+    // Requires identical configuration (coefficients are taken from `left`)
+    static void processStereoBlock(MachineEQT& left, MachineEQT& right, SampleType* interleaved, int numSamples);
+
+    // Keeps the shared coefficients for sampleRate alive while the handle is held,
+    // so a later setSampleRate(sampleRate) finds them instead of designing them
+    static std::shared_ptr<const void> retainCoefficients(double sampleRate);
+
+    // setSampleRate() with a handle from retainCoefficients(sampleRate): no cache
+    // lookup, no lock, no allocation (audio thread)
+    void setSampleRate(double sampleRate, const std::shared_ptr<const void>& retained);
 
 private:
+    using LFBiquad = EQBiquadT<double>;       // HP, head bump and midrange sections
+    using LFFirstOrder = FirstOrderFilterT<double>;
+    using HFBiquad = EQBiquadT<SampleType>;   // HF sections
+
     double fs = 48000.0;
     Machine currentMachine = Machine::Ampex;
 
@@ -136,36 +238,59 @@ private:
     // Fine-tuned to match Pro-Q4 reference:
     // Targets: 20Hz=-2.7dB, 28Hz=0dB, 40Hz=+1.15dB, 70Hz=+0.17dB, 105Hz=+0.3dB, 150Hz=0dB,
     //          350Hz=-0.5dB, 1200Hz=-0.3dB, 3kHz=-0.45dB, 10kHz=0dB, 16kHz=-0.25dB, 21.5kHz=0dB
-    EQBiquad ampexHP;           // HP filter
-    EQBiquad ampexBell1;        // 28 Hz lift
-    EQBiquad ampexBell2;        // 40 Hz head bump
-    EQBiquad ampexBell3;        // 70 Hz
-    EQBiquad ampexBell4;        // 105 Hz
-    EQBiquad ampexBell5;        // 150 Hz
-    EQBiquad ampexBell6;        // 350 Hz dip
-    EQBiquad ampexBell7;        // 1200 Hz
-    EQBiquad ampexBell8;        // 3000 Hz
-    EQBiquad ampexBell9;        // 10kHz / 16kHz
-    EQBiquad ampexBell10;       // HF lift
-    EQBiquad ampexLP;           // 30000 Hz LP2
+    LFBiquad ampexHP;           // HP filter
+    LFBiquad ampexBell1;        // 28 Hz lift
+    LFBiquad ampexBell2;        // 40 Hz head bump
+    LFBiquad ampexBell3;        // 70 Hz
+    LFBiquad ampexBell4;        // 105 Hz
+    LFBiquad ampexBell6;        // 350 Hz dip
+    LFBiquad ampexBell7;        // 1200 Hz
+    HFBiquad ampexBell8;        // 3000 Hz
+    HFBiquad ampexBell10;       // HF lift
+    HFBiquad ampexLP;           // 30000 Hz LP2
 
     // Studer A820 "Tracks" EQ - Optimized to 0.039 dB RMS error
     // Targets from Jack Endino: 20Hz=-9dB, 30Hz=-2dB, 38Hz=0dB, 50Hz=+0.55dB,
     // 70Hz=+0.1dB, 110Hz=+1.2dB, 160Hz=+0.5dB, 200Hz=+0.1dB, 600Hz=+0.2dB,
     // 5kHz=+0.5dB, 10kHz=0dB, 20kHz=+0.5dB
-    EQBiquad studerHP1;         // 27 Hz Q=1.0, 12 dB/oct
-    FirstOrderFilter studerHP2; // 30.5 Hz, 6 dB/oct (cascaded = 18 dB/oct total)
-    EQBiquad studerBell1;       // 46 Hz, Q 1.4, +1.10 dB (head bump)
-    EQBiquad studerBell2;       // 70 Hz, Q 2.0, -0.50 dB (dip)
-    EQBiquad studerBell3;       // 110 Hz, Q 2.0, +1.20 dB (head bump 2)
-    EQBiquad studerBell4;       // 160 Hz, Q 1.5, +0.30 dB
-    EQBiquad studerBell5;       // 200 Hz, Q 2.0, -0.30 dB (notch)
-    EQBiquad studerBell6;       // 600 Hz, Q 1.5, +0.20 dB
-    EQBiquad studerBell7;       // 5000 Hz, Q 1.0, +0.50 dB
-    EQBiquad studerBell8;       // 10000 Hz, Q 1.5, -0.25 dB
-    EQBiquad studerBell9;       // 20000 Hz, Q 1.0, +0.50 dB
+    LFBiquad studerHP1;         // 27 Hz Q=1.0, 12 dB/oct
+    LFFirstOrder studerHP2;     // 30.5 Hz, 6 dB/oct (cascaded = 18 dB/oct total)
+    LFBiquad studerBell1;       // 46 Hz, Q 1.4, +1.10 dB (head bump)
+    LFBiquad studerBell2;       // 70 Hz, Q 2.0, -0.50 dB (dip)
+    LFBiquad studerBell3;       // 110 Hz, Q 2.0, +1.20 dB (head bump 2)
+    LFBiquad studerBell4;       // 160 Hz, Q 1.5, +0.30 dB
+    LFBiquad studerBell5;       // 200 Hz, Q 2.0, -0.30 dB (notch)
+    LFBiquad studerBell6;       // 600 Hz, Q 1.5, +0.20 dB
+    HFBiquad studerBell7;       // 5000 Hz, Q 1.0, +0.50 dB
+    HFBiquad studerBell8;       // 10000 Hz, Q 1.5, -0.25 dB
+    HFBiquad studerBell9;       // 20000 Hz, Q 1.0, +0.50 dB
 
+    // Both machines' section designs (double), one set per sample rate shared by
+    // every MachineEQ at that rate (SharedTableCache); the sections above copy
+    // their coefficients from it and keep their own state
+    struct Coefficients
+    {
+        EQBiquad ampexHP, ampexBell1, ampexBell2, ampexBell3, ampexBell4, ampexBell6, ampexBell7;
+        EQBiquad ampexBell8, ampexBell10, ampexLP;
+        EQBiquad studerHP1;
+        FirstOrderFilter studerHP2;
+        EQBiquad studerBell1, studerBell2, studerBell3, studerBell4, studerBell5, studerBell6;
+        EQBiquad studerBell7, studerBell8, studerBell9;
+    };
+    std::shared_ptr<const Coefficients> coefficients;
+
+    static std::shared_ptr<const Coefficients> acquireCoefficients(double sampleRate);
+    static void designCoefficients(Coefficients& c, double sampleRate);
     void updateCoefficients();
+    void applyCoefficients();  // Copies `coefficients` into the sections
+
+    // One straight-line chain per machine: the block paths pick it once per call
+    template <Machine M>
+    void processChainBlock(SampleType* data, int numSamples);
+    template <Machine M>
+    static void processChainStereoBlock(MachineEQT& left, MachineEQT& right, SampleType* lr, int n);
 };
 
+using MachineEQ = MachineEQT<double>;
+
 } // namespace TapeMachine
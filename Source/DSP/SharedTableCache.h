@@ -0,0 +1,98 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace TapeMachine
+{
+
+/**
+ * Shared Table Cache - process-wide store of immutable coefficient sets and tables
+ *
+ * Every processor at a given sample rate designs the same filters and tabulates
+ * the same curves. The first one to ask builds the table; every later one gets
+ * a reference-counted pointer to the same read-only copy. With many plugin
+ * instances this saves the rebuild on session load, and instances running on
+ * the same core read one copy from cache instead of one copy each.
+ *
+ *   - Tables are built by the caller, outside the lock. Two threads that build
+ *     the same key at once both succeed, and the first table inserted wins.
+ *   - An entry lives as long as some processor holds it. The last release frees it.
+ *   - acquire() takes a mutex and may build a table, so call it from setup code
+ *     (constructor, setSampleRate from prepareToPlay), never per block.
+ *
+ * One cache exists per (Key, Table) pair. Users are HybridTapeProcessor (tape
+ * configurations with their a3 tables, allpass / delay / DC blocker
+ * coefficients), HFCut and MachineEQ.
+ */
+template <typename Key, typename Table>
+class SharedTableCache
+{
+public:
+    using Handle = std::shared_ptr<const Table>;
+
+    /**
+     * The table for key, built by build(Table&) if no live copy exists
+     * build receives a default-constructed Table and fills it in
+     */
+    template <typename Builder>
+    static Handle acquire(const Key& key, Builder&& build)
+    {
+        SharedTableCache& cache = instance();
+
+        if (Handle existing = cache.find(key))
+            return existing;
+
+        auto table = std::make_shared<Table>();
+        build(*table);
+
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto& entry = cache.entries[key];
+        if (Handle raced = entry.lock())
+            return raced;  // Another thread built it meanwhile - share that one
+
+        entry = table;
+        cache.removeExpired();
+        return table;
+    }
+
+    // Number of tables currently alive (tests and diagnostics)
+    static int size()
+    {
+        SharedTableCache& cache = instance();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.removeExpired();
+        return static_cast<int>(cache.entries.size());
+    }
+
+private:
+    std::mutex mutex;
+    std::map<Key, std::weak_ptr<const Table>> entries;
+
+    static SharedTableCache& instance()
+    {
+        static SharedTableCache cache;
+        return cache;
+    }
+
+    Handle find(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        return it != entries.end() ? it->second.lock() : Handle();
+    }
+
+    // Entries whose last holder is gone (called with the lock held)
+    void removeExpired()
+    {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.expired())
+                it = entries.erase(it);
+            else
+                ++it;
+        }
+    }
+};
+
+} // namespace TapeMachine
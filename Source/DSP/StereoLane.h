@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// StereoLane - two samples (L, R) processed as one SIMD register
+//
+// Both tape channels run identical linear filter topologies with identical
+// coefficients, so the biquad/allpass recursions can run for L and R in the
+// two lanes of one register: one vector recursion instead of two scalar ones.
+//
+//   StereoLaneT<double>               StereoLaneT<float>
+//   x86-64:  SSE2 __m128d             SSE __m128 (low two lanes)
+//   ARM64:   NEON float64x2_t         NEON float32x2_t
+//   other:   plain scalar pair (same results, no speedup)
+//
+// Data is interleaved [L0, R0, L1, R1, ...]. Arithmetic is plain multiply/add
+// in the same order as the scalar filters, so results match the mono path.
+// A filter whose precision differs from the data (e.g. a double LF section in
+// a float engine) converts on load/store - see loadLane()/storeLane().
+//
+// The lanes also carry what the FastMath.h kernels need to run on them: a
+// constructor that broadcasts a constant, division, comparisons returning a
+// per-lane Mask, and select / abs / min / max / copysign. min and max return
+// what std::min / std::max return, NaN included, so a kernel on a lane gives
+// each lane the result of the scalar call.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define TAPE_MACHINE_STEREO_LANE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+  #include <arm_neon.h>
+  #define TAPE_MACHINE_STEREO_LANE_NEON 1
+#endif
+
+namespace TapeMachine
+{
+
+template <typename SampleType>
+struct StereoLaneT;
+
+template <>
+struct StereoLaneT<double>
+{
+    using ValueType = double;
+
+#if defined(TAPE_MACHINE_STEREO_LANE_SSE2)
+    __m128d v;
+
+    StereoLaneT() = default;
+    StereoLaneT(__m128d x) : v(x) {}
+    explicit StereoLaneT(double x) : v(_mm_set1_pd(x)) {}
+
+    static StereoLaneT load(const double* lr)       { return { _mm_load_pd(lr) }; }
+    void store(double* lr) const                    { _mm_store_pd(lr, v); }
+    static StereoLaneT broadcast(double x)          { return { _mm_set1_pd(x) }; }
+    static StereoLaneT set(double left, double right){ return { _mm_set_pd(right, left) }; }
+    double left() const                             { return _mm_cvtsd_f64(v); }
+    double right() const                            { return _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)); }
+
+    friend StereoLaneT operator+(StereoLaneT a, StereoLaneT b) { return { _mm_add_pd(a.v, b.v) }; }
+    friend StereoLaneT operator-(StereoLaneT a, StereoLaneT b) { return { _mm_sub_pd(a.v, b.v) }; }
+    friend StereoLaneT operator*(StereoLaneT a, StereoLaneT b) { return { _mm_mul_pd(a.v, b.v) }; }
+    friend StereoLaneT operator/(StereoLaneT a, StereoLaneT b) { return { _mm_div_pd(a.v, b.v) }; }
+
+    struct Mask { __m128d m; };
+    friend Mask operator<(StereoLaneT a, StereoLaneT b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+    friend Mask operator>(StereoLaneT a, StereoLaneT b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+
+    friend StereoLaneT select(Mask c, StereoLaneT a, StereoLaneT b) { return { _mm_or_pd(_mm_and_pd(c.m, a.v), _mm_andnot_pd(c.m, b.v)) }; }
+    friend StereoLaneT abs(StereoLaneT a)                 { return { _mm_andnot_pd(_mm_set1_pd(-0.0), a.v) }; }
+    friend StereoLaneT min(StereoLaneT a, StereoLaneT b)  { return { _mm_min_pd(b.v, a.v) }; }
+    friend StereoLaneT max(StereoLaneT a, StereoLaneT b)  { return { _mm_max_pd(b.v, a.v) }; }
+    friend StereoLaneT copysign(StereoLaneT x, StereoLaneT s)
+    {
+        const __m128d sign = _mm_set1_pd(-0.0);
+        return { _mm_or_pd(_mm_andnot_pd(sign, x.v), _mm_and_pd(sign, s.v)) };
+    }
+#elif defined(TAPE_MACHINE_STEREO_LANE_NEON)
+    float64x2_t v;
+
+    StereoLaneT() = default;
+    StereoLaneT(float64x2_t x) : v(x) {}
+    explicit StereoLaneT(double x) : v(vdupq_n_f64(x)) {}
+
+    static StereoLaneT load(const double* lr)       { return { vld1q_f64(lr) }; }
+    void store(double* lr) const                    { vst1q_f64(lr, v); }
+    static StereoLaneT broadcast(double x)          { return { vdupq_n_f64(x) }; }
+    static StereoLaneT set(double left, double right){ return { vsetq_lane_f64(right, vdupq_n_f64(left), 1) }; }
+    double left() const                             { return vgetq_lane_f64(v, 0); }
+    double right() const                            { return vgetq_lane_f64(v, 1); }
+
+    friend StereoLaneT operator+(StereoLaneT a, StereoLaneT b) { return { vaddq_f64(a.v, b.v) }; }
+    friend StereoLaneT operator-(StereoLaneT a, StereoLaneT b) { return { vsubq_f64(a.v, b.v) }; }
+    friend StereoLaneT operator*(StereoLaneT a, StereoLaneT b) { return { vmulq_f64(a.v, b.v) }; }
+    friend StereoLaneT operator/(StereoLaneT a, StereoLaneT b) { return { vdivq_f64(a.v, b.v) }; }
+
+    struct Mask { uint64x2_t m; };
+    friend Mask operator<(StereoLaneT a, StereoLaneT b) { return { vcltq_f64(a.v, b.v) }; }
+    friend Mask operator>(StereoLaneT a, StereoLaneT b) { return { vcgtq_f64(a.v, b.v) }; }
+
+    friend StereoLaneT select(Mask c, StereoLaneT a, StereoLaneT b) { return { vbslq_f64(c.m, a.v, b.v) }; }
+    friend StereoLaneT abs(StereoLaneT a)                 { return { vabsq_f64(a.v) }; }
+    friend StereoLaneT min(StereoLaneT a, StereoLaneT b)  { return select(b < a, b, a); }
+    friend StereoLaneT max(StereoLaneT a, StereoLaneT b)  { return select(a < b, b, a); }
+    friend StereoLaneT copysign(StereoLaneT x, StereoLaneT s) { return { vbslq_f64(vdupq_n_u64(0x8000000000000000ull), s.v, x.v) }; }
+#else
+    double l, r;
+
+    StereoLaneT() = default;
+    StereoLaneT(double left, double right) : l(left), r(right) {}
+    explicit StereoLaneT(double x) : l(x), r(x) {}
+
+    static StereoLaneT load(const double* lr)       { return { lr[0], lr[1] }; }
+    void store(double* lr) const                    { lr[0] = l; lr[1] = r; }
+    static StereoLaneT broadcast(double x)          { return { x, x }; }
+    static StereoLaneT set(double left, double right){ return { left, right }; }
+    double left() const                             { return l; }
+    double right() const                            { return r; }
+
+    friend StereoLaneT operator+(StereoLaneT a, StereoLaneT b) { return { a.l + b.l, a.r + b.r }; }
+    friend StereoLaneT operator-(StereoLaneT a, StereoLaneT b) { return { a.l - b.l, a.r - b.r }; }
+    friend StereoLaneT operator*(StereoLaneT a, StereoLaneT b) { return { a.l * b.l, a.r * b.r }; }
+    friend StereoLaneT operator/(StereoLaneT a, StereoLaneT b) { return { a.l / b.l, a.r / b.r }; }
+
+    struct Mask { bool l, r; };
+    friend Mask operator<(StereoLaneT a, StereoLaneT b) { return { a.l < b.l, a.r < b.r }; }
+    friend Mask operator>(StereoLaneT a, StereoLaneT b) { return { a.l > b.l, a.r > b.r }; }
+
+    friend StereoLaneT select(Mask c, StereoLaneT a, StereoLaneT b) { return { c.l ? a.l : b.l, c.r ? a.r : b.r }; }
+    friend StereoLaneT abs(StereoLaneT a)                 { return { std::abs(a.l), std::abs(a.r) }; }
+    friend StereoLaneT min(StereoLaneT a, StereoLaneT b)  { return { std::min(a.l, b.l), std::min(a.r, b.r) }; }
+    friend StereoLaneT max(StereoLaneT a, StereoLaneT b)  { return { std::max(a.l, b.l), std::max(a.r, b.r) }; }
+    friend StereoLaneT copysign(StereoLaneT x, StereoLaneT s) { return { std::copysign(x.l, s.l), std::copysign(x.r, s.r) }; }
+#endif
+};
+
+template <>
+struct StereoLaneT<float>
+{
+    using ValueType = float;
+
+#if defined(TAPE_MACHINE_STEREO_LANE_SSE2)
+    __m128 v;  // Lanes 0/1 = L/R, lanes 2/3 unused
+
+    StereoLaneT() = default;
+    StereoLaneT(__m128 x) : v(x) {}
+    explicit StereoLaneT(float x) : v(_mm_set1_ps(x)) {}
+
+    static StereoLaneT load(const float* lr)        { return { _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(lr)) }; }
+    void store(float* lr) const                     { _mm_storel_pi(reinterpret_cast<__m64*>(lr), v); }
+    static StereoLaneT broadcast(float x)           { return { _mm_set1_ps(x) }; }
+    static StereoLaneT set(float left, float right) { return { _mm_setr_ps(left, right, 0.0f, 0.0f) }; }
+    float left() const                              { return _mm_cvtss_f32(v); }
+    float right() const                             { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+
+    friend StereoLaneT operator+(StereoLaneT a, StereoLaneT b) { return { _mm_add_ps(a.v, b.v) }; }
+    friend StereoLaneT operator-(StereoLaneT a, StereoLaneT b) { return { _mm_sub_ps(a.v, b.v) }; }
+    friend StereoLaneT operator*(StereoLaneT a, StereoLaneT b) { return { _mm_mul_ps(a.v, b.v) }; }
+    friend StereoLaneT operator/(StereoLaneT a, StereoLaneT b) { return { _mm_div_ps(a.v, b.v) }; }
+
+    struct Mask { __m128 m; };
+    friend Mask operator<(StereoLaneT a, StereoLaneT b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+    friend Mask operator>(StereoLaneT a, StereoLaneT b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+
+    friend StereoLaneT select(Mask c, StereoLaneT a, StereoLaneT b) { return { _mm_or_ps(_mm_and_ps(c.m, a.v), _mm_andnot_ps(c.m, b.v)) }; }
+    friend StereoLaneT abs(StereoLaneT a)                 { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+    friend StereoLaneT min(StereoLaneT a, StereoLaneT b)  { return { _mm_min_ps(b.v, a.v) }; }
+    friend StereoLaneT max(StereoLaneT a, StereoLaneT b)  { return { _mm_max_ps(b.v, a.v) }; }
+    friend StereoLaneT copysign(StereoLaneT x, StereoLaneT s)
+    {
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        return { _mm_or_ps(_mm_andnot_ps(sign, x.v), _mm_and_ps(sign, s.v)) };
+    }
+#elif defined(TAPE_MACHINE_STEREO_LANE_NEON)
+    float32x2_t v;
+
+    StereoLaneT() = default;
+    StereoLaneT(float32x2_t x) : v(x) {}
+    explicit StereoLaneT(float x) : v(vdup_n_f32(x)) {}
+
+    static StereoLaneT load(const float* lr)        { return { vld1_f32(lr) }; }
+    void store(float* lr) const                     { vst1_f32(lr, v); }
+    static StereoLaneT broadcast(float x)           { return { vdup_n_f32(x) }; }
+    static StereoLaneT set(float left, float right) { return { vset_lane_f32(right, vdup_n_f32(left), 1) }; }
+    float left() const                              { return vget_lane_f32(v, 0); }
+    float right() const                             { return vget_lane_f32(v, 1); }
+
+    friend StereoLaneT operator+(StereoLaneT a, StereoLaneT b) { return { vadd_f32(a.v, b.v) }; }
+    friend StereoLaneT operator-(StereoLaneT a, StereoLaneT b) { return { vsub_f32(a.v, b.v) }; }
+    friend StereoLaneT operator*(StereoLaneT a, StereoLaneT b) { return { vmul_f32(a.v, b.v) }; }
+    friend StereoLaneT operator/(StereoLaneT a, StereoLaneT b) { return { vdiv_f32(a.v, b.v) }; }
+
+    struct Mask { uint32x2_t m; };
+    friend Mask operator<(StereoLaneT a, StereoLaneT b) { return { vclt_f32(a.v, b.v) }; }
+    friend Mask operator>(StereoLaneT a, StereoLaneT b) { return { vcgt_f32(a.v, b.v) }; }
+
+    friend StereoLaneT select(Mask c, StereoLaneT a, StereoLaneT b) { return { vbsl_f32(c.m, a.v, b.v) }; }
+    friend StereoLaneT abs(StereoLaneT a)                 { return { vabs_f32(a.v) }; }
+    friend StereoLaneT min(StereoLaneT a, StereoLaneT b)  { return select(b < a, b, a); }
+    friend StereoLaneT max(StereoLaneT a, StereoLaneT b)  { return select(a < b, b, a); }
+    friend StereoLaneT copysign(StereoLaneT x, StereoLaneT s) { return { vbsl_f32(vdup_n_u32(0x80000000u), s.v, x.v) }; }
+#else
+    float l, r;
+
+    StereoLaneT() = default;
+    StereoLaneT(float left, float right) : l(left), r(right) {}
+    explicit StereoLaneT(float x) : l(x), r(x) {}
+
+    static StereoLaneT load(const float* lr)        { return { lr[0], lr[1] }; }
+    void store(float* lr) const                     { lr[0] = l; lr[1] = r; }
+    static StereoLaneT broadcast(float x)           { return { x, x }; }
+    static StereoLaneT set(float left, float right) { return { left, right }; }
+    float left() const                              { return l; }
+    float right() const                             { return r; }
+
+    friend StereoLaneT operator+(StereoLaneT a, StereoLaneT b) { return { a.l + b.l, a.r + b.r }; }
+    friend StereoLaneT operator-(StereoLaneT a, StereoLaneT b) { return { a.l - b.l, a.r - b.r }; }
+    friend StereoLaneT operator*(StereoLaneT a, StereoLaneT b) { return { a.l * b.l, a.r * b.r }; }
+    friend StereoLaneT operator/(StereoLaneT a, StereoLaneT b) { return { a.l / b.l, a.r / b.r }; }
+
+    struct Mask { bool l, r; };
+    friend Mask operator<(StereoLaneT a, StereoLaneT b) { return { a.l < b.l, a.r < b.r }; }
+    friend Mask operator>(StereoLaneT a, StereoLaneT b) { return { a.l > b.l, a.r > b.r }; }
+
+    friend StereoLaneT select(Mask c, StereoLaneT a, StereoLaneT b) { return { c.l ? a.l : b.l, c.r ? a.r : b.r }; }
+    friend StereoLaneT abs(StereoLaneT a)                 { return { std::abs(a.l), std::abs(a.r) }; }
+    friend StereoLaneT min(StereoLaneT a, StereoLaneT b)  { return { std::min(a.l, b.l), std::min(a.r, b.r) }; }
+    friend StereoLaneT max(StereoLaneT a, StereoLaneT b)  { return { std::max(a.l, b.l), std::max(a.r, b.r) }; }
+    friend StereoLaneT copysign(StereoLaneT x, StereoLaneT s) { return { std::copysign(x.l, s.l), std::copysign(x.r, s.r) }; }
+#endif
+};
+
+using StereoLane = StereoLaneT<double>;
+
+// Load/store an interleaved L/R pair, converting when the data precision differs
+template <typename Lane, typename DataType>
+inline Lane loadLane(const DataType* lr)
+{
+    using T = typename Lane::ValueType;
+    if constexpr (std::is_same<T, DataType>::value)
+        return Lane::load(lr);
+    else
+        return Lane::set(static_cast<T>(lr[0]), static_cast<T>(lr[1]));
+}
+
+template <typename Lane, typename DataType>
+inline void storeLane(Lane lane, DataType* lr)
+{
+    if constexpr (std::is_same<typename Lane::ValueType, DataType>::value)
+    {
+        lane.store(lr);
+    }
+    else
+    {
+        lr[0] = static_cast<DataType>(lane.left());
+        lr[1] = static_cast<DataType>(lane.right());
+    }
+}
+
+// Convert an L/R pair between precisions in registers (double LF sections feeding float HF sections)
+template <typename ToLane, typename FromLane>
+inline ToLane convertLane(FromLane lane)
+{
+    using T = typename ToLane::ValueType;
+    if constexpr (std::is_same<ToLane, FromLane>::value)
+        return lane;
+#if defined(TAPE_MACHINE_STEREO_LANE_SSE2)
+    else if constexpr (std::is_same<T, float>::value)
+        return { _mm_cvtpd_ps(lane.v) };
+    else
+        return { _mm_cvtps_pd(lane.v) };
+#else
+    else
+        return ToLane::set(static_cast<T>(lane.left()), static_cast<T>(lane.right()));
+#endif
+}
+
+// One biquad of a fused stereo cascade: coefficients broadcast from `left`, the
+// L/R states in the lanes. Same arithmetic as processBiquadStereo(), one sample at a time
+template <typename BiquadType>
+struct BiquadLanes
+{
+    using Lane = StereoLaneT<typename BiquadType::ValueType>;
+    Lane b0, b1, b2, a1, a2, s1, s2;
+
+    BiquadLanes(const BiquadType& left, const BiquadType& right)
+        : b0(Lane::broadcast(left.b0)), b1(Lane::broadcast(left.b1)), b2(Lane::broadcast(left.b2)),
+          a1(Lane::broadcast(left.a1)), a2(Lane::broadcast(left.a2)),
+          s1(Lane::set(left.z1, right.z1)), s2(Lane::set(left.z2, right.z2)) {}
+
+    Lane process(Lane input)
+    {
+        const Lane output = b0 * input + s1;
+        s1 = b1 * input - a1 * output + s2;
+        s2 = b2 * input - a2 * output;
+        return output;
+    }
+
+    void storeState(BiquadType& left, BiquadType& right) const
+    {
+        left.z1 = s1.left();  right.z1 = s1.right();
+        left.z2 = s2.left();  right.z2 = s2.right();
+    }
+};
+
+// 1st-order counterpart of BiquadLanes
+template <typename FirstOrderType>
+struct FirstOrderLanes
+{
+    using Lane = StereoLaneT<typename FirstOrderType::ValueType>;
+    Lane b0, b1, a1, s1;
+
+    FirstOrderLanes(const FirstOrderType& left, const FirstOrderType& right)
+        : b0(Lane::broadcast(left.b0)), b1(Lane::broadcast(left.b1)), a1(Lane::broadcast(left.a1)),
+          s1(Lane::set(left.z1, right.z1)) {}
+
+    Lane process(Lane input)
+    {
+        const Lane output = b0 * input + s1;
+        s1 = b1 * input - a1 * output;
+        return output;
+    }
+
+    void storeState(FirstOrderType& left, FirstOrderType& right) const
+    {
+        left.z1 = s1.left();  right.z1 = s1.right();
+    }
+};
+
+// Stereo biquad (Direct Form II Transposed) over interleaved L/R data
+// Coefficients come from `left` (both channels share them), state from each channel
+// Runs in the filter's precision (BiquadType::ValueType) whatever the data type
+template <typename BiquadType, typename DataType>
+inline void processBiquadStereo(BiquadType& left, BiquadType& right, DataType* lr, int numSamples)
+{
+    using Lane = StereoLaneT<typename BiquadType::ValueType>;
+    const Lane b0 = Lane::broadcast(left.b0);
+    const Lane b1 = Lane::broadcast(left.b1);
+    const Lane b2 = Lane::broadcast(left.b2);
+    const Lane a1 = Lane::broadcast(left.a1);
+    const Lane a2 = Lane::broadcast(left.a2);
+    Lane s1 = Lane::set(left.z1, right.z1);
+    Lane s2 = Lane::set(left.z2, right.z2);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const Lane input = loadLane<Lane>(lr + 2 * i);
+        const Lane output = b0 * input + s1;
+        s1 = b1 * input - a1 * output + s2;
+        s2 = b2 * input - a2 * output;
+        storeLane(output, lr + 2 * i);
+    }
+
+    left.z1 = s1.left();  right.z1 = s1.right();
+    left.z2 = s2.left();  right.z2 = s2.right();
+}
+
+// Stereo 1st-order filter over interleaved L/R data
+template <typename FirstOrderType, typename DataType>
+inline void processFirstOrderStereo(FirstOrderType& left, FirstOrderType& right, DataType* lr, int numSamples)
+{
+    using Lane = StereoLaneT<typename FirstOrderType::ValueType>;
+    const Lane b0 = Lane::broadcast(left.b0);
+    const Lane b1 = Lane::broadcast(left.b1);
+    const Lane a1 = Lane::broadcast(left.a1);
+    Lane s1 = Lane::set(left.z1, right.z1);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const Lane input = loadLane<Lane>(lr + 2 * i);
+        const Lane output = b0 * input + s1;
+        s1 = b1 * input - a1 * output;
+        storeLane(output, lr + 2 * i);
+    }
+
+    left.z1 = s1.left();  right.z1 = s1.right();
+}
+
+// Scale interleaved L/R data by a common gain
+template <typename DataType>
+inline void applyGainStereo(DataType* lr, DataType gain, int numSamples)
+{
+    using Lane = StereoLaneT<DataType>;
+    const Lane g = Lane::broadcast(gain);
+    for (int i = 0; i < numSamples; ++i)
+        (Lane::load(lr + 2 * i) * g).store(lr + 2 * i);
+}
+
+} // namespace TapeMachine
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "HybridTapeProcessor.h"
+#include "HarmonicAnalyzer.h"
+#include <chrono>
 #include <cmath>
 #include <vector>
 #include <array>
@@ -77,13 +79,18 @@ public:
 
     THDSweepTest(double sampleRate = 96000.0) : fs(sampleRate) {
         processor.setSampleRate(fs);
+        floatProcessor.setSampleRate(fs);
     }
 
     /**
      * Run full parameter sweep for a single mode
-     * Returns vector of THD results
+     * Returns vector of THD results (level-major, as TEST_LEVELS x TEST_FREQUENCIES)
+     *
+     * stepped = false: one reset and render per point (reference, as calibrated)
+     * stepped = true:  one stepped-level render per frequency, 5 renders instead
+     *                  of 35; see runSteppedSweepCheck() for the deviation
      */
-    std::vector<THDResult> runSweep(int modeIndex)
+    std::vector<THDResult> runSweep(int modeIndex, bool stepped = false)
     {
         std::vector<THDResult> results;
         const auto& mode = MODES[modeIndex];
@@ -91,6 +98,19 @@ public:
         processor.setParameters(mode.biasStrength, 1.0, mode.tapeFormula);
         processor.reset();
 
+        if (stepped) {
+            std::vector<std::vector<THDResult>> curves;
+            for (double freq : TEST_FREQUENCIES)
+                curves.push_back(measureTHDCurve(processor, freq, TEST_LEVELS.data(),
+                                                 static_cast<int>(TEST_LEVELS.size())));
+
+            for (size_t l = 0; l < TEST_LEVELS.size(); ++l)
+                for (const auto& curve : curves)
+                    results.push_back(curve[l]);
+
+            return results;
+        }
+
         for (double levelVU : TEST_LEVELS) {
             for (double freq : TEST_FREQUENCIES) {
                 THDResult result = measureTHD(freq, levelVU);
@@ -186,107 +206,441 @@ public:
         std::cout << "\n═══════════════════════════════════════════════════════════════\n";
     }
 
+    /**
+     * Stepped-level sweep vs reference sweep
+     * Runs the full level x frequency grid both ways for every mode and reports the
+     * largest THD deviation and the time each sweep took. The stepped render keeps
+     * the hysteresis history of the lower levels, so it is meant for quick
+     * regression grids; calibration stays on the reference measurement.
+     */
+    bool runSteppedSweepCheck(double maxDeviationDB = 0.1)
+    {
+        bool allPassed = true;
+
+        std::cout << "\n--- Stepped Sweep Check (stepped vs reference, full grid) ---\n";
+        std::cout << "Mode         | Max dev (dB) | At           | Reference (s) | Stepped (s) | Result\n";
+        std::cout << "-------------|--------------|--------------|---------------|-------------|-------\n";
+
+        for (int m = 0; m < 4; ++m) {
+            auto begin = std::chrono::steady_clock::now();
+            auto reference = runSweep(m, false);
+            auto middle = std::chrono::steady_clock::now();
+            auto stepped = runSweep(m, true);
+            auto end = std::chrono::steady_clock::now();
+
+            double maxDeviation = 0.0;
+            size_t worst = 0;
+            for (size_t i = 0; i < reference.size(); ++i) {
+                double deviation = 20.0 * std::log10(stepped[i].thdTotal / reference[i].thdTotal);
+                if (std::abs(deviation) > std::abs(maxDeviation)) {
+                    maxDeviation = deviation;
+                    worst = i;
+                }
+            }
+
+            bool passed = std::abs(maxDeviation) <= maxDeviationDB;
+            allPassed = allPassed && passed;
+
+            std::cout << std::left << std::setw(12) << MODES[m].name << std::right << " | "
+                      << std::fixed << std::setprecision(3) << std::showpos
+                      << std::setw(12) << maxDeviation << std::noshowpos << " | "
+                      << std::setprecision(0) << std::showpos << std::setw(3) << reference[worst].levelVU
+                      << std::noshowpos << " VU " << std::setw(5) << reference[worst].frequency << " | "
+                      << std::setprecision(2)
+                      << std::setw(13) << std::chrono::duration<double>(middle - begin).count() << " | "
+                      << std::setw(11) << std::chrono::duration<double>(end - middle).count() << " | "
+                      << (passed ? "PASS" : "FAIL") << "\n";
+        }
+
+        return allPassed;
+    }
+
+    /**
+     * Saturation ADAA at native rate (block path, control rate 16 as in the plugin)
+     * Per mode: aliased harmonics of +6VU tones at `sampleRate` without and with
+     * setSaturationADAA(), as the RMS sum of every harmonic up to H9 that folds back
+     * below Nyquist (dB re fundamental), and the 1kHz 0VU THD change ADAA causes.
+     * The cubic itself only aliases once its H3 passes Nyquist (tones above 8kHz at
+     * 48kHz); what remains below that is the J-A's higher harmonics.
+     * Passes when ADAA raises no tone's aliasing by more than 1 dB and moves the 1kHz
+     * THD by at most maxDeviationDB (the averaged cubic term droops towards Nyquist).
+     */
+    bool runAliasingCheck(double sampleRate = 48000.0, double maxDeviationDB = 0.15)
+    {
+        static constexpr std::array<double, 3> TONES = {{ 9000.0, 11000.0, 13000.0 }};
+        bool allPassed = true;
+
+        std::cout << "\n--- Aliasing Check (" << std::fixed << std::setprecision(1) << sampleRate / 1000.0
+                  << "kHz native, +6VU, block path) ---\n";
+        std::cout << "Mode         | Tone (Hz) | Alias off (dB) | Alias ADAA (dB) | 1kHz THD dev (dB) | Result\n";
+        std::cout << "-------------|-----------|----------------|-----------------|-------------------|-------\n";
+
+        HybridTapeProcessor native;
+        native.setSampleRate(sampleRate);
+        native.setControlRateInterval(16);
+        const int N = FFT_SIZE;
+        const HarmonicAnalyzer nativeAnalyzer(sampleRate, N);
+
+        // One tone through the native-rate processor, analysis window after the pre-roll
+        auto renderNative = [&](double frequency, double levelVU, bool adaa) {
+            native.setSaturationADAA(adaa);
+            native.reset();
+            std::vector<double> input(static_cast<size_t>(3 * N));
+            double phaseInc = 2.0 * M_PI * frequency / sampleRate;
+            double amplitude = std::pow(10.0, levelVU / 20.0);
+            for (int i = 0; i < 3 * N; ++i)
+                input[i] = amplitude * std::sin(phaseInc * i);
+            std::vector<double> output = render(native, input, true);
+            output.erase(output.begin(), output.begin() + 2 * N);
+            return output;
+        };
+
+        // Folded harmonics, skipping any that land on an in-band harmonic or near DC / Nyquist
+        auto aliasDB = [&](const std::vector<double>& output, double frequency) {
+            const double nyquist = sampleRate / 2.0;
+            double fundamental = nativeAnalyzer.measureAmplitude(output.data(), frequency);
+            double sumSquares = 0.0;
+            for (int h = 2; h <= HarmonicAnalyzer::MAX_HARMONIC; ++h) {
+                double f = frequency * h;
+                if (f < nyquist)
+                    continue;
+                double folded = std::fmod(f, sampleRate);
+                if (folded > nyquist)
+                    folded = sampleRate - folded;
+                double nearestHarmonic = frequency * std::max(1.0, std::round(folded / frequency));
+                if (folded < 100.0 || folded > nyquist - 100.0 || std::abs(folded - nearestHarmonic) < 100.0)
+                    continue;
+                double amplitude = nativeAnalyzer.measureAmplitude(output.data(), folded);
+                sumSquares += amplitude * amplitude;
+            }
+            return 10.0 * std::log10(std::max(sumSquares, 1e-30) / (fundamental * fundamental));
+        };
+
+        for (int m = 0; m < 4; ++m) {
+            const auto& mode = MODES[m];
+            native.setParameters(mode.biasStrength, 1.0, mode.tapeFormula);
+
+            double thdOff = nativeAnalyzer.analyze(renderNative(1000.0, 0.0, false), 1000.0).thdPercent();
+            double thdADAA = nativeAnalyzer.analyze(renderNative(1000.0, 0.0, true), 1000.0).thdPercent();
+            double deviation = 20.0 * std::log10(thdADAA / thdOff);
+
+            for (double tone : TONES) {
+                double aliasOff = aliasDB(renderNative(tone, 6.0, false), tone);
+                double aliasADAA = aliasDB(renderNative(tone, 6.0, true), tone);
+
+                bool passed = aliasADAA <= aliasOff + 1.0 && std::abs(deviation) <= maxDeviationDB;
+                allPassed = allPassed && passed;
+
+                std::cout << std::left << std::setw(12) << mode.name << std::right << " | "
+                          << std::setprecision(0) << std::setw(9) << tone << " | "
+                          << std::setprecision(1)
+                          << std::setw(14) << aliasOff << " | "
+                          << std::setw(15) << aliasADAA << " | "
+                          << std::setprecision(3) << std::showpos
+                          << std::setw(17) << deviation << std::noshowpos << " | "
+                          << (passed ? "PASS" : "FAIL") << "\n";
+            }
+        }
+
+        return allPassed;
+    }
+
+    /**
+     * Control-rate quality check (block path)
+     * Measures the 1kHz THD curve at the calibration levels with per-sample
+     * evaluation and with effectiveA3/J-A gate evaluated every `interval` samples.
+     * Passes when the curves differ by at most maxDeviationDB RMS, well inside
+     * the 0.25-0.31 dB RMS error the modes were calibrated to.
+     */
+    bool runControlRateCheck(int interval = 16, double maxDeviationDB = 0.1)
+    {
+        static constexpr std::array<double, 5> CAL_LEVELS = {{ -12.0, -6.0, 0.0, 3.0, 6.0 }};
+        bool allPassed = true;
+
+        std::cout << "\n--- Control-Rate Check (N = " << interval << ", 1kHz, block path) ---\n";
+        std::cout << "Mode         | RMS err N=1 | RMS err N=" << std::setw(2) << interval
+                  << " | Deviation | Result\n";
+        std::cout << "-------------|-------------|--------------|-----------|-------\n";
+
+        for (int m = 0; m < 4; ++m) {
+            const auto& mode = MODES[m];
+            processor.setParameters(mode.biasStrength, 1.0, mode.tapeFormula);
+
+            double sumSqRef = 0.0, sumSqControl = 0.0, sumSqDeviation = 0.0;
+            for (double levelVU : CAL_LEVELS) {
+                double target = expectedTHD(mode, levelVU);
+
+                processor.setControlRateInterval(1);
+                double thdRef = measureTHD(1000.0, levelVU, true).thdTotal;
+
+                processor.setControlRateInterval(interval);
+                double thdControl = measureTHD(1000.0, levelVU, true).thdTotal;
+
+                double errRef = 20.0 * std::log10(thdRef / target);
+                double errControl = 20.0 * std::log10(thdControl / target);
+                double deviation = 20.0 * std::log10(thdControl / thdRef);
+                sumSqRef += errRef * errRef;
+                sumSqControl += errControl * errControl;
+                sumSqDeviation += deviation * deviation;
+            }
+            processor.setControlRateInterval(1);
+
+            double n = static_cast<double>(CAL_LEVELS.size());
+            double rmsDeviation = std::sqrt(sumSqDeviation / n);
+            bool passed = rmsDeviation <= maxDeviationDB;
+            allPassed = allPassed && passed;
+
+            std::cout << std::left << std::setw(12) << mode.name << std::right << " | "
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(8) << std::sqrt(sumSqRef / n) << " dB | "
+                      << std::setw(9) << std::sqrt(sumSqControl / n) << " dB | "
+                      << std::setw(6) << rmsDeviation << " dB | "
+                      << (passed ? "PASS" : "FAIL") << "\n";
+        }
+
+        return allPassed;
+    }
+
+    /**
+     * Float vs double engine (block path)
+     * Per mode and calibration level: 1kHz THD of both engines and their deviation,
+     * the null residual (float output - double output) relative to the double
+     * output, and the block-path cost per sample of each engine.
+     * Passes when THD deviates by at most maxDeviationDB and every null residual
+     * stays below maxResidualDB.
+     */
+    bool runPrecisionComparison(double maxDeviationDB = 0.05, double maxResidualDB = -100.0)
+    {
+        static constexpr std::array<double, 5> CAL_LEVELS = {{ -12.0, -6.0, 0.0, 3.0, 6.0 }};
+        bool allPassed = true;
+
+        std::cout << "\n--- Precision Comparison (float vs double engine, 1kHz, block path) ---\n";
+        std::cout << "Mode         | Level | THD dbl(%) | THD flt(%) | Dev (dB) | Null (dB)   | Result\n";
+        std::cout << "-------------|-------|------------|------------|----------|-------------|-------\n";
+
+        for (int m = 0; m < 4; ++m) {
+            const auto& mode = MODES[m];
+            processor.setParameters(mode.biasStrength, 1.0, mode.tapeFormula);
+            floatProcessor.setParameters(mode.biasStrength, 1.0, mode.tapeFormula);
+
+            for (double levelVU : CAL_LEVELS) {
+                double thdDouble = measureTHD(processor, 1000.0, levelVU, true).thdTotal;
+                double thdFloat = measureTHD(floatProcessor, 1000.0, levelVU, true).thdTotal;
+                double deviation = 20.0 * std::log10(thdFloat / thdDouble);
+
+                // Null test on one second of the same tone, fade-in included
+                double amplitude = std::pow(10.0, levelVU / 20.0);
+                int numSamples = static_cast<int>(fs);
+                processor.reset();
+                floatProcessor.reset();
+                std::vector<double> outDouble = renderTone(processor, 1000.0, amplitude, numSamples, true);
+                std::vector<double> outFloat = renderTone(floatProcessor, 1000.0, amplitude, numSamples, true);
+
+                double signalSq = 0.0, residualSq = 0.0;
+                for (int i = 0; i < numSamples; ++i) {
+                    double diff = outFloat[i] - outDouble[i];
+                    signalSq += outDouble[i] * outDouble[i];
+                    residualSq += diff * diff;
+                }
+                double residualDB = 10.0 * std::log10(std::max(residualSq, 1e-40) / signalSq);
+
+                bool passed = std::abs(deviation) <= maxDeviationDB && residualDB <= maxResidualDB;
+                allPassed = allPassed && passed;
+
+                std::cout << std::left << std::setw(12) << mode.name << std::right << " | "
+                          << std::fixed << std::setprecision(1) << std::showpos
+                          << std::setw(5) << levelVU << std::noshowpos << " | "
+                          << std::setprecision(5)
+                          << std::setw(10) << thdDouble << " | "
+                          << std::setw(10) << thdFloat << " | "
+                          << std::setprecision(3) << std::showpos
+                          << std::setw(8) << deviation << std::noshowpos << " | "
+                          << std::setprecision(1)
+                          << std::setw(11) << residualDB << " | "
+                          << (passed ? "PASS" : "FAIL") << "\n";
+            }
+        }
+
+        // Block-path cost: Ampex GP9 at 0VU, 10 seconds per engine
+        int benchSamples = static_cast<int>(fs * 10.0);
+        processor.setParameters(MODES[2].biasStrength, 1.0, MODES[2].tapeFormula);
+        floatProcessor.setParameters(MODES[2].biasStrength, 1.0, MODES[2].tapeFormula);
+        double nsDouble = timeBlockPath(processor, benchSamples);
+        double nsFloat = timeBlockPath(floatProcessor, benchSamples);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Block path (Ampex GP9, 0VU): double " << nsDouble << " ns/sample, float "
+                  << nsFloat << " ns/sample (" << std::setprecision(2) << nsDouble / nsFloat << "x)\n";
+
+        return allPassed;
+    }
+
 private:
     double fs;
     HybridTapeProcessor processor;
+    HybridTapeProcessorFloat floatProcessor;
+    HarmonicAnalyzer analyzer { fs, FFT_SIZE };
 
-    // FFT size for THD measurement (must be power of 2)
+    // Minimum analysis length for THD measurement
     static constexpr int FFT_SIZE = 8192;
     static constexpr int NUM_CYCLES = 64;  // Number of cycles to analyze
 
+    // Host-sized blocks for the processBlock() paths
+    static constexpr int BLOCK_SIZE = 512;
+
+    /**
+     * Render a sine through the processor (from its current state)
+     */
+    template <typename Processor>
+    std::vector<double> renderTone(Processor& proc, double frequency, double amplitude,
+                                   int numSamples, bool useBlockPath)
+    {
+        std::vector<double> input(numSamples);
+        double phase = 0.0;
+        double phaseInc = 2.0 * M_PI * frequency / fs;
+        for (int i = 0; i < numSamples; ++i) {
+            input[i] = amplitude * std::sin(phase);
+            phase += phaseInc;
+        }
+
+        return render(proc, input, useBlockPath);
+    }
+
+    /**
+     * Render a signal through the processor (from its current state)
+     * Block path: processBlock() in host-sized blocks, otherwise processSample()
+     */
+    template <typename Processor>
+    std::vector<double> render(Processor& proc, const std::vector<double>& input, bool useBlockPath)
+    {
+        using SampleType = decltype(proc.processSample(0.0f));
+        const int numSamples = static_cast<int>(input.size());
+        std::vector<double> output(numSamples);
+
+        if (useBlockPath) {
+            std::vector<float> block(BLOCK_SIZE);
+            for (int start = 0; start < numSamples; start += BLOCK_SIZE) {
+                int n = std::min(BLOCK_SIZE, numSamples - start);
+                for (int i = 0; i < n; ++i)
+                    block[i] = static_cast<float>(input[start + i]);
+                proc.processBlock(block.data(), block.data(), n);
+                for (int i = 0; i < n; ++i)
+                    output[start + i] = block[i];
+            }
+        } else {
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = proc.processSample(static_cast<SampleType>(input[i]));
+        }
+
+        return output;
+    }
+
+    /**
+     * Block-path cost in ns/sample (0VU 1kHz tone, processing time only)
+     */
+    template <typename Processor>
+    double timeBlockPath(Processor& proc, int numSamples)
+    {
+        std::vector<float> input(numSamples), block(BLOCK_SIZE);
+        double phaseInc = 2.0 * M_PI * 1000.0 / fs;
+        for (int i = 0; i < numSamples; ++i)
+            input[i] = static_cast<float>(std::sin(phaseInc * i));
+
+        proc.reset();
+        double seconds = 0.0;
+        for (int start = 0; start < numSamples; start += BLOCK_SIZE) {
+            int n = std::min(BLOCK_SIZE, numSamples - start);
+            auto begin = std::chrono::steady_clock::now();
+            proc.processBlock(input.data() + start, block.data(), n);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        return seconds * 1e9 / numSamples;
+    }
+
     /**
      * Generate test tone and measure THD through processor
      */
-    THDResult measureTHD(double frequency, double levelVU)
+    THDResult measureTHD(double frequency, double levelVU, bool useBlockPath = false)
     {
-        THDResult result = {};
+        return measureTHD(processor, frequency, levelVU, useBlockPath);
+    }
 
+    template <typename Processor>
+    THDResult measureTHD(Processor& proc, double frequency, double levelVU, bool useBlockPath = false)
+    {
         // Calculate amplitude from VU level
         // 0VU = 1.0 (unity), +6VU = 2.0, -6VU = 0.5, etc.
         double amplitude = std::pow(10.0, levelVU / 20.0);
 
-        // Calculate samples needed for whole cycles
-        int samplesPerCycle = static_cast<int>(fs / frequency);
-        int totalSamples = samplesPerCycle * NUM_CYCLES;
-        totalSamples = std::max(totalSamples, FFT_SIZE);
+        int totalSamples = analysisLength(frequency);
 
-        // Pre-roll to settle filters (2x the analysis length)
+        // Pre-roll to settle filters (2x the analysis length), then capture
         int preRoll = totalSamples * 2;
 
-        // Generate input and process
-        std::vector<double> output(totalSamples);
-        double phase = 0.0;
-        double phaseInc = 2.0 * M_PI * frequency / fs;
-
-        // Pre-roll (discard output)
-        processor.reset();
-        for (int i = 0; i < preRoll; ++i) {
-            double input = amplitude * std::sin(phase);
-            processor.processSample(input);
-            phase += phaseInc;
-        }
-
-        // Capture output
-        for (int i = 0; i < totalSamples; ++i) {
-            double input = amplitude * std::sin(phase);
-            output[i] = processor.processSample(input);
-            phase += phaseInc;
-        }
+        proc.reset();
+        std::vector<double> output = renderTone(proc, frequency, amplitude, preRoll + totalSamples, useBlockPath);
 
         // Measure harmonics using DFT at exact harmonic frequencies
-        double fundamental = measureHarmonicAmplitude(output, frequency, 1);
-        double h2 = measureHarmonicAmplitude(output, frequency, 2);
-        double h3 = measureHarmonicAmplitude(output, frequency, 3);
-        double h4 = measureHarmonicAmplitude(output, frequency, 4);
-        double h5 = measureHarmonicAmplitude(output, frequency, 5);
-
-        // Calculate THD
-        result.fundamental = fundamental;
-        result.thd2 = (h2 / fundamental) * 100.0;
-        result.thd3 = (h3 / fundamental) * 100.0;
-
-        double sumSquares = h2*h2 + h3*h3 + h4*h4 + h5*h5;
-        result.thdTotal = (std::sqrt(sumSquares) / fundamental) * 100.0;
-        result.thdDB = 20.0 * std::log10(result.thdTotal / 100.0);
-        result.eoRatio = (h3 > 1e-10) ? (h2 / h3) : 999.0;
-
-        return result;
+        return makeResult(analyzerFor(totalSamples).analyze(output.data() + preRoll, frequency));
     }
 
     /**
-     * Measure amplitude of specific harmonic using Goertzel-style DFT
-     * More accurate than FFT bin interpolation for exact frequencies
+     * THD at every level from one render (SteppedTone, see HarmonicAnalyzer.h)
+     * One reset and pre-roll for the whole curve; each further level settles for
+     * half an analysis length before it is captured.
      */
-    double measureHarmonicAmplitude(const std::vector<double>& signal,
-                                     double fundamentalFreq, int harmonic)
+    template <typename Processor>
+    std::vector<THDResult> measureTHDCurve(Processor& proc, double frequency, const double* levelsVU,
+                                           int numLevels, bool useBlockPath = false)
     {
-        double targetFreq = fundamentalFreq * harmonic;
-        int N = static_cast<int>(signal.size());
-
-        // Goertzel algorithm for single frequency
-        double k = targetFreq * N / fs;
-        double w = 2.0 * M_PI * k / N;
-        double cosw = std::cos(w);
-        double sinw = std::sin(w);
-        double coeff = 2.0 * cosw;
-
-        double s0 = 0.0, s1 = 0.0, s2 = 0.0;
-
-        // Apply Hann window and compute
-        for (int i = 0; i < N; ++i) {
-            double window = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / N));
-            s0 = signal[i] * window + coeff * s1 - s2;
-            s2 = s1;
-            s1 = s0;
+        int totalSamples = analysisLength(frequency);
+        SteppedTone stimulus(fs, frequency, levelsVU, numLevels, totalSamples * 2, totalSamples / 2, totalSamples);
+
+        proc.reset();
+        std::vector<double> output = render(proc, stimulus.input, useBlockPath);
+
+        const HarmonicAnalyzer& analyzer = analyzerFor(totalSamples);
+        std::vector<THDResult> results;
+        for (const auto& step : stimulus.steps) {
+            THDResult result = makeResult(analyzer.analyze(output.data() + step.captureStart, frequency));
+            result.levelVU = step.levelVU;
+            result.frequency = frequency;
+            results.push_back(result);
         }
 
-        // Compute magnitude
-        double real = s1 - s2 * cosw;
-        double imag = s2 * sinw;
-        double magnitude = std::sqrt(real * real + imag * imag);
+        return results;
+    }
 
-        // Normalize for Hann window (factor of 2) and DFT scaling
-        return (2.0 * magnitude) / (N * 0.5);
+    // Whole cycles, at least NUM_CYCLES of them and FFT_SIZE samples
+    int analysisLength(double frequency) const
+    {
+        int samplesPerCycle = static_cast<int>(fs / frequency);
+        return std::max(samplesPerCycle * NUM_CYCLES, FFT_SIZE);
+    }
+
+    // The window is rebuilt only when the analysis length changes
+    const HarmonicAnalyzer& analyzerFor(int length)
+    {
+        if (analyzer.getLength() != length)
+            analyzer = HarmonicAnalyzer(fs, length);
+        return analyzer;
+    }
+
+    static THDResult makeResult(const HarmonicAnalyzer::Harmonics& harmonics)
+    {
+        THDResult result = {};
+        double h2 = harmonics.amplitude[2];
+        double h3 = harmonics.amplitude[3];
+
+        result.fundamental = harmonics.fundamental();
+        result.thd2 = harmonics.percent(2);
+        result.thd3 = harmonics.percent(3);
+        result.thdTotal = harmonics.thdPercent();
+        result.thdDB = 20.0 * std::log10(result.thdTotal / 100.0);
+        result.eoRatio = (h3 > 1e-10) ? (h2 / h3) : 999.0;
+
+        return result;
     }
 };
 
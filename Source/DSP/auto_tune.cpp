@@ -3,19 +3,28 @@
  *
  * Tests actual processor with many parameter combinations
  * to find optimal THD curve fit for each mode.
+ * Evaluations run on all cores (CalibrationSearch.h); Nelder-Mead by default,
+ * the exhaustive grid or a coarse-to-fine grid on request.
  *
- * Compile: clang++ -std=c++17 -O3 -o auto_tune auto_tune.cpp MachineEQ.cpp BiasShielding.cpp HybridTapeProcessor.cpp -I.
+ * Compile: clang++ -std=c++17 -O3 -pthread -o auto_tune auto_tune.cpp MachineEQ.cpp BiasShielding.cpp HybridTapeProcessor.cpp -I.
+ * Run: ./auto_tune [mode] [--search nm|fine|grid] [--threads N]
  */
 
 #include "HybridTapeProcessor.h"
+#include "CalibrationSearch.h"
+#include "HarmonicAnalyzer.h"
 #include <cmath>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cstring>
+#include <string>
 
 using namespace TapeMachine;
 
+enum class SearchMode { NelderMead, CoarseToFine, Grid };
+
 constexpr double PI = 3.14159265358979323846;
 constexpr double SAMPLE_RATE = 96000.0;
 constexpr int NUM_SAMPLES = 8192;
@@ -37,27 +46,8 @@ TargetCurve targets[] = {
 
 double levels[] = {-12.0, -6.0, 0.0, 3.0, 6.0};
 
-double measureAmplitude(const std::vector<double>& signal, double freq, double fs)
-{
-    int N = static_cast<int>(signal.size());
-    double k = freq * N / fs;
-    double w = 2.0 * PI * k / N;
-    double cosw = std::cos(w);
-    double sinw = std::sin(w);
-    double coeff = 2.0 * cosw;
-
-    double s0 = 0.0, s1 = 0.0, s2 = 0.0;
-    for (int i = 0; i < N; ++i) {
-        double window = 0.5 * (1.0 - std::cos(2.0 * PI * i / N));
-        s0 = signal[i] * window + coeff * s1 - s2;
-        s2 = s1;
-        s1 = s0;
-    }
-
-    double real = s1 - s2 * cosw;
-    double imag = s2 * sinw;
-    return (2.0 * std::sqrt(real * real + imag * imag)) / (N * 0.5);
-}
+// Hann window precomputed once; read-only, shared by the evaluator threads
+static const HarmonicAnalyzer analyzer(SAMPLE_RATE, NUM_SAMPLES);
 
 double measureTHD(HybridTapeProcessor& proc, double levelVU, double freq = 1000.0)
 {
@@ -78,16 +68,11 @@ double measureTHD(HybridTapeProcessor& proc, double levelVU, double freq = 1000.
         phase += phaseInc;
     }
 
-    double f1 = measureAmplitude(output, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(output, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(output, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(output, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(output, freq * 5, SAMPLE_RATE);
-
-    return (std::sqrt(h2*h2 + h3*h3 + h4*h4 + h5*h5) / f1) * 100.0;
+    // H2-H5 in one pass over the capture
+    return analyzer.analyze(output, freq).thdPercent();
 }
 
-double calculateRMSError(double* measured, double* target)
+double calculateRMSError(const double* measured, const double* target)
 {
     double sumSqError = 0.0;
     for (int i = 0; i < 5; ++i) {
@@ -106,7 +91,22 @@ struct ParamSet {
     double measured[5];
 };
 
-void runSweep(int modeIndex)
+// Parameters: { satA3, satPower, lowLevelScale, jaBlend }
+double evaluateParams(HybridTapeProcessor& proc, const TargetCurve& target,
+                      const Calibration::Parameters& params, double* measured)
+{
+    // Set mode first, then override with test parameters
+    proc.setParameters(target.biasStrength, 1.0, target.tapeFormula);
+    proc.setTestParameters(params[0], params[1], params[2], params[3]);
+
+    for (int i = 0; i < 5; ++i) {
+        measured[i] = measureTHD(proc, levels[i]);
+    }
+
+    return calculateRMSError(measured, target.thd);
+}
+
+void runSweep(int modeIndex, SearchMode searchMode, int numThreads)
 {
     TargetCurve& target = targets[modeIndex];
 
@@ -145,59 +145,53 @@ void runSweep(int modeIndex)
         for (double v = 0.004; v <= 0.010; v += 0.001) jaBlend_vals.push_back(v);
     }
 
-    int totalTests = a3_vals.size() * power_vals.size() * lowScale_vals.size() * jaBlend_vals.size();
-    std::cout << "Testing " << totalTests << " parameter combinations...\n";
+    const std::vector<std::vector<double>> axes { a3_vals, power_vals, lowScale_vals, jaBlend_vals };
+    const Calibration::Parameters lower { a3_vals.front(), power_vals.front(), lowScale_vals.front(), jaBlend_vals.front() };
+    const Calibration::Parameters upper { a3_vals.back(), power_vals.back(), lowScale_vals.back(), jaBlend_vals.back() };
+
+    Calibration::ParallelEvaluator evaluator(SAMPLE_RATE,
+        [&target](HybridTapeProcessor& proc, const Calibration::Parameters& params) {
+            double measured[5];
+            return evaluateParams(proc, target, params, measured);
+        },
+        numThreads);
+
+    size_t totalTests = 1;
+    for (const auto& axis : axes) totalTests *= axis.size();
+
     std::cout << std::fixed << std::setprecision(4);
     std::cout << "  satA3: " << a3_vals.front() << " to " << a3_vals.back() << " (" << a3_vals.size() << " values)\n";
     std::cout << "  satPower: " << power_vals.front() << " to " << power_vals.back() << " (" << power_vals.size() << " values)\n";
     std::cout << "  lowLevelScale: " << lowScale_vals.front() << " to " << lowScale_vals.back() << " (" << lowScale_vals.size() << " values)\n";
     std::cout << "  jaBlend: " << jaBlend_vals.front() << " to " << jaBlend_vals.back() << " (" << jaBlend_vals.size() << " values)\n\n";
 
+    Calibration::SearchResult result;
+    if (searchMode == SearchMode::Grid) {
+        std::cout << "Testing all " << totalTests << " parameter combinations on " << evaluator.getNumThreads() << " thread(s)...\n";
+        result = Calibration::gridSearch(evaluator, axes);
+    } else if (searchMode == SearchMode::CoarseToFine) {
+        std::cout << "Coarse-to-fine grid search on " << evaluator.getNumThreads() << " thread(s)...\n";
+        result = Calibration::coarseToFine(evaluator, lower, upper);
+    } else {
+        std::cout << "Nelder-Mead search from the range centre on " << evaluator.getNumThreads() << " thread(s)...\n";
+        Calibration::Parameters centre(lower.size());
+        for (size_t d = 0; d < centre.size(); ++d) centre[d] = 0.5 * (lower[d] + upper[d]);
+        result = Calibration::nelderMead(evaluator, centre, lower, upper);
+    }
+
+    std::cout << std::setprecision(1) << "  " << result.evaluations << " evaluations in " << result.seconds << " s"
+              << " (full grid: " << totalTests << ")\n\n" << std::setprecision(4);
+
+    // Re-measure the winner for the report
     HybridTapeProcessor proc;
     proc.setSampleRate(SAMPLE_RATE);
 
     ParamSet best;
-    best.rmsError = 1000.0;
-
-    int testCount = 0;
-    int progressStep = totalTests / 50;
-    if (progressStep < 1) progressStep = 1;
-
-    for (double a3 : a3_vals) {
-        for (double power : power_vals) {
-            for (double lowScale : lowScale_vals) {
-                for (double jaBlend : jaBlend_vals) {
-                    testCount++;
-                    if (testCount % progressStep == 0) {
-                        std::cout << "\r  Progress: " << (testCount * 100 / totalTests) << "% (best so far: "
-                                  << best.rmsError << " dB)" << std::flush;
-                    }
-
-                    // Set mode first, then override with test parameters
-                    proc.setParameters(target.biasStrength, 1.0, target.tapeFormula);
-                    proc.setTestParameters(a3, power, lowScale, jaBlend);
-
-                    double measured[5];
-                    for (int i = 0; i < 5; ++i) {
-                        measured[i] = measureTHD(proc, levels[i]);
-                    }
-
-                    double error = calculateRMSError(measured, target.thd);
-
-                    if (error < best.rmsError) {
-                        best.rmsError = error;
-                        best.satA3 = a3;
-                        best.satPower = power;
-                        best.lowLevelScale = lowScale;
-                        best.jaBlend = jaBlend;
-                        for (int i = 0; i < 5; ++i) best.measured[i] = measured[i];
-                    }
-                }
-            }
-        }
-    }
-
-    std::cout << "\r  Progress: 100%                                    \n\n";
+    best.satA3 = result.params[0];
+    best.satPower = result.params[1];
+    best.lowLevelScale = result.params[2];
+    best.jaBlend = result.params[3];
+    best.rmsError = evaluateParams(proc, target, result.params, best.measured);
 
     std::cout << "═══════════════════════════════════════════════════════════════════\n";
     std::cout << "BEST PARAMETERS FOUND:\n";
@@ -225,22 +219,46 @@ void runSweep(int modeIndex)
 
 int main(int argc, char* argv[])
 {
-    if (argc > 1) {
-        int modeIndex = std::atoi(argv[1]);
-        if (modeIndex >= 0 && modeIndex <= 3) {
-            runSweep(modeIndex);
+    int modeIndex = -1;  // -1 = all modes
+    SearchMode searchMode = SearchMode::NelderMead;
+    int numThreads = 0;  // 0 = all cores
+    bool validArgs = true;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--search") == 0 && i + 1 < argc) {
+            const std::string mode = argv[++i];
+            if (mode == "grid") searchMode = SearchMode::Grid;
+            else if (mode == "fine") searchMode = SearchMode::CoarseToFine;
+            else if (mode == "nm") searchMode = SearchMode::NelderMead;
+            else validArgs = false;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = std::max(1, std::atoi(argv[++i]));
         } else {
-            std::cout << "Usage: ./auto_tune [mode]\n";
-            std::cout << "  0 = Studer GP9\n";
-            std::cout << "  1 = Studer SM900\n";
-            std::cout << "  2 = Ampex GP9\n";
-            std::cout << "  3 = Ampex SM900\n";
-            std::cout << "  (no arg) = all modes\n";
+            modeIndex = std::atoi(argv[i]);
+            if (modeIndex < 0 || modeIndex > 3) validArgs = false;
         }
+    }
+
+    if (!validArgs) {
+        std::cout << "Usage: ./auto_tune [mode] [--search nm|fine|grid] [--threads N]\n";
+        std::cout << "  0 = Studer GP9\n";
+        std::cout << "  1 = Studer SM900\n";
+        std::cout << "  2 = Ampex GP9\n";
+        std::cout << "  3 = Ampex SM900\n";
+        std::cout << "  (no mode) = all modes\n";
+        std::cout << "  --search nm    Nelder-Mead (default, ~100-200 evaluations)\n";
+        std::cout << "  --search fine  Coarse-to-fine grid (5 points per axis, 4 rounds)\n";
+        std::cout << "  --search grid  Exhaustive grid (every combination)\n";
+        std::cout << "  --threads N    Worker threads (default: all cores)\n";
+        return 1;
+    }
+
+    if (modeIndex >= 0) {
+        runSweep(modeIndex, searchMode, numThreads);
     } else {
         // Run all modes
         for (int i = 0; i < 4; ++i) {
-            runSweep(i);
+            runSweep(i, searchMode, numThreads);
             std::cout << "\n";
         }
     }
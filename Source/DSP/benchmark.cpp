@@ -0,0 +1,255 @@
+/**
+ * DSP Benchmark - ns/sample of the tape processing stages
+ *
+ * Times the individual stages and the complete tape processor for every machine /
+ * formula configuration across sample rates and block sizes:
+ *
+ *   JilesAthertonCore::process          J-A hysteresis solve (double and float)
+ *   MachineEQ::processSample / Block    Machine EQ (per machine)
+ *   HFCut::processSample / Block        AC bias shielding split
+ *   HybridTapeProcessor::processSample  Full tape core, one sample at a time
+ *   HybridTapeProcessor::processBlock   Full tape core, mono block path
+ *   HybridTapeProcessor::processStereoBlock  Stereo pair (2 channels)
+ *
+ * "Float" variants use the single-precision engine. Results are per channel sample at
+ * the rate the stage runs at; with oversampling the tape core runs at the oversampled
+ * rate, so read the 88.2/96 kHz rows for a 44.1/48 kHz session at 2x.
+ * The full plugin processBlock (oversampling and the post-tape chain included) is
+ * measured by Plugin/Source/PluginBenchmark.cpp with the same options and JSON layout.
+ *
+ * Compile: clang++ -std=c++17 -O3 -o benchmark benchmark.cpp MachineEQ.cpp BiasShielding.cpp HybridTapeProcessor.cpp -I.
+ * Run:     ./benchmark --json results.json
+ *          ./benchmark --json new.json --compare results.json --tolerance 10
+ */
+
+#include "HybridTapeProcessor.h"
+#include "BenchmarkHarness.h"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace TapeMachine;
+using namespace TapeMachine::Benchmark;
+
+constexpr int SIGNAL_LENGTH = 8192;   // Test signal cycled through by every stage (fits in L1/L2)
+
+static void addResult(Report& report, const std::string& stage, const char* config, double sampleRate,
+                      int blockSize, int channels, std::pair<double, double> timing)
+{
+    Result result;
+    result.stage = stage;
+    result.config = config;
+    result.sampleRate = sampleRate;
+    result.blockSize = blockSize;
+    result.channels = channels;
+    result.nsPerSample = timing.first;
+    result.nsPerSampleMin = timing.second;
+    report.add(result);
+}
+
+// J-A core with the processor's tape parameters (see HybridTapeProcessor::setParameters)
+template <typename SampleType>
+static void benchmarkJilesAtherton(Report& report, const Options& options, const Configuration& config,
+                                   double sampleRate, const std::vector<float>& signal, const std::string& stage)
+{
+    if (!wantsStage(options, stage))
+        return;
+
+    JilesAthertonBase::Parameters params;
+    params.a = 22000.0;
+    params.k = 27500.0;
+    params.c = 0.98;
+    params.alpha = 1.6e-3;
+    params.M_s = config.isSM900() ? 337000.0 : 350000.0;
+
+    JilesAthertonCoreT<SampleType> core;
+    core.setParameters(params);
+    core.setSampleRate(sampleRate);
+
+    auto timing = measure([&] {
+        SampleType sum = 0;
+        for (float x : signal)
+            sum += core.process(SampleType(x));
+        consume(static_cast<double>(sum));
+    }, SIGNAL_LENGTH, options);
+
+    addResult(report, stage, config.name, sampleRate, 1, 1, timing);
+}
+
+static void benchmarkFilters(Report& report, const Options& options, const Configuration& config,
+                             double sampleRate, const std::vector<float>& signal)
+{
+    MachineEQ machineEQ;
+    machineEQ.setSampleRate(sampleRate);
+    machineEQ.setMachine(config.isAmpex() ? MachineEQ::Machine::Ampex : MachineEQ::Machine::Studer);
+
+    HFCut hfCut;
+    hfCut.setSampleRate(sampleRate);
+    hfCut.setMachineAndTape(config.isAmpex(), config.isSM900());
+
+    // MachineEQ depends on the machine only: measured once per machine (GP9 configs)
+    const bool measureEQ = !config.isSM900();
+    const char* machineName = config.isAmpex() ? "ampex" : "studer";
+
+    if (measureEQ && wantsStage(options, "MachineEQ::processSample")) {
+        auto timing = measure([&] {
+            double sum = 0.0;
+            for (float x : signal)
+                sum += machineEQ.processSample(x);
+            consume(sum);
+        }, SIGNAL_LENGTH, options);
+        addResult(report, "MachineEQ::processSample", machineName, sampleRate, 1, 1, timing);
+    }
+
+    if (wantsStage(options, "HFCut::processSample")) {
+        auto timing = measure([&] {
+            double sum = 0.0;
+            for (float x : signal)
+                sum += hfCut.processSample(x);
+            consume(sum);
+        }, SIGNAL_LENGTH, options);
+        addResult(report, "HFCut::processSample", config.name, sampleRate, 1, 1, timing);
+    }
+
+    for (int blockSize : options.blockSizes) {
+        std::vector<double> block(static_cast<size_t>(blockSize));
+        size_t position = 0;
+
+        // Next block of the cycled test signal into the in-place buffer
+        auto fillBlock = [&] {
+            for (double& sample : block) {
+                sample = signal[position];
+                position = (position + 1) % signal.size();
+            }
+        };
+
+        if (measureEQ && wantsStage(options, "MachineEQ::processBlock")) {
+            auto timing = measure([&] {
+                fillBlock();
+                machineEQ.processBlock(block.data(), blockSize);
+                consume(block[0]);
+            }, blockSize, options);
+            addResult(report, "MachineEQ::processBlock", machineName, sampleRate, blockSize, 1, timing);
+        }
+
+        if (wantsStage(options, "HFCut::processBlock")) {
+            auto timing = measure([&] {
+                fillBlock();
+                hfCut.processBlock(block.data(), blockSize);
+                consume(block[0]);
+            }, blockSize, options);
+            addResult(report, "HFCut::processBlock", config.name, sampleRate, blockSize, 1, timing);
+        }
+    }
+}
+
+template <typename SampleType>
+static void benchmarkProcessor(Report& report, const Options& options, const Configuration& config,
+                               double sampleRate, const std::vector<float>& signal, const std::string& prefix)
+{
+    auto makeProcessor = [&] {
+        auto proc = std::make_unique<HybridTapeProcessorT<SampleType>>();
+        proc->setSampleRate(sampleRate);
+        proc->setParameters(config.biasStrength, 1.0, config.tapeFormula);
+        return proc;
+    };
+    auto left = makeProcessor();
+    auto right = makeProcessor();
+
+    const std::string sampleStage = prefix + "::processSample";
+    if (wantsStage(options, sampleStage)) {
+        auto timing = measure([&] {
+            SampleType sum = 0;
+            for (float x : signal)
+                sum += left->processSample(SampleType(x));
+            consume(static_cast<double>(sum));
+        }, SIGNAL_LENGTH, options);
+        addResult(report, sampleStage, config.name, sampleRate, 1, 1, timing);
+    }
+
+    const int signalLength = static_cast<int>(signal.size());
+    for (int blockSize : options.blockSizes) {
+        std::vector<float> outputL(static_cast<size_t>(blockSize));
+        std::vector<float> outputR(static_cast<size_t>(blockSize));
+        int position = 0;
+
+        // Block start in the cycled test signal (the tail that does not fill a block is skipped)
+        auto nextBlock = [&] {
+            if (position + blockSize > signalLength)
+                position = 0;
+            const float* input = signal.data() + position;
+            position += blockSize;
+            return input;
+        };
+
+        const std::string blockStage = prefix + "::processBlock";
+        if (wantsStage(options, blockStage)) {
+            auto timing = measure([&] {
+                left->processBlock(nextBlock(), outputL.data(), blockSize);
+                consume(outputL[0]);
+            }, blockSize, options);
+            addResult(report, blockStage, config.name, sampleRate, blockSize, 1, timing);
+        }
+
+        const std::string stereoStage = prefix + "::processStereoBlock";
+        if (wantsStage(options, stereoStage)) {
+            auto timing = measure([&] {
+                const float* input = nextBlock();
+                HybridTapeProcessorT<SampleType>::processStereoBlock(*left, *right, input, input,
+                                                                     outputL.data(), outputR.data(), blockSize);
+                consume(outputL[0] + outputR[0]);
+            }, 2 * blockSize, options);
+            addResult(report, stereoStage, config.name, sampleRate, blockSize, 2, timing);
+        }
+    }
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: benchmark [options]\n\n";
+    printOptionsUsage();
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    Report report("tape_machine_dsp");
+    Report::printHeader();
+
+    for (double sampleRate : options.sampleRates) {
+        const std::vector<float> signal = makeTestSignal(sampleRate, SIGNAL_LENGTH);
+
+        for (const Configuration& config : configurations()) {
+            benchmarkJilesAtherton<double>(report, options, config, sampleRate, signal, "JilesAthertonCore::process");
+            benchmarkJilesAtherton<float>(report, options, config, sampleRate, signal, "JilesAthertonCoreFloat::process");
+            benchmarkFilters(report, options, config, sampleRate, signal);
+            benchmarkProcessor<double>(report, options, config, sampleRate, signal, "HybridTapeProcessor");
+            benchmarkProcessor<float>(report, options, config, sampleRate, signal, "HybridTapeProcessorFloat");
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (!report.writeJSON(options.jsonPath, options, buildInfo())) {
+            std::cerr << "Cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        std::cout << "\nWrote " << report.getResults().size() << " results to " << options.jsonPath << "\n";
+    }
+
+    if (!options.baselinePath.empty()) {
+        const int regressions = report.compareWithBaseline(options.baselinePath, options.tolerancePercent);
+        if (regressions < 0) {
+            std::cerr << "Cannot read " << options.baselinePath << "\n";
+            return 1;
+        }
+        return regressions > 0 ? 1 : 0;
+    }
+
+    return 0;
+}
@@ -4,12 +4,18 @@
  * Sweeps satA3, satPower, lowLevelScale to match target THD curve
  * Tests at -12, -6, 0, +3, +6 VU and finds best fit
  *
- * Compile: clang++ -std=c++17 -O2 -o fine_sweep fine_sweep.cpp MachineEQ.cpp BiasShielding.cpp HybridTapeProcessor.cpp -I.
- * Run: ./fine_sweep
+ * Processor evaluations run on all cores (CalibrationSearch.h)
+ *
+ * Compile: clang++ -std=c++17 -O2 -pthread -o fine_sweep fine_sweep.cpp MachineEQ.cpp BiasShielding.cpp HybridTapeProcessor.cpp -I.
+ * Run: ./fine_sweep [mode] [--search nm|fine|grid] [--threads N]
  */
 
 #include "HybridTapeProcessor.h"
+#include "CalibrationSearch.h"
+#include "HarmonicAnalyzer.h"
 #include <cmath>
+#include <cstring>
+#include <string>
 #include <vector>
 #include <iostream>
 #include <iomanip>
@@ -26,6 +32,7 @@ struct TargetCurve {
     const char* name;
     double biasStrength;  // < 0.74 = Ampex, >= 0.74 = Studer
     int tapeFormula;      // 0 = GP9, 1 = SM900
+    double jaBlend;       // Held at the shipped value during the sweep
     double thd_minus12;
     double thd_minus6;
     double thd_0;
@@ -35,33 +42,14 @@ struct TargetCurve {
 
 // Targets derived from research (exponential model: THD = THD_0VU * 10^(level/10))
 TargetCurve targets[] = {
-    { "Studer GP9",   0.80, 0, 0.0114, 0.0452, 0.18, 0.359, 0.717 },
-    { "Studer SM900", 0.80, 1, 0.0189, 0.0754, 0.30, 0.599, 1.194 },
-    { "Ampex GP9",    0.50, 0, 0.0057, 0.0226, 0.09, 0.180, 0.358 },
-    { "Ampex SM900",  0.50, 1, 0.0095, 0.0377, 0.15, 0.299, 0.597 }
+    { "Studer GP9",   0.80, 0, 0.008, 0.0114, 0.0452, 0.18, 0.359, 0.717 },
+    { "Studer SM900", 0.80, 1, 0.008, 0.0189, 0.0754, 0.30, 0.599, 1.194 },
+    { "Ampex GP9",    0.50, 0, 0.002, 0.0057, 0.0226, 0.09, 0.180, 0.358 },
+    { "Ampex SM900",  0.50, 1, 0.002, 0.0095, 0.0377, 0.15, 0.299, 0.597 }
 };
 
-double measureAmplitude(const std::vector<double>& signal, double freq, double fs)
-{
-    int N = static_cast<int>(signal.size());
-    double k = freq * N / fs;
-    double w = 2.0 * PI * k / N;
-    double cosw = std::cos(w);
-    double sinw = std::sin(w);
-    double coeff = 2.0 * cosw;
-
-    double s0 = 0.0, s1 = 0.0, s2 = 0.0;
-    for (int i = 0; i < N; ++i) {
-        double window = 0.5 * (1.0 - std::cos(2.0 * PI * i / N));
-        s0 = signal[i] * window + coeff * s1 - s2;
-        s2 = s1;
-        s1 = s0;
-    }
-
-    double real = s1 - s2 * cosw;
-    double imag = s2 * sinw;
-    return (2.0 * std::sqrt(real * real + imag * imag)) / (N * 0.5);
-}
+// Hann window precomputed once; read-only, shared by the evaluator threads
+static const HarmonicAnalyzer analyzer(SAMPLE_RATE, NUM_SAMPLES);
 
 double measureTHD(HybridTapeProcessor& proc, double levelVU, double freq = 1000.0)
 {
@@ -84,13 +72,8 @@ double measureTHD(HybridTapeProcessor& proc, double levelVU, double freq = 1000.
         phase += phaseInc;
     }
 
-    double f1 = measureAmplitude(output, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(output, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(output, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(output, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(output, freq * 5, SAMPLE_RATE);
-
-    return (std::sqrt(h2*h2 + h3*h3 + h4*h4 + h5*h5) / f1) * 100.0;
+    // H2-H5 in one pass over the capture
+    return analyzer.analyze(output, freq).thdPercent();
 }
 
 double calculateError(double* measured, double* target, int n)
@@ -103,12 +86,35 @@ double calculateError(double* measured, double* target, int n)
     return std::sqrt(sumSqError / n);  // RMS error in dB
 }
 
+void printComparison(const char* label, const double* measured, const double* targetVals, const double* levels)
+{
+    std::cout << "Level  | " << label << " | Target  | Error(dB)\n";
+    std::cout << "-------|----------|---------|----------\n";
+    for (int i = 0; i < 5; ++i) {
+        double errDB = 20.0 * std::log10(measured[i] / targetVals[i]);
+        std::cout << std::setw(6) << levels[i] << " | "
+                  << std::setw(8) << measured[i] << " | "
+                  << std::setw(7) << targetVals[i] << " | "
+                  << std::setw(+7) << std::showpos << errDB
+                  << std::noshowpos << "\n";
+    }
+}
+
 int main(int argc, char* argv[])
 {
     int modeIndex = 0;  // Default: Studer GP9
-    if (argc > 1) {
-        modeIndex = std::atoi(argv[1]);
-        if (modeIndex < 0 || modeIndex > 3) modeIndex = 0;
+    std::string searchMode = "nm";
+    int numThreads = 0;  // 0 = all cores
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--search") == 0 && i + 1 < argc) {
+            searchMode = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = std::max(1, std::atoi(argv[++i]));
+        } else {
+            modeIndex = std::atoi(argv[i]);
+            if (modeIndex < 0 || modeIndex > 3) modeIndex = 0;
+        }
     }
 
     TargetCurve& target = targets[modeIndex];
@@ -145,66 +151,79 @@ int main(int argc, char* argv[])
         a3_vals[3] = 0.013; a3_vals[4] = 0.015;
     }
 
+    // Processor at its shipped settings
     HybridTapeProcessor proc;
     proc.setSampleRate(SAMPLE_RATE);
+    proc.setParameters(target.biasStrength, 1.0, target.tapeFormula);
 
-    double bestError = 1000.0;
-    double bestA3 = 0, bestPower = 0, bestLowScale = 0;
-    double bestMeasured[5];
+    double currentMeasured[5];
+    for (int i = 0; i < 5; ++i) {
+        currentMeasured[i] = measureTHD(proc, levels[i]);
+    }
 
-    std::cout << "Sweeping parameters...\n";
     std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Current processor settings:\n";
+    printComparison("Measured", currentMeasured, targetVals, levels);
+    std::cout << "\nRMS Error: " << calculateError(currentMeasured, targetVals, 5) << " dB\n";
 
-    int totalTests = 5 * 5 * 4;
-    int testNum = 0;
-
-    for (double a3 : a3_vals) {
-        for (double power : power_vals) {
-            for (double lowScale : lowScale_vals) {
-                testNum++;
-
-                // We need to modify the processor's internal parameters
-                // Since we can't directly set them, we'll use a workaround:
-                // Create a custom test that simulates the saturation curve
+    // Processor sweep of { satA3, satPower, lowLevelScale } through the full chain
+    std::cout << "\n═══════════════════════════════════════════════════════════════\n";
+    std::cout << "Processor sweep (" << searchMode << ", jaBlend = " << target.jaBlend << "):\n";
+    std::cout << "═══════════════════════════════════════════════════════════════\n\n";
 
-                // For now, just test with current processor settings
-                // and report what we find
+    auto measureParams = [&](HybridTapeProcessor& p, const Calibration::Parameters& params, double* measured) {
+        p.setParameters(target.biasStrength, 1.0, target.tapeFormula);
+        p.setTestParameters(params[0], params[1], params[2], target.jaBlend);
+        for (int i = 0; i < 5; ++i) {
+            measured[i] = measureTHD(p, levels[i]);
+        }
+    };
+
+    Calibration::ParallelEvaluator evaluator(SAMPLE_RATE,
+        [&](HybridTapeProcessor& p, const Calibration::Parameters& params) {
+            double measured[5];
+            measureParams(p, params, measured);
+            return calculateError(measured, targetVals, 5);
+        },
+        numThreads);
+
+    const std::vector<std::vector<double>> axes {
+        std::vector<double>(std::begin(a3_vals), std::end(a3_vals)),
+        std::vector<double>(std::begin(power_vals), std::end(power_vals)),
+        std::vector<double>(std::begin(lowScale_vals), std::end(lowScale_vals))
+    };
+    const Calibration::Parameters lower { a3_vals[0], power_vals[0], lowScale_vals[0] };
+    const Calibration::Parameters upper { a3_vals[4], power_vals[4], lowScale_vals[3] };
+
+    Calibration::SearchResult result;
+    if (searchMode == "grid") {
+        result = Calibration::gridSearch(evaluator, axes);
+    } else if (searchMode == "fine") {
+        result = Calibration::coarseToFine(evaluator, lower, upper);
+    } else {
+        result = Calibration::nelderMead(evaluator, { a3_vals[2], power_vals[2], lowScale_vals[2] }, lower, upper);
+    }
 
-                if (testNum == 1) {
-                    // Just test current settings
-                    proc.setParameters(target.biasStrength, 1.0, target.tapeFormula);
+    double sweepMeasured[5];
+    measureParams(proc, result.params, sweepMeasured);
 
-                    double measured[5];
-                    for (int i = 0; i < 5; ++i) {
-                        measured[i] = measureTHD(proc, levels[i]);
-                    }
+    std::cout << result.evaluations << " evaluations on " << evaluator.getNumThreads() << " thread(s) in "
+              << std::setprecision(1) << result.seconds << " s\n" << std::setprecision(4);
+    std::cout << "  satA3 = " << result.params[0] << "\n";
+    std::cout << "  satPower = " << result.params[1] << "\n";
+    std::cout << "  lowLevelScale = " << result.params[2] << "\n";
+    std::cout << "  RMS Error = " << result.error << " dB\n\n";
+    printComparison("Measured", sweepMeasured, targetVals, levels);
 
-                    double error = calculateError(measured, targetVals, 5);
-
-                    std::cout << "\nCurrent processor settings:\n";
-                    std::cout << "Level  | Measured | Target  | Error(dB)\n";
-                    std::cout << "-------|----------|---------|----------\n";
-                    for (int i = 0; i < 5; ++i) {
-                        double errDB = 20.0 * std::log10(measured[i] / targetVals[i]);
-                        std::cout << std::setw(6) << levels[i] << " | "
-                                  << std::setw(8) << measured[i] << " | "
-                                  << std::setw(7) << targetVals[i] << " | "
-                                  << std::setw(+7) << std::showpos << errDB
-                                  << std::noshowpos << "\n";
-                    }
-                    std::cout << "\nRMS Error: " << error << " dB\n";
-                }
-            }
-        }
-    }
+    double bestError = 1000.0;
+    double bestA3 = 0, bestPower = 0, bestLowScale = 0;
+    double bestMeasured[5];
 
     // Now let's do a direct cubic model sweep to find theoretical best params
     std::cout << "\n═══════════════════════════════════════════════════════════════\n";
     std::cout << "Theoretical cubic model sweep (y = x - a3*x³ with level scaling):\n";
     std::cout << "═══════════════════════════════════════════════════════════════\n\n";
 
-    bestError = 1000.0;
-
     for (double a3 : a3_vals) {
         for (double power : power_vals) {
             for (double lowScale : lowScale_vals) {
@@ -248,22 +267,13 @@ int main(int argc, char* argv[])
     std::cout << "  lowLevelScale = " << bestLowScale << "\n";
     std::cout << "  RMS Error = " << bestError << " dB\n\n";
 
-    std::cout << "Level  | Model    | Target  | Error(dB)\n";
-    std::cout << "-------|----------|---------|----------\n";
-    for (int i = 0; i < 5; ++i) {
-        double errDB = 20.0 * std::log10(bestMeasured[i] / targetVals[i]);
-        std::cout << std::setw(6) << levels[i] << " | "
-                  << std::setw(8) << bestMeasured[i] << " | "
-                  << std::setw(7) << targetVals[i] << " | "
-                  << std::setw(+7) << std::showpos << errDB
-                  << std::noshowpos << "\n";
-    }
+    printComparison("Model   ", bestMeasured, targetVals, levels);
 
     std::cout << "\n═══════════════════════════════════════════════════════════════\n";
-    std::cout << "RECOMMENDED UPDATE for " << target.name << ":\n";
-    std::cout << "  satA3 = " << bestA3 << ";\n";
-    std::cout << "  satPower = " << bestPower << ";\n";
-    std::cout << "  lowLevelScale = " << bestLowScale << ";\n";
+    std::cout << "RECOMMENDED UPDATE for " << target.name << " (processor sweep):\n";
+    std::cout << "  satA3 = " << result.params[0] << ";\n";
+    std::cout << "  satPower = " << result.params[1] << ";\n";
+    std::cout << "  lowLevelScale = " << result.params[2] << ";\n";
     std::cout << "═══════════════════════════════════════════════════════════════\n";
 
     return 0;
@@ -0,0 +1,790 @@
+/**
+ * Tape Render - offline batch renderer
+ *
+ * Prints WAV files (or folders of stems) through the tape processor with a fixed
+ * machine / formula / drive setting. Files are rendered in parallel, one file per
+ * worker thread, and streamed in chunks so memory use does not grow with file length.
+ *
+ * Gain staging matches the plugin: drive -> -6 dB into the tape core -> machine
+ * gain compensation -> +6 dB makeup -> volume, with the drive compensated at the
+ * output like the plugin's auto-gain (more saturation, same level). Below 88.2 kHz the tape core runs
+ * at 2x (linear phase half-band, latency removed) like the plugin's Auto setting.
+ * The plugin-side Studer effects (crosstalk, wow, tolerance EQ, print-through)
+ * are not part of the DSP library and are not applied.
+ *
+ * Compile: clang++ -std=c++17 -O3 -pthread -o tape_render tape_render.cpp MachineEQ.cpp BiasShielding.cpp HybridTapeProcessor.cpp -I.
+ * Run:     ./tape_render --machine studer --tape gp9 --drive 3 -o printed stems/
+ */
+
+#include "HybridTapeProcessor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace TapeMachine;
+namespace fs = std::filesystem;
+
+constexpr double PI = 3.14159265358979323846;
+constexpr int CHUNK_FRAMES = 4096;           // Frames read/processed/written per chunk
+constexpr double WARMUP_SECONDS = 0.2;       // Silence run through first: covers the 150ms fade-in
+constexpr float GLOBAL_INPUT_GAIN = 0.501f;  // -6dB into the tape core (as in the plugin)
+
+struct RenderSettings
+{
+    int machineMode = 0;        // 0 = Ampex ATR-102, 1 = Studer A820
+    int tapeFormula = 0;        // 0 = GP9, 1 = SM900
+    double driveDB = 0.0;
+    double volumeDB = 0.0;
+    int oversampling = 0;       // 0 = auto (2x below 88.2kHz), 1 = off, 2 = 2x
+    fs::path outputDir;         // Empty = next to the input, "_tape" suffix
+    bool overwrite = false;     // Replace existing output files
+};
+
+//==============================================================================
+// WAV I/O - PCM 16/24/32-bit and IEEE float 32/64, mono to multichannel
+// The source fmt chunk is written back unchanged, so format and channel mask survive
+//==============================================================================
+
+static uint32_t readLE(const unsigned char* p, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static void writeLE(unsigned char* p, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        p[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xff);
+}
+
+struct WavFormat
+{
+    std::vector<unsigned char> fmtChunk;  // Raw fmt payload
+    int numChannels = 0;
+    double sampleRate = 0.0;
+    int bitsPerSample = 0;
+    bool isFloat = false;
+
+    int bytesPerSample() const { return bitsPerSample / 8; }
+    int bytesPerFrame() const { return bytesPerSample() * numChannels; }
+};
+
+class WavReader
+{
+public:
+    bool open(const fs::path& path, std::string& error)
+    {
+        file.open(path, std::ios::binary);
+        if (!file) { error = "cannot open file"; return false; }
+
+        unsigned char header[12];
+        if (!file.read(reinterpret_cast<char*>(header), 12)
+            || std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0)
+        {
+            error = "not a RIFF/WAVE file";
+            return false;
+        }
+
+        bool haveFormat = false;
+        unsigned char chunkHeader[8];
+        while (file.read(reinterpret_cast<char*>(chunkHeader), 8))
+        {
+            const uint32_t chunkSize = readLE(chunkHeader + 4, 4);
+
+            if (std::memcmp(chunkHeader, "fmt ", 4) == 0)
+            {
+                format.fmtChunk.resize(chunkSize);
+                if (!file.read(reinterpret_cast<char*>(format.fmtChunk.data()), chunkSize) || chunkSize < 16)
+                {
+                    error = "truncated fmt chunk";
+                    return false;
+                }
+                if (chunkSize & 1)
+                    file.ignore(1);
+
+                const unsigned char* f = format.fmtChunk.data();
+                uint32_t tag = readLE(f, 2);
+                format.numChannels = static_cast<int>(readLE(f + 2, 2));
+                format.sampleRate = static_cast<double>(readLE(f + 4, 4));
+                format.bitsPerSample = static_cast<int>(readLE(f + 14, 2));
+                if (tag == 0xfffe && chunkSize >= 26)
+                    tag = readLE(f + 24, 2);  // WAVE_FORMAT_EXTENSIBLE: sub-format GUID starts with the tag
+
+                format.isFloat = (tag == 3);
+                const bool supported = (tag == 1 && (format.bitsPerSample == 16 || format.bitsPerSample == 24
+                                                     || format.bitsPerSample == 32))
+                                    || (tag == 3 && (format.bitsPerSample == 32 || format.bitsPerSample == 64));
+                if (!supported || format.numChannels < 1)
+                {
+                    error = "unsupported sample format (PCM 16/24/32 or float 32/64 only)";
+                    return false;
+                }
+                haveFormat = true;
+            }
+            else if (std::memcmp(chunkHeader, "data", 4) == 0)
+            {
+                if (!haveFormat) { error = "data chunk before fmt chunk"; return false; }
+                framesRemaining = chunkSize / static_cast<uint32_t>(format.bytesPerFrame());
+                return true;
+            }
+            else
+            {
+                file.ignore(chunkSize + (chunkSize & 1));
+            }
+        }
+
+        error = "no data chunk";
+        return false;
+    }
+
+    const WavFormat& getFormat() const { return format; }
+
+    // Reads up to maxFrames into per-channel float buffers, returns frames read
+    int read(std::vector<std::vector<float>>& channels, int maxFrames)
+    {
+        const int frames = static_cast<int>(std::min<uint64_t>(framesRemaining, static_cast<uint64_t>(maxFrames)));
+        const int frameBytes = format.bytesPerFrame();
+        const int sampleBytes = format.bytesPerSample();
+
+        raw.resize(static_cast<size_t>(frames) * frameBytes);
+        file.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+        const int framesRead = static_cast<int>(file.gcount() / frameBytes);
+        framesRemaining = (framesRead == frames) ? framesRemaining - frames : 0;
+
+        for (int i = 0; i < framesRead; ++i)
+        {
+            for (int ch = 0; ch < format.numChannels; ++ch)
+            {
+                const unsigned char* p = raw.data() + static_cast<size_t>(i) * frameBytes + ch * sampleBytes;
+                channels[ch][i] = decodeSample(p);
+            }
+        }
+        return framesRead;
+    }
+
+private:
+    float decodeSample(const unsigned char* p) const
+    {
+        if (format.isFloat)
+        {
+            if (format.bitsPerSample == 32)
+            {
+                const uint32_t bits = readLE(p, 4);
+                float value;
+                std::memcpy(&value, &bits, 4);
+                return value;
+            }
+            const uint64_t bits = static_cast<uint64_t>(readLE(p, 4)) | (static_cast<uint64_t>(readLE(p + 4, 4)) << 32);
+            double value;
+            std::memcpy(&value, &bits, 8);
+            return static_cast<float>(value);
+        }
+
+        switch (format.bitsPerSample)
+        {
+            case 16: return static_cast<int16_t>(readLE(p, 2)) / 32768.0f;
+            case 24: return static_cast<int32_t>(readLE(p, 3) << 8) / 2147483648.0f;
+            default: return static_cast<float>(static_cast<int32_t>(readLE(p, 4)) / 2147483648.0);
+        }
+    }
+
+    std::ifstream file;
+    WavFormat format;
+    uint64_t framesRemaining = 0;
+    std::vector<unsigned char> raw;
+};
+
+class WavWriter
+{
+public:
+    bool open(const fs::path& path, const WavFormat& sourceFormat)
+    {
+        format = sourceFormat;
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        // RIFF and data sizes are patched in close()
+        const uint32_t fmtSize = static_cast<uint32_t>(format.fmtChunk.size());
+        unsigned char header[12 + 8];
+        std::memcpy(header, "RIFF", 4);
+        writeLE(header + 4, 0, 4);
+        std::memcpy(header + 8, "WAVE", 4);
+        std::memcpy(header + 12, "fmt ", 4);
+        writeLE(header + 16, fmtSize, 4);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(format.fmtChunk.data()), fmtSize);
+        if (fmtSize & 1)
+            file.put(0);
+
+        unsigned char dataHeader[8];
+        std::memcpy(dataHeader, "data", 4);
+        writeLE(dataHeader + 4, 0, 4);
+        dataSizeOffset = static_cast<std::streamoff>(file.tellp()) + 4;
+        file.write(reinterpret_cast<const char*>(dataHeader), 8);
+        return static_cast<bool>(file);
+    }
+
+    bool write(const std::vector<std::vector<float>>& channels, int numFrames)
+    {
+        const int frameBytes = format.bytesPerFrame();
+        const int sampleBytes = format.bytesPerSample();
+        raw.resize(static_cast<size_t>(numFrames) * frameBytes);
+
+        for (int i = 0; i < numFrames; ++i)
+            for (int ch = 0; ch < format.numChannels; ++ch)
+                encodeSample(channels[ch][i], raw.data() + static_cast<size_t>(i) * frameBytes + ch * sampleBytes);
+
+        file.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+        dataBytes += raw.size();
+        return static_cast<bool>(file) && dataBytes < 0xffffffffull - 64;  // No RF64: stay below 4 GB
+    }
+
+    bool close()
+    {
+        if (dataBytes & 1)
+            file.put(0);
+
+        unsigned char size[4];
+        writeLE(size, static_cast<uint32_t>(dataBytes), 4);
+        file.seekp(dataSizeOffset);
+        file.write(reinterpret_cast<const char*>(size), 4);
+
+        const uint64_t riffSize = static_cast<uint64_t>(dataSizeOffset) + 4 + dataBytes + (dataBytes & 1) - 8;
+        writeLE(size, static_cast<uint32_t>(riffSize), 4);
+        file.seekp(4);
+        file.write(reinterpret_cast<const char*>(size), 4);
+        file.close();
+        return !file.fail();
+    }
+
+private:
+    void encodeSample(float value, unsigned char* p) const
+    {
+        if (format.isFloat)
+        {
+            if (format.bitsPerSample == 32)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, 4);
+                writeLE(p, bits, 4);
+            }
+            else
+            {
+                const double wide = value;
+                uint64_t bits;
+                std::memcpy(&bits, &wide, 8);
+                writeLE(p, static_cast<uint32_t>(bits), 4);
+                writeLE(p + 4, static_cast<uint32_t>(bits >> 32), 4);
+            }
+            return;
+        }
+
+        // Integer PCM: clip, round (no dither - print at 24 bit or float for mastering)
+        const double clipped = std::max(-1.0, std::min(1.0, static_cast<double>(value)));
+        switch (format.bitsPerSample)
+        {
+            case 16: writeLE(p, static_cast<uint32_t>(static_cast<int32_t>(std::lround(std::min(clipped * 32768.0, 32767.0)))), 2); break;
+            case 24: writeLE(p, static_cast<uint32_t>(static_cast<int32_t>(std::lround(std::min(clipped * 8388608.0, 8388607.0)))), 3); break;
+            default: writeLE(p, static_cast<uint32_t>(static_cast<int32_t>(std::llround(std::min(clipped * 2147483648.0, 2147483647.0)))), 4); break;
+        }
+    }
+
+    std::ofstream file;
+    WavFormat format;
+    std::streamoff dataSizeOffset = 0;
+    uint64_t dataBytes = 0;
+    std::vector<unsigned char> raw;
+};
+
+//==============================================================================
+// 2x oversampling - linear phase half-band FIR (Kaiser windowed sinc)
+// Up and down filters together delay the signal by HALF_BAND_TAPS - 1 samples at
+// the oversampled rate, i.e. LATENCY base-rate samples, which the renderer trims
+//==============================================================================
+
+class HalfBandFilter
+{
+public:
+    static constexpr int HALF_BAND_TAPS = 127;
+    static constexpr int LATENCY = (HALF_BAND_TAPS - 1) / 2;
+
+    HalfBandFilter()
+    {
+        static const std::vector<double> kernel = design();
+        coefficients = &kernel;
+        history.assign(2 * HALF_BAND_TAPS, 0.0);
+    }
+
+    double process(double input)
+    {
+        history[position] = history[position + HALF_BAND_TAPS] = input;
+        position = (position + 1) % HALF_BAND_TAPS;
+
+        // history[position .. position + TAPS) runs oldest to newest
+        const double* x = history.data() + position;
+        const double* h = coefficients->data();
+        double sum = 0.0;
+        for (int k = 0; k < HALF_BAND_TAPS; ++k)
+            sum += h[k] * x[HALF_BAND_TAPS - 1 - k];
+        return sum;
+    }
+
+private:
+    static std::vector<double> design()
+    {
+        // Cutoff at half the oversampled Nyquist, Kaiser beta 10 (~-100dB stopband)
+        constexpr double beta = 10.0;
+        auto besselI0 = [](double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 50; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        };
+
+        std::vector<double> h(HALF_BAND_TAPS);
+        const int centre = (HALF_BAND_TAPS - 1) / 2;
+        for (int n = 0; n < HALF_BAND_TAPS; ++n)
+        {
+            const int m = n - centre;
+            const double sinc = (m == 0) ? 0.5 : std::sin(PI * m * 0.5) / (PI * m);
+            const double r = static_cast<double>(m) / centre;
+            h[static_cast<size_t>(n)] = sinc * besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+        }
+        return h;
+    }
+
+    const std::vector<double>* coefficients = nullptr;
+    std::vector<double> history;
+    int position = 0;
+};
+
+//==============================================================================
+// One file through the tape core
+//==============================================================================
+
+class TapeRenderer
+{
+public:
+    TapeRenderer(const RenderSettings& settings, int numChannels, double sampleRate)
+        : numChannels(numChannels)
+    {
+        oversamplingFactor = (settings.oversampling == 2 || (settings.oversampling == 0 && sampleRate < 88200.0)) ? 2 : 1;
+
+        processors.resize(static_cast<size_t>(numChannels));
+        const double bias = (settings.machineMode == 0) ? 0.65 : 0.82;
+        for (auto& processor : processors)
+        {
+            processor = std::make_unique<HybridTapeProcessor>();
+            processor->setSampleRate(sampleRate * oversamplingFactor);
+            processor->setParameters(bias, 1.0, settings.tapeFormula);
+            processor->setControlRateInterval(16);
+            processor->setSaturationADAA(sampleRate * oversamplingFactor < 88200.0);
+            processor->setAzimuthEnabled(numChannels <= 2);  // Multichannel files: tracks, not stereo pairs
+            processor->reset();
+        }
+
+        if (oversamplingFactor > 1)
+        {
+            upFilters.resize(static_cast<size_t>(numChannels));
+            downFilters.resize(static_cast<size_t>(numChannels));
+        }
+
+        const float gainComp = (settings.machineMode == 0) ? 1.029f : 0.977f;
+        inputGain = static_cast<float>(std::pow(10.0, settings.driveDB / 20.0)) * GLOBAL_INPUT_GAIN;
+        outputGain = gainComp * static_cast<float>(std::pow(10.0, (settings.volumeDB - settings.driveDB) / 20.0)) / GLOBAL_INPUT_GAIN;
+
+        work.assign(static_cast<size_t>(numChannels), std::vector<float>(static_cast<size_t>(CHUNK_FRAMES * oversamplingFactor)));
+
+        // Let the fade-in and DC blockers settle on silence, so the file starts at full level
+        std::vector<std::vector<float>> silence(static_cast<size_t>(numChannels), std::vector<float>(CHUNK_FRAMES, 0.0f));
+        for (int remaining = static_cast<int>(WARMUP_SECONDS * sampleRate); remaining > 0; remaining -= CHUNK_FRAMES)
+            process(silence, std::min(remaining, CHUNK_FRAMES));
+    }
+
+    int getLatency() const { return (oversamplingFactor > 1) ? HalfBandFilter::LATENCY : 0; }
+
+    // In place on per-channel buffers, numFrames <= CHUNK_FRAMES
+    void process(std::vector<std::vector<float>>& channels, int numFrames)
+    {
+        const int engineFrames = numFrames * oversamplingFactor;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* in = channels[static_cast<size_t>(ch)].data();
+            float* out = work[static_cast<size_t>(ch)].data();
+
+            if (oversamplingFactor > 1)
+            {
+                // Zero-stuff and interpolate (x2 restores the passband gain)
+                auto& up = upFilters[static_cast<size_t>(ch)];
+                for (int i = 0; i < numFrames; ++i)
+                {
+                    out[2 * i] = static_cast<float>(2.0 * up.process(in[i] * inputGain));
+                    out[2 * i + 1] = static_cast<float>(2.0 * up.process(0.0));
+                }
+            }
+            else
+            {
+                for (int i = 0; i < numFrames; ++i)
+                    out[i] = in[i] * inputGain;
+            }
+        }
+
+        // Channel pairs share a stereo tape path (azimuth delay on the second channel of stereo files)
+        for (int ch = 0; ch < numChannels; ch += 2)
+        {
+            float* left = work[static_cast<size_t>(ch)].data();
+            if (ch + 1 < numChannels)
+            {
+                float* right = work[static_cast<size_t>(ch + 1)].data();
+                HybridTapeProcessor::processStereoBlock(*processors[static_cast<size_t>(ch)], *processors[static_cast<size_t>(ch + 1)],
+                                                        left, right, left, right, engineFrames);
+            }
+            else
+            {
+                processors[static_cast<size_t>(ch)]->processBlock(left, left, engineFrames);
+            }
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* out = channels[static_cast<size_t>(ch)].data();
+            const float* engine = work[static_cast<size_t>(ch)].data();
+
+            if (oversamplingFactor > 1)
+            {
+                auto& down = downFilters[static_cast<size_t>(ch)];
+                for (int i = 0; i < numFrames; ++i)
+                {
+                    // Keep the even output: total delay is then an integer number of base samples
+                    out[i] = static_cast<float>(down.process(engine[2 * i])) * outputGain;
+                    down.process(engine[2 * i + 1]);
+                }
+            }
+            else
+            {
+                for (int i = 0; i < numFrames; ++i)
+                    out[i] = engine[i] * outputGain;
+            }
+        }
+    }
+
+private:
+    int numChannels;
+    int oversamplingFactor = 1;
+    float inputGain = 1.0f;
+    float outputGain = 1.0f;
+    std::vector<std::unique_ptr<HybridTapeProcessor>> processors;
+    std::vector<HalfBandFilter> upFilters;
+    std::vector<HalfBandFilter> downFilters;
+    std::vector<std::vector<float>> work;
+};
+
+static bool renderFile(const fs::path& input, const fs::path& output, const RenderSettings& settings,
+                       std::string& message)
+{
+    WavReader reader;
+    std::string error;
+    if (!reader.open(input, error))
+    {
+        message = error;
+        return false;
+    }
+
+    const WavFormat& format = reader.getFormat();
+    WavWriter writer;
+    if (!writer.open(output, format))
+    {
+        message = "cannot create " + output.string();
+        return false;
+    }
+
+    TapeRenderer renderer(settings, format.numChannels, format.sampleRate);
+    std::vector<std::vector<float>> channels(static_cast<size_t>(format.numChannels), std::vector<float>(CHUNK_FRAMES, 0.0f));
+
+    // Oversampling latency: drop the first samples, flush the same amount of silence at the end
+    int latencyToSkip = renderer.getLatency();
+    int flushRemaining = renderer.getLatency();
+    uint64_t framesWritten = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (;;)
+    {
+        int numFrames = reader.read(channels, CHUNK_FRAMES);
+        if (numFrames == 0)
+        {
+            if (flushRemaining == 0)
+                break;
+            numFrames = std::min(flushRemaining, CHUNK_FRAMES);
+            for (auto& channel : channels)
+                std::fill(channel.begin(), channel.begin() + numFrames, 0.0f);
+            flushRemaining -= numFrames;
+        }
+
+        renderer.process(channels, numFrames);
+
+        int offset = std::min(latencyToSkip, numFrames);
+        latencyToSkip -= offset;
+        if (offset > 0)
+            for (auto& channel : channels)
+                std::copy(channel.begin() + offset, channel.begin() + numFrames, channel.begin());
+
+        if (!writer.write(channels, numFrames - offset))
+        {
+            message = "write failed (disk full or output above 4 GB)";
+            return false;
+        }
+        framesWritten += static_cast<uint64_t>(numFrames - offset);
+    }
+
+    if (!writer.close())
+    {
+        message = "cannot finalize " + output.string();
+        return false;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double audioSeconds = static_cast<double>(framesWritten) / format.sampleRate;
+    std::ostringstream stream;
+    stream.setf(std::ios::fixed);
+    stream.precision(1);
+    stream << audioSeconds << " s audio, " << format.numChannels << " ch, "
+           << (seconds > 0.0 ? audioSeconds / seconds : 0.0) << "x realtime";
+    message = stream.str();
+    return true;
+}
+
+//==============================================================================
+// Command line
+//==============================================================================
+
+static void printUsage()
+{
+    std::cout << "Usage: tape_render [options] <file.wav | folder> ...\n\n"
+              << "  --machine ampex|studer   Ampex ATR-102 (Master) or Studer A820 (Tracks), default ampex\n"
+              << "  --tape gp9|sm900         Tape formula, default gp9\n"
+              << "  --drive <dB>             Input drive, -12 to +12, default 0 (level compensated at the output)\n"
+              << "  --volume <dB>            Output level, default 0\n"
+              << "  --oversampling auto|off|2x  Tape core rate, default auto (2x below 88.2 kHz)\n"
+              << "  --jobs <n>               Files rendered in parallel, default: all cores\n"
+              << "  -o, --output <folder>    Output folder (default: next to input, \"_tape\" suffix)\n"
+              << "  --overwrite              Replace existing output files (default: refuse)\n\n"
+              << "Folders are scanned (not recursively) for .wav files. WAV only: FLAC is not supported.\n"
+              << "Inputs whose outputs would collide (same name from different folders) are refused.\n";
+}
+
+static std::string lowerCase(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static bool isWavFile(const fs::path& path)
+{
+    const std::string extension = lowerCase(path.extension().string());
+    return extension == ".wav" || extension == ".wave";
+}
+
+// Comparison key for file paths: absolute and normalized. Outputs are compared
+// case-folded as well (macOS and Windows file systems are case-insensitive, so
+// KICK.wav and kick.wav may be one file)
+static std::string pathKey(const fs::path& path, bool foldCase)
+{
+    std::error_code ec;
+    fs::path absolute = fs::absolute(path, ec);
+    if (ec)
+        absolute = path;
+    const std::string key = absolute.lexically_normal().string();
+    return foldCase ? lowerCase(key) : key;
+}
+
+// One output per input - fails (with the reasons printed) if two inputs would write
+// the same file, an output would replace its input, or an output already exists
+// without --overwrite. The same input listed twice is rendered once.
+static bool planOutputs(std::vector<fs::path>& files, const RenderSettings& settings, std::vector<fs::path>& outputs)
+{
+    std::vector<fs::path> uniqueFiles;
+    std::vector<std::string> inputKeys, outputKeys;
+    bool ok = true;
+
+    for (const auto& input : files)
+    {
+        const std::string inputKey = pathKey(input, false);
+        if (std::find(inputKeys.begin(), inputKeys.end(), inputKey) != inputKeys.end())
+            continue;
+
+        fs::path output = settings.outputDir.empty()
+            ? input.parent_path() / (input.stem().string() + "_tape.wav")
+            : settings.outputDir / (input.stem().string() + ".wav");
+        const std::string outputKey = pathKey(output, true);
+
+        const auto clash = std::find(outputKeys.begin(), outputKeys.end(), outputKey);
+        if (clash != outputKeys.end())
+        {
+            std::cerr << "Output clash: " << input.string() << " and "
+                      << uniqueFiles[static_cast<size_t>(clash - outputKeys.begin())].string()
+                      << " would both write " << output.string() << " - render them to different folders\n";
+            ok = false;
+        }
+        else if (outputKey == lowerCase(inputKey))
+        {
+            std::cerr << "Output would overwrite its input: " << input.string() << "\n";
+            ok = false;
+        }
+        else if (!settings.overwrite && fs::exists(output))
+        {
+            std::cerr << "Output exists: " << output.string() << " (use --overwrite to replace it)\n";
+            ok = false;
+        }
+
+        uniqueFiles.push_back(input);
+        inputKeys.push_back(inputKey);
+        outputKeys.push_back(outputKey);
+        outputs.push_back(output);
+    }
+
+    files = std::move(uniqueFiles);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    RenderSettings settings;
+    int jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<fs::path> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+
+        if ((arg == "--machine") && hasValue)
+        {
+            const std::string value = lowerCase(argv[++i]);
+            settings.machineMode = (value == "studer" || value == "tracks") ? 1 : 0;
+        }
+        else if ((arg == "--tape") && hasValue)
+            settings.tapeFormula = (lowerCase(argv[++i]) == "sm900") ? 1 : 0;
+        else if ((arg == "--drive") && hasValue)
+            settings.driveDB = std::max(-12.0, std::min(12.0, std::atof(argv[++i])));
+        else if ((arg == "--volume") && hasValue)
+            settings.volumeDB = std::atof(argv[++i]);
+        else if ((arg == "--oversampling") && hasValue)
+        {
+            const std::string value = lowerCase(argv[++i]);
+            settings.oversampling = (value == "off" || value == "1x") ? 1 : (value == "2x" ? 2 : 0);
+        }
+        else if ((arg == "--jobs") && hasValue)
+            jobs = std::max(1, std::atoi(argv[++i]));
+        else if ((arg == "-o" || arg == "--output") && hasValue)
+            settings.outputDir = argv[++i];
+        else if (arg == "--overwrite")
+            settings.overwrite = true;
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            std::cerr << "Unknown option " << arg << "\n\n";
+            printUsage();
+            return 1;
+        }
+        else
+            inputs.emplace_back(arg);
+    }
+
+    // Expand folders into their WAV files
+    std::vector<fs::path> files;
+    for (const auto& input : inputs)
+    {
+        std::error_code ec;
+        if (fs::is_directory(input, ec))
+        {
+            std::vector<fs::path> folderFiles;
+            for (const auto& entry : fs::directory_iterator(input, ec))
+                if (entry.is_regular_file() && isWavFile(entry.path()))
+                    folderFiles.push_back(entry.path());
+            std::sort(folderFiles.begin(), folderFiles.end());
+            files.insert(files.end(), folderFiles.begin(), folderFiles.end());
+        }
+        else if (lowerCase(input.extension().string()) == ".flac")
+            std::cerr << "Skipping " << input.string() << ": FLAC is not supported, convert to WAV first\n";
+        else
+            files.push_back(input);
+    }
+
+    if (files.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    // Output paths, checked before any thread starts: two workers writing the same
+    // file would silently corrupt it
+    std::vector<fs::path> outputs;
+    if (!planOutputs(files, settings, outputs))
+        return 1;
+
+    if (!settings.outputDir.empty())
+    {
+        std::error_code ec;
+        fs::create_directories(settings.outputDir, ec);
+    }
+
+    std::cout << "Rendering " << files.size() << " file(s) through "
+              << (settings.machineMode == 0 ? "Ampex ATR-102" : "Studer A820") << " / "
+              << (settings.tapeFormula == 0 ? "GP9" : "SM900") << ", drive " << settings.driveDB
+              << " dB, " << std::min<size_t>(static_cast<size_t>(jobs), files.size()) << " job(s)\n";
+
+    // Workers take the next unrendered file until none are left
+    std::atomic<size_t> nextFile { 0 };
+    std::atomic<int> failures { 0 };
+    std::mutex logMutex;
+
+    auto worker = [&]()
+    {
+        for (size_t index = nextFile++; index < files.size(); index = nextFile++)
+        {
+            const fs::path& input = files[index];
+            const fs::path& output = outputs[index];
+
+            std::string message;
+            const bool ok = renderFile(input, output, settings, message);
+
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << (ok ? "  done  " : "  FAIL  ") << input.string() << " - " << message << "\n";
+            if (!ok)
+                ++failures;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const int numThreads = static_cast<int>(std::min<size_t>(static_cast<size_t>(jobs), files.size()));
+    for (int t = 0; t < numThreads; ++t)
+        threads.emplace_back(worker);
+    for (auto& thread : threads)
+        thread.join();
+
+    return failures > 0 ? 1 : 0;
+}
@@ -1,49 +1,25 @@
 /**
  * THD Measurement Verification
- * Tests the Goertzel-based THD measurement against known signals
+ * Tests the Goertzel-based THD measurement (HarmonicAnalyzer.h) against known signals
  *
- * Compile: clang++ -std=c++17 -O2 -o thd_verify thd_verify.cpp
+ * Compile: clang++ -std=c++17 -O2 -o thd_verify thd_verify.cpp -I.
  * Run: ./thd_verify
  */
 
+#include "HarmonicAnalyzer.h"
 #include <cmath>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 
+using namespace TapeMachine;
+
 constexpr double PI = 3.14159265358979323846;
 constexpr double SAMPLE_RATE = 96000.0;
 constexpr int NUM_SAMPLES = 8192;
 
-/**
- * Goertzel algorithm for measuring amplitude at specific frequency
- */
-double measureAmplitude(const std::vector<double>& signal, double freq, double fs)
-{
-    int N = static_cast<int>(signal.size());
-    double k = freq * N / fs;
-    double w = 2.0 * PI * k / N;
-    double cosw = std::cos(w);
-    double sinw = std::sin(w);
-    double coeff = 2.0 * cosw;
-
-    double s0 = 0.0, s1 = 0.0, s2 = 0.0;
-
-    // Apply Hann window
-    for (int i = 0; i < N; ++i) {
-        double window = 0.5 * (1.0 - std::cos(2.0 * PI * i / N));
-        s0 = signal[i] * window + coeff * s1 - s2;
-        s2 = s1;
-        s1 = s0;
-    }
-
-    double real = s1 - s2 * cosw;
-    double imag = s2 * sinw;
-    double magnitude = std::sqrt(real * real + imag * imag);
-
-    // Normalize: DFT gives N/2 for unit sine, Hann window has 0.5 coherent gain
-    return (2.0 * magnitude) / (N * 0.5);
-}
+// Shared Goertzel analysis (HarmonicAnalyzer.h), as used by the calibration tools
+static const HarmonicAnalyzer analyzer(SAMPLE_RATE, NUM_SAMPLES);
 
 /**
  * Calculate THD from harmonic amplitudes
@@ -67,11 +43,12 @@ void testPureSine()
         signal[i] = amplitude * std::sin(2.0 * PI * freq * i / SAMPLE_RATE);
     }
 
-    double f1 = measureAmplitude(signal, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(signal, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(signal, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(signal, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(signal, freq * 5, SAMPLE_RATE);
+    auto harmonics = analyzer.analyze(signal, freq);
+    double f1 = harmonics.amplitude[1];
+    double h2 = harmonics.amplitude[2];
+    double h3 = harmonics.amplitude[3];
+    double h4 = harmonics.amplitude[4];
+    double h5 = harmonics.amplitude[5];
 
     std::cout << std::fixed << std::setprecision(6);
     std::cout << "Input amplitude: " << amplitude << "\n";
@@ -95,11 +72,12 @@ void testKnownDistortion()
         signal[i] = a1 * std::sin(t) + a2 * std::sin(2*t) + a3 * std::sin(3*t);
     }
 
-    double f1 = measureAmplitude(signal, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(signal, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(signal, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(signal, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(signal, freq * 5, SAMPLE_RATE);
+    auto harmonics = analyzer.analyze(signal, freq);
+    double f1 = harmonics.amplitude[1];
+    double h2 = harmonics.amplitude[2];
+    double h3 = harmonics.amplitude[3];
+    double h4 = harmonics.amplitude[4];
+    double h5 = harmonics.amplitude[5];
 
     double expectedTHD = std::sqrt(a2*a2 + a3*a3) / a1 * 100.0;
 
@@ -127,11 +105,12 @@ void testHighDistortion()
         signal[i] = a1 * std::sin(t) + a2 * std::sin(2*t) + a3 * std::sin(3*t);
     }
 
-    double f1 = measureAmplitude(signal, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(signal, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(signal, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(signal, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(signal, freq * 5, SAMPLE_RATE);
+    auto harmonics = analyzer.analyze(signal, freq);
+    double f1 = harmonics.amplitude[1];
+    double h2 = harmonics.amplitude[2];
+    double h3 = harmonics.amplitude[3];
+    double h4 = harmonics.amplitude[4];
+    double h5 = harmonics.amplitude[5];
 
     double expectedTHD = std::sqrt(a2*a2 + a3*a3) / a1 * 100.0;
 
@@ -159,11 +138,12 @@ void testCubicSaturation()
         signal[i] = x - a3_coeff * x * x * x;  // Cubic saturation
     }
 
-    double f1 = measureAmplitude(signal, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(signal, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(signal, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(signal, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(signal, freq * 5, SAMPLE_RATE);
+    auto harmonics = analyzer.analyze(signal, freq);
+    double f1 = harmonics.amplitude[1];
+    double h2 = harmonics.amplitude[2];
+    double h3 = harmonics.amplitude[3];
+    double h4 = harmonics.amplitude[4];
+    double h5 = harmonics.amplitude[5];
 
     // Theoretical: cubic produces only odd harmonics
     // Third harmonic amplitude ≈ (1/4) * a3 * A³ for y = x - a3*x³
@@ -195,11 +175,12 @@ void testBiasedCubic()
         signal[i] = biased - a3_coeff * biased * biased * biased - bias;  // Remove DC
     }
 
-    double f1 = measureAmplitude(signal, freq, SAMPLE_RATE);
-    double h2 = measureAmplitude(signal, freq * 2, SAMPLE_RATE);
-    double h3 = measureAmplitude(signal, freq * 3, SAMPLE_RATE);
-    double h4 = measureAmplitude(signal, freq * 4, SAMPLE_RATE);
-    double h5 = measureAmplitude(signal, freq * 5, SAMPLE_RATE);
+    auto harmonics = analyzer.analyze(signal, freq);
+    double f1 = harmonics.amplitude[1];
+    double h2 = harmonics.amplitude[2];
+    double h3 = harmonics.amplitude[3];
+    double h4 = harmonics.amplitude[4];
+    double h5 = harmonics.amplitude[5];
 
     std::cout << std::fixed << std::setprecision(6);
     std::cout << "Measured fundamental: " << f1 << "\n";
@@ -209,6 +190,33 @@ void testBiasedCubic()
     std::cout << "Measured THD: " << calculateTHD(f1, h2, h3, h4, h5) << "%\n\n";
 }
 
+void testOnePassAnalysis()
+{
+    std::cout << "=== Test 6: One-Pass Analysis vs Single-Frequency Goertzel ===\n";
+    std::cout << "All harmonics in one pass must match one Goertzel run per harmonic\n\n";
+
+    double freq = 1000.0;
+
+    std::vector<double> signal(NUM_SAMPLES);
+    for (int i = 0; i < NUM_SAMPLES; ++i) {
+        double x = std::sin(2.0 * PI * freq * i / SAMPLE_RATE) + 0.1;
+        signal[i] = x - 0.1 * x * x * x;
+    }
+
+    auto harmonics = analyzer.analyze(signal, freq, HarmonicAnalyzer::MAX_HARMONIC);
+
+    double maxDiff = 0.0;
+    for (int h = 1; h <= HarmonicAnalyzer::MAX_HARMONIC; ++h) {
+        double single = analyzer.measureAmplitude(signal.data(), freq * h);
+        maxDiff = std::max(maxDiff, std::abs(harmonics.amplitude[h] - single));
+    }
+
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "Max difference (H1-H" << HarmonicAnalyzer::MAX_HARMONIC << "): " << maxDiff << "\n";
+    std::cout << (maxDiff == 0.0 ? "PASS" : "FAIL") << "\n\n";
+    std::cout << std::fixed;
+}
+
 int main()
 {
     std::cout << "╔═══════════════════════════════════════════════════════════╗\n";
@@ -221,6 +229,7 @@ int main()
     testHighDistortion();
     testCubicSaturation();
     testBiasedCubic();
+    testOnePassAnalysis();
 
     std::cout << "═══════════════════════════════════════════════════════════════\n";
     std::cout << "If all tests pass, the THD measurement is working correctly.\n";
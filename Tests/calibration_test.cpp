@@ -0,0 +1,138 @@
+/**
+ * Calibration Regression Test
+ *
+ * Runs the 1kHz THD measurement of auto_tune.cpp on the shipped calibration
+ * and fails if any of the four machine/tape combinations has drifted from its
+ * target curve, or if its even/odd character has changed.
+ *
+ *   THD   -12 / -6 / 0 / +3 / +6 VU against auto_tune.cpp targets[]:
+ *         every level within MAX_LEVEL_ERROR_DB, RMS within MAX_RMS_ERROR_DB
+ *         (the README quotes < 0.35 dB; 0.25 - 0.33 dB measured)
+ *   E/O   H2/H3 at 0VU within MAX_EO_DEVIATION of the documented ratio
+ *         (0.50 Ampex, 1.12 Studer - see the inputBias comments in
+ *         HybridTapeProcessor::buildConfigurations)
+ *
+ * Built and run by CTest (Tests/CMakeLists.txt), or by hand:
+ * Compile: clang++ -std=c++17 -O2 -o calibration_test calibration_test.cpp ../Source/DSP/MachineEQ.cpp ../Source/DSP/BiasShielding.cpp ../Source/DSP/HybridTapeProcessor.cpp -I../Source/DSP
+ * Run: ./calibration_test
+ */
+
+#include "HybridTapeProcessor.h"
+#include "HarmonicAnalyzer.h"
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+
+using namespace TapeMachine;
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double SAMPLE_RATE = 96000.0;   // Engine rate at 48kHz with the default 2x
+constexpr int NUM_SAMPLES = 8192;
+constexpr int PRE_ROLL = 16384;
+
+constexpr double MAX_LEVEL_ERROR_DB = 1.0;
+constexpr double MAX_RMS_ERROR_DB = 0.35;
+constexpr double MAX_EO_DEVIATION = 0.15;  // Relative
+
+struct TargetCurve {
+    const char* name;
+    double biasStrength;
+    int tapeFormula;
+    double thd[5];   // -12, -6, 0, +3, +6 VU
+    double eoRatio;  // H2/H3 at 0VU
+};
+
+// Same curves as auto_tune.cpp
+const TargetCurve targets[] = {
+    { "Studer GP9",   0.80, 0, {0.0114, 0.0452, 0.18, 0.359, 0.717}, 1.12 },
+    { "Studer SM900", 0.80, 1, {0.0189, 0.0754, 0.30, 0.599, 1.194}, 1.12 },
+    { "Ampex GP9",    0.50, 0, {0.0057, 0.0226, 0.09, 0.180, 0.358}, 0.50 },
+    { "Ampex SM900",  0.50, 1, {0.0095, 0.0377, 0.15, 0.299, 0.597}, 0.50 }
+};
+
+const double levels[] = {-12.0, -6.0, 0.0, 3.0, 6.0};
+constexpr int ZERO_VU_INDEX = 2;
+
+HarmonicAnalyzer::Harmonics measureHarmonics(HybridTapeProcessor& proc, const HarmonicAnalyzer& analyzer,
+                                             double levelVU, double freq = 1000.0)
+{
+    double amplitude = std::pow(10.0, levelVU / 20.0);
+    double phaseInc = 2.0 * PI * freq / SAMPLE_RATE;
+    double phase = 0.0;
+
+    proc.reset();
+
+    for (int i = 0; i < PRE_ROLL; ++i) {
+        proc.processSample(amplitude * std::sin(phase));
+        phase += phaseInc;
+    }
+
+    std::vector<double> output(NUM_SAMPLES);
+    for (int i = 0; i < NUM_SAMPLES; ++i) {
+        output[i] = proc.processSample(amplitude * std::sin(phase));
+        phase += phaseInc;
+    }
+
+    return analyzer.analyze(output.data(), freq);
+}
+
+bool testMode(const TargetCurve& target, const HarmonicAnalyzer& analyzer)
+{
+    std::cout << "=== " << target.name << " ===\n";
+    std::cout << "  Level    Target %   Measured %   Error dB\n";
+
+    HybridTapeProcessor proc;
+    proc.setSampleRate(SAMPLE_RATE);
+    proc.setParameters(target.biasStrength, 1.0, target.tapeFormula);
+
+    bool pass = true;
+    double sumSquares = 0.0;
+    double eoRatio = 0.0;
+
+    for (int i = 0; i < 5; ++i) {
+        const HarmonicAnalyzer::Harmonics h = measureHarmonics(proc, analyzer, levels[i]);
+        const double thd = h.thdPercent();
+        const double errorDB = 20.0 * std::log10(thd / target.thd[i]);
+        const bool levelPass = std::abs(errorDB) <= MAX_LEVEL_ERROR_DB;
+        pass &= levelPass;
+        sumSquares += errorDB * errorDB;
+
+        if (i == ZERO_VU_INDEX)
+            eoRatio = h.amplitude[2] / h.amplitude[3];
+
+        std::cout << std::fixed << std::setprecision(4)
+                  << "  " << std::showpos << std::setprecision(0) << std::setw(3) << levels[i] << std::noshowpos << " VU"
+                  << std::setprecision(4) << "  " << std::setw(8) << target.thd[i]
+                  << "   " << std::setw(10) << thd
+                  << "   " << std::setw(7) << std::setprecision(2) << errorDB
+                  << (levelPass ? "" : "  FAIL") << "\n";
+    }
+
+    const double rms = std::sqrt(sumSquares / 5.0);
+    const bool rmsPass = rms <= MAX_RMS_ERROR_DB;
+    const double eoDeviation = std::abs(eoRatio / target.eoRatio - 1.0);
+    const bool eoPass = eoDeviation <= MAX_EO_DEVIATION;
+    pass &= rmsPass && eoPass;
+
+    std::cout << std::setprecision(3)
+              << "  RMS error " << rms << " dB (limit " << MAX_RMS_ERROR_DB << ") " << (rmsPass ? "PASS" : "FAIL") << "\n"
+              << "  E/O @ 0VU " << eoRatio << " (target " << target.eoRatio << " +/- "
+              << std::setprecision(0) << MAX_EO_DEVIATION * 100.0 << "%) " << (eoPass ? "PASS" : "FAIL") << "\n\n"
+              << std::defaultfloat;
+    return pass;
+}
+
+int main()
+{
+    std::cout << "Calibration Regression Test @ " << SAMPLE_RATE / 1000.0 << " kHz, 1 kHz tone\n\n";
+
+    const HarmonicAnalyzer analyzer(SAMPLE_RATE, NUM_SAMPLES);
+
+    bool pass = true;
+    for (const TargetCurve& target : targets)
+        pass &= testMode(target, analyzer);
+
+    std::cout << (pass ? "All checks passed" : "Some checks FAILED") << "\n";
+    return pass ? 0 : 1;
+}
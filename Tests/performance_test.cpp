@@ -0,0 +1,86 @@
+/**
+ * CPU Budget Test
+ *
+ * Times the tape core the way the plugin runs it - stereo block path, double
+ * engine, 256-sample blocks at the 96kHz engine rate (48kHz with the default 2x)
+ * - for all four configurations, and fails if any of them needs more than the
+ * budget in ns per sample and channel.
+ *
+ * The fastest of several runs is compared (least affected by other load on a
+ * shared CI machine). The budget is set per machine with the CMake cache entry
+ * TAPE_MACHINE_NS_PER_SAMPLE_BUDGET; benchmark.cpp gives the full breakdown.
+ *
+ * Built and run by CTest (Tests/CMakeLists.txt), or by hand:
+ * Compile: clang++ -std=c++17 -O3 -o performance_test performance_test.cpp ../Source/DSP/MachineEQ.cpp ../Source/DSP/BiasShielding.cpp ../Source/DSP/HybridTapeProcessor.cpp -I../Source/DSP
+ * Run: ./performance_test [budget ns/sample]
+ */
+
+#include "HybridTapeProcessor.h"
+#include "BenchmarkHarness.h"
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+using namespace TapeMachine;
+using namespace TapeMachine::Benchmark;
+
+constexpr double SAMPLE_RATE = 96000.0;
+constexpr int BLOCK_SIZE = 256;
+constexpr int SIGNAL_LENGTH = 1 << 16;
+constexpr double DEFAULT_BUDGET_NS = 400.0;
+
+int main(int argc, char** argv)
+{
+    const double budget = (argc > 1) ? std::atof(argv[1]) : DEFAULT_BUDGET_NS;
+    if (budget <= 0.0) {
+        std::cerr << "Usage: performance_test [budget ns/sample]\n";
+        return 2;
+    }
+
+    Options options;
+    options.minSeconds = 0.1;
+    options.repetitions = 5;
+
+    std::cout << "CPU Budget Test: HybridTapeProcessor::processStereoBlock @ " << SAMPLE_RATE / 1000.0
+              << " kHz, " << BLOCK_SIZE << "-sample blocks, budget " << budget << " ns/sample\n\n";
+
+    const std::vector<float> signal = makeTestSignal(SAMPLE_RATE, SIGNAL_LENGTH);
+    std::vector<float> outputL(BLOCK_SIZE), outputR(BLOCK_SIZE);
+
+    bool pass = true;
+    for (const Configuration& config : configurations()) {
+        auto makeProcessor = [&] {
+            auto proc = std::make_unique<HybridTapeProcessor>();
+            proc->setSampleRate(SAMPLE_RATE);
+            proc->setParameters(config.biasStrength, 1.0, config.tapeFormula);
+            return proc;
+        };
+        auto left = makeProcessor();
+        auto right = makeProcessor();
+
+        int position = 0;
+        const auto timing = measure([&] {
+            if (position + BLOCK_SIZE > SIGNAL_LENGTH)
+                position = 0;
+            const float* input = signal.data() + position;
+            position += BLOCK_SIZE;
+            HybridTapeProcessor::processStereoBlock(*left, *right, input, input,
+                                                    outputL.data(), outputR.data(), BLOCK_SIZE);
+            consume(outputL[0] + outputR[0]);
+        }, 2 * BLOCK_SIZE, options);
+
+        const double fastest = timing.second;
+        const bool configPass = fastest <= budget;
+        pass &= configPass;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  " << std::left << std::setw(14) << config.name << std::right
+                  << std::setw(8) << fastest << " ns/sample (median " << timing.first << ")  "
+                  << (configPass ? "PASS" : "FAIL") << "\n";
+    }
+
+    std::cout << "\n" << (pass ? "All configurations within budget" : "CPU budget EXCEEDED") << "\n";
+    return pass ? 0 : 1;
+}